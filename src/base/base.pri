@@ -17,6 +17,7 @@ HEADERS += \
     $$PWD/bittorrent/filesearcher.h \
     $$PWD/bittorrent/filterparserthread.h \
     $$PWD/bittorrent/infohash.h \
+    $$PWD/bittorrent/ipfilterlistdownloader.h \
     $$PWD/bittorrent/loadtorrentparams.h \
     $$PWD/bittorrent/ltqbitarray.h \
     $$PWD/bittorrent/ltqhash.h \
@@ -28,6 +29,7 @@ HEADERS += \
     $$PWD/bittorrent/peerinfo.h \
     $$PWD/bittorrent/portforwarderimpl.h \
     $$PWD/bittorrent/resumedatastorage.h \
+    $$PWD/bittorrent/resumedatastoragemigrator.h \
     $$PWD/bittorrent/session.h \
     $$PWD/bittorrent/sessionimpl.h \
     $$PWD/bittorrent/sessionstatus.h \
@@ -78,11 +80,13 @@ HEADERS += \
     $$PWD/rss/rss_feed.h \
     $$PWD/rss/rss_folder.h \
     $$PWD/rss/rss_item.h \
+    $$PWD/rss/rss_keywordmatcher.h \
     $$PWD/rss/rss_parser.h \
     $$PWD/rss/rss_session.h \
     $$PWD/search/searchdownloadhandler.h \
     $$PWD/search/searchhandler.h \
     $$PWD/search/searchpluginmanager.h \
+    $$PWD/search/searchworker.h \
     $$PWD/settingsstorage.h \
     $$PWD/settingvalue.h \
     $$PWD/tagset.h \
@@ -121,6 +125,7 @@ SOURCES += \
     $$PWD/bittorrent/filesearcher.cpp \
     $$PWD/bittorrent/filterparserthread.cpp \
     $$PWD/bittorrent/infohash.cpp \
+    $$PWD/bittorrent/ipfilterlistdownloader.cpp \
     $$PWD/bittorrent/ltqbitarray.cpp \
     $$PWD/bittorrent/magneturi.cpp \
     $$PWD/bittorrent/nativesessionextension.cpp \
@@ -129,6 +134,7 @@ SOURCES += \
     $$PWD/bittorrent/peerinfo.cpp \
     $$PWD/bittorrent/portforwarderimpl.cpp \
     $$PWD/bittorrent/resumedatastorage.cpp \
+    $$PWD/bittorrent/resumedatastoragemigrator.cpp \
     $$PWD/bittorrent/sessionimpl.cpp \
     $$PWD/bittorrent/speedmonitor.cpp \
     $$PWD/bittorrent/torrent.cpp \
@@ -167,11 +173,13 @@ SOURCES += \
     $$PWD/rss/rss_feed.cpp \
     $$PWD/rss/rss_folder.cpp \
     $$PWD/rss/rss_item.cpp \
+    $$PWD/rss/rss_keywordmatcher.cpp \
     $$PWD/rss/rss_parser.cpp \
     $$PWD/rss/rss_session.cpp \
     $$PWD/search/searchdownloadhandler.cpp \
     $$PWD/search/searchhandler.cpp \
     $$PWD/search/searchpluginmanager.cpp \
+    $$PWD/search/searchworker.cpp \
     $$PWD/settingsstorage.cpp \
     $$PWD/tagset.cpp \
     $$PWD/torrentfileguard.cpp \
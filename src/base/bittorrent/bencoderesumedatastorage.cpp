@@ -28,7 +28,10 @@
 
 #include "bencoderesumedatastorage.h"
 
+#include <algorithm>
+
 #include <libtorrent/bdecode.hpp>
+#include <libtorrent/bencode.hpp>
 #include <libtorrent/entry.hpp>
 #include <libtorrent/read_resume_data.hpp>
 #include <libtorrent/torrent_info.hpp>
@@ -39,6 +42,7 @@
 #include <QFile>
 #include <QRegularExpression>
 #include <QThread>
+#include <QThreadPool>
 
 #include "base/algorithm.h"
 #include "base/exceptions.h"
@@ -48,6 +52,7 @@
 #include "base/profile.h"
 #include "base/tagset.h"
 #include "base/utils/fs.h"
+#include "base/utils/gzip.h"
 #include "base/utils/io.h"
 #include "base/utils/string.h"
 #include "infohash.h"
@@ -62,9 +67,10 @@ namespace BitTorrent
     public:
         explicit Worker(const Path &resumeDataDir);
 
-        void store(const TorrentID &id, const LoadTorrentParams &resumeData) const;
+        void store(const TorrentID &id, const LoadTorrentParams &resumeData, bool compress) const;
         void remove(const TorrentID &id) const;
         void storeQueue(const QVector<TorrentID> &queue) const;
+        void recompress(const TorrentID &id, bool compress) const;
 
     private:
         const Path m_resumeDataDir;
@@ -73,6 +79,38 @@ namespace BitTorrent
 
 namespace
 {
+    // Resume data is loaded by chunks of this size (in queue order)
+    // to keep the amount of data waiting for delivery bounded
+    const int LOAD_CHUNK_SIZE = 256;
+    const int MAX_DECODING_THREADS = 4;
+
+    struct ResumeDataFiles
+    {
+        QByteArray data;
+        QByteArray metadata;
+    };
+
+    nonstd::expected<ResumeDataFiles, QString> readResumeDataFiles(const Path &resumeDataDir, const BitTorrent::TorrentID &id)
+    {
+        const QString idString = id.toString();
+        const Path fastresumePath = resumeDataDir / Path(idString + u".fastresume");
+        const Path torrentFilePath = resumeDataDir / Path(idString + u".torrent");
+        const qint64 torrentSizeLimit = Preferences::instance()->getTorrentFileSizeLimit();
+
+        const auto resumeDataReadResult = Utils::IO::readFile(fastresumePath, torrentSizeLimit);
+        if (!resumeDataReadResult)
+            return nonstd::make_unexpected(resumeDataReadResult.error().message);
+
+        const auto metadataReadResult = Utils::IO::readFile(torrentFilePath, torrentSizeLimit);
+        if (!metadataReadResult)
+        {
+            if (metadataReadResult.error().status != Utils::IO::ReadError::NotExist)
+                return nonstd::make_unexpected(metadataReadResult.error().message);
+        }
+
+        return ResumeDataFiles {resumeDataReadResult.value(), metadataReadResult.value_or(QByteArray())};
+    }
+
     template <typename LTStr>
     QString fromLTString(const LTStr &str)
     {
@@ -108,11 +146,16 @@ BitTorrent::BencodeResumeDataStorage::BencodeResumeDataStorage(const Path &path,
     const QStringList filenames = QDir(path.data()).entryList(QStringList(u"*.fastresume"_s), QDir::Files, QDir::Unsorted);
 
     m_registeredTorrents.reserve(filenames.size());
+    m_directoryPositions.reserve(filenames.size());
     for (const QString &filename : filenames)
     {
          const QRegularExpressionMatch rxMatch = filenamePattern.match(filename);
          if (rxMatch.hasMatch())
-             m_registeredTorrents.append(TorrentID::fromString(rxMatch.captured(1)));
+         {
+             const auto torrentID = TorrentID::fromString(rxMatch.captured(1));
+             m_directoryPositions.insert(torrentID, m_registeredTorrents.size());
+             m_registeredTorrents.append(torrentID);
+         }
     }
 
     loadQueue(path / Path(u"queue"_s));
@@ -131,25 +174,11 @@ QVector<BitTorrent::TorrentID> BitTorrent::BencodeResumeDataStorage::registeredT
 
 BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::load(const TorrentID &id) const
 {
-    const QString idString = id.toString();
-    const Path fastresumePath = path() / Path(idString + u".fastresume");
-    const Path torrentFilePath = path() / Path(idString + u".torrent");
-    const qint64 torrentSizeLimit = Preferences::instance()->getTorrentFileSizeLimit();
-
-    const auto resumeDataReadResult = Utils::IO::readFile(fastresumePath, torrentSizeLimit);
-    if (!resumeDataReadResult)
-        return nonstd::make_unexpected(resumeDataReadResult.error().message);
-
-    const auto metadataReadResult = Utils::IO::readFile(torrentFilePath, torrentSizeLimit);
-    if (!metadataReadResult)
-    {
-        if (metadataReadResult.error().status != Utils::IO::ReadError::NotExist)
-            return nonstd::make_unexpected(metadataReadResult.error().message);
-    }
+    const auto readResult = readResumeDataFiles(path(), id);
+    if (!readResult)
+        return nonstd::make_unexpected(readResult.error());
 
-    const QByteArray data = resumeDataReadResult.value();
-    const QByteArray metadata = metadataReadResult.value_or(QByteArray());
-    return loadTorrentResumeData(data, metadata);
+    return loadTorrentResumeData(readResult.value().data, readResult.value().metadata);
 }
 
 void BitTorrent::BencodeResumeDataStorage::doLoadAll() const
@@ -158,10 +187,68 @@ void BitTorrent::BencodeResumeDataStorage::doLoadAll() const
 
     emit const_cast<BencodeResumeDataStorage *>(this)->loadStarted(m_registeredTorrents);
 
-    for (const TorrentID &torrentID : asConst(m_registeredTorrents))
-        onResumeDataLoaded(torrentID, load(torrentID));
+    const bool compressionEnabled = Preferences::instance()->isResumeDataCompressionEnabled();
+    QVector<TorrentID> torrentsToRecompress;
+
+    // Files are read sequentially (in directory order to reduce disk seeks)
+    // while they are decoded in parallel. Loaded resume data is delivered in queue order.
+    QThreadPool decodingPool;
+    decodingPool.setMaxThreadCount(std::clamp(QThread::idealThreadCount(), 1, MAX_DECODING_THREADS));
+
+    const int torrentsCount = m_registeredTorrents.size();
+    for (int chunkStart = 0; chunkStart < torrentsCount; chunkStart += LOAD_CHUNK_SIZE)
+    {
+        const int chunkSize = std::min(LOAD_CHUNK_SIZE, (torrentsCount - chunkStart));
+
+        QVector<int> readOrder;
+        readOrder.reserve(chunkSize);
+        for (int i = 0; i < chunkSize; ++i)
+            readOrder.append(i);
+        std::sort(readOrder.begin(), readOrder.end(), [this, chunkStart](const int left, const int right)
+        {
+            return m_directoryPositions.value(m_registeredTorrents[chunkStart + left])
+                    < m_directoryPositions.value(m_registeredTorrents[chunkStart + right]);
+        });
+
+        QVector<LoadResumeDataResult> results(chunkSize);
+        LoadResumeDataResult *resultsData = results.data();
+        for (const int i : asConst(readOrder))
+        {
+            const TorrentID &torrentID = m_registeredTorrents[chunkStart + i];
+            auto readResult = readResumeDataFiles(path(), torrentID);
+            if (!readResult)
+            {
+                resultsData[i] = nonstd::make_unexpected(readResult.error());
+                continue;
+            }
+
+            if (Utils::Gzip::isCompressed(readResult.value().data) != compressionEnabled)
+                torrentsToRecompress.append(torrentID);
+
+            decodingPool.start([this, resultsData, i, files = std::move(readResult.value())]
+            {
+                resultsData[i] = loadTorrentResumeData(files.data, files.metadata);
+            });
+        }
+
+        decodingPool.waitForDone();
+
+        for (int i = 0; i < chunkSize; ++i)
+            onResumeDataLoaded(m_registeredTorrents[chunkStart + i], results[i]);
+    }
 
     emit const_cast<BencodeResumeDataStorage *>(this)->loadFinished();
+
+    // Resume data stored in other format is converted in background
+    if (!torrentsToRecompress.isEmpty())
+    {
+        qDebug() << "Resume data to convert count:" << torrentsToRecompress.size();
+        QMetaObject::invokeMethod(m_asyncWorker, [this, torrentsToRecompress, compressionEnabled]()
+        {
+            for (const TorrentID &torrentID : torrentsToRecompress)
+                m_asyncWorker->recompress(torrentID, compressionEnabled);
+        });
+    }
 }
 
 void BitTorrent::BencodeResumeDataStorage::loadQueue(const Path &queueFilename)
@@ -204,8 +291,17 @@ BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::loadTorre
 {
     const auto *pref = Preferences::instance();
 
+    QByteArray bencodedData = data;
+    if (Utils::Gzip::isCompressed(data))
+    {
+        bool ok = false;
+        bencodedData = Utils::Gzip::decompress(data, &ok);
+        if (!ok)
+            return nonstd::make_unexpected(tr("Cannot decompress resume data"));
+    }
+
     lt::error_code ec;
-    const lt::bdecode_node resumeDataRoot = lt::bdecode(data, ec
+    const lt::bdecode_node resumeDataRoot = lt::bdecode(bencodedData, ec
             , nullptr, pref->getBdecodeDepthLimit(), pref->getBdecodeTokenLimit());
     if (ec)
         return nonstd::make_unexpected(tr("Cannot parse resume data: %1").arg(QString::fromStdString(ec.message())));
@@ -322,9 +418,10 @@ BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::loadTorre
 
 void BitTorrent::BencodeResumeDataStorage::store(const TorrentID &id, const LoadTorrentParams &resumeData) const
 {
-    QMetaObject::invokeMethod(m_asyncWorker, [this, id, resumeData]()
+    const bool compress = Preferences::instance()->isResumeDataCompressionEnabled();
+    QMetaObject::invokeMethod(m_asyncWorker, [this, id, resumeData, compress]()
     {
-        m_asyncWorker->store(id, resumeData);
+        m_asyncWorker->store(id, resumeData, compress);
     });
 }
 
@@ -344,12 +441,18 @@ void BitTorrent::BencodeResumeDataStorage::storeQueue(const QVector<TorrentID> &
     });
 }
 
+void BitTorrent::BencodeResumeDataStorage::flush() const
+{
+    // Worker performs the requests in order so the empty one is performed last
+    QMetaObject::invokeMethod(m_asyncWorker, []() {}, Qt::BlockingQueuedConnection);
+}
+
 BitTorrent::BencodeResumeDataStorage::Worker::Worker(const Path &resumeDataDir)
     : m_resumeDataDir {resumeDataDir}
 {
 }
 
-void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, const LoadTorrentParams &resumeData) const
+void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, const LoadTorrentParams &resumeData, const bool compress) const
 {
     // We need to adjust native libtorrent resume data
     lt::add_torrent_params p = resumeData.ltAddTorrentParams;
@@ -416,7 +519,53 @@ void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, co
     }
 
     const Path resumeFilepath = m_resumeDataDir / Path(u"%1.fastresume"_s.arg(id.toString()));
-    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(resumeFilepath, data);
+    nonstd::expected<void, QString> result;
+    if (compress)
+    {
+        QByteArray bencodedData;
+        bencodedData.reserve(256 * 1024);
+        lt::bencode(std::back_inserter(bencodedData), data);
+
+        bool ok = false;
+        const QByteArray compressedData = Utils::Gzip::compress(bencodedData, 6, &ok);
+        // Uncompressed data is stored rather than losing it, it is loaded the same way
+        if (!ok)
+            LogMsg(tr("Couldn't compress resume data. Torrent: \"%1\"").arg(id.toString()), Log::WARNING);
+        result = Utils::IO::saveToFile(resumeFilepath, (ok ? compressedData : bencodedData));
+    }
+    else
+    {
+        result = Utils::IO::saveToFile(resumeFilepath, data);
+    }
+
+    if (!result)
+    {
+        LogMsg(tr("Couldn't save torrent resume data to '%1'. Error: %2.")
+               .arg(resumeFilepath.toString(), result.error()), Log::CRITICAL);
+    }
+}
+
+void BitTorrent::BencodeResumeDataStorage::Worker::recompress(const TorrentID &id, const bool compress) const
+{
+    // Resume data is read again since it could be updated after it was loaded
+    const Path resumeFilepath = m_resumeDataDir / Path(u"%1.fastresume"_s.arg(id.toString()));
+    const auto readResult = Utils::IO::readFile(resumeFilepath, Preferences::instance()->getTorrentFileSizeLimit());
+    if (!readResult)
+        return;
+
+    const QByteArray &data = readResult.value();
+    if (Utils::Gzip::isCompressed(data) == compress)
+        return;
+
+    bool ok = false;
+    const QByteArray convertedData = compress ? Utils::Gzip::compress(data, 6, &ok) : Utils::Gzip::decompress(data, &ok);
+    if (!ok)
+    {
+        LogMsg(tr("Couldn't convert torrent resume data '%1'.").arg(resumeFilepath.toString()), Log::WARNING);
+        return;
+    }
+
+    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(resumeFilepath, convertedData);
     if (!result)
     {
         LogMsg(tr("Couldn't save torrent resume data to '%1'. Error: %2.")
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <QDir>
+#include <QHash>
 #include <QVector>
 
 #include "base/pathfwd.h"
@@ -54,6 +55,7 @@ namespace BitTorrent
         void store(const TorrentID &id, const LoadTorrentParams &resumeData) const override;
         void remove(const TorrentID &id) const override;
         void storeQueue(const QVector<TorrentID> &queue) const override;
+        void flush() const override;
 
     private:
         void doLoadAll() const override;
@@ -61,6 +63,7 @@ namespace BitTorrent
         LoadResumeDataResult loadTorrentResumeData(const QByteArray &data, const QByteArray &metadata) const;
 
         QVector<TorrentID> m_registeredTorrents;
+        QHash<TorrentID, int> m_directoryPositions;
         Utils::Thread::UniquePtr m_ioThread;
 
         class Worker;
@@ -28,8 +28,8 @@
 
 #include "dbresumedatastorage.h"
 
+#include <algorithm>
 #include <memory>
-#include <queue>
 #include <utility>
 
 #include <libtorrent/bdecode.hpp>
@@ -40,7 +40,9 @@
 #include <libtorrent/write_resume_data.hpp>
 
 #include <QByteArray>
+#include <QDeadlineTimer>
 #include <QDebug>
+#include <QHash>
 #include <QMutex>
 #include <QSet>
 #include <QSqlDatabase>
@@ -48,6 +50,7 @@
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QThread>
+#include <QVariant>
 #include <QVector>
 #include <QWaitCondition>
 
@@ -58,6 +61,7 @@
 #include "base/preferences.h"
 #include "base/profile.h"
 #include "base/utils/fs.h"
+#include "base/utils/gzip.h"
 #include "base/utils/string.h"
 #include "infohash.h"
 #include "loadtorrentparams.h"
@@ -66,48 +70,79 @@ namespace
 {
     const QString DB_CONNECTION_NAME = u"ResumeDataStorage"_s;
 
-    const int DB_VERSION = 5;
+    // Minimal interval between background WAL checkpoints (in ms)
+    const int WAL_CHECKPOINT_INTERVAL = 10000;
+
+    const int DB_VERSION = 6;
 
     const QString DB_TABLE_META = u"meta"_s;
     const QString DB_TABLE_TORRENTS = u"torrents"_s;
+    const QString DB_TABLE_METADATA = u"torrents_metadata"_s;
 
     const QString META_VERSION = u"version"_s;
 
     using namespace BitTorrent;
 
+    class QueryCache
+    {
+    public:
+        explicit QueryCache(QSqlDatabase db);
+
+        QSqlQuery &prepared(const QString &statement);
+
+    private:
+        QSqlDatabase m_db;
+        QHash<QString, QSqlQuery> m_queries;
+    };
+
     class Job
     {
     public:
         virtual ~Job() = default;
-        virtual void perform(QSqlDatabase db) = 0;
+        virtual void perform(QueryCache &queryCache) = 0;
     };
 
     class StoreJob final : public Job
     {
     public:
-        StoreJob(const TorrentID &torrentID, const LoadTorrentParams &resumeData);
-        void perform(QSqlDatabase db) override;
+        StoreJob(const TorrentID &torrentID, const LoadTorrentParams &resumeData, bool compress);
+        void perform(QueryCache &queryCache) override;
 
     private:
+        bool isMetadataStored(QueryCache &queryCache) const;
+        void storeMetadata(QueryCache &queryCache, const QByteArray &bencodedMetadata) const;
+
         const TorrentID m_torrentID;
         const LoadTorrentParams m_resumeData;
+        const bool m_compress;
     };
 
     class RemoveJob final : public Job
     {
     public:
         explicit RemoveJob(const TorrentID &torrentID);
-        void perform(QSqlDatabase db) override;
+        void perform(QueryCache &queryCache) override;
+
+    private:
+        const TorrentID m_torrentID;
+    };
+
+    class RecompressJob final : public Job
+    {
+    public:
+        RecompressJob(const TorrentID &torrentID, bool compress);
+        void perform(QueryCache &queryCache) override;
 
     private:
         const TorrentID m_torrentID;
+        const bool m_compress;
     };
 
     class StoreQueueJob final : public Job
     {
     public:
         explicit StoreQueueJob(const QVector<TorrentID> &queue);
-        void perform(QSqlDatabase db) override;
+        void perform(QueryCache &queryCache) override;
 
     private:
         const QVector<TorrentID> m_queue;
@@ -142,8 +177,11 @@ namespace
     const Column DB_COLUMN_STOPPED = makeColumn("stopped");
     const Column DB_COLUMN_STOP_CONDITION = makeColumn("stop_condition");
     const Column DB_COLUMN_RESUMEDATA = makeColumn("libtorrent_resume_data");
+    // legacy column of "torrents" table, metadata is stored in separate table since version 6
     const Column DB_COLUMN_METADATA = makeColumn("metadata");
     const Column DB_COLUMN_VALUE = makeColumn("value");
+    const Column DB_COLUMN_INFO_HASH = makeColumn("info_hash");
+    const Column DB_COLUMN_DATA = makeColumn("data");
 
     template <typename LTStr>
     QString fromLTString(const LTStr &str)
@@ -158,6 +196,16 @@ namespace
         return (quote + name + quote);
     }
 
+    // NULL value of string column
+    QVariant nullString()
+    {
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+        return QVariant(QMetaType(QMetaType::QString));
+#else
+        return QVariant(QVariant::String);
+#endif
+    }
+
     QString makeCreateTableStatement(const QString &tableName, const QStringList &items)
     {
         return u"CREATE TABLE %1 (%2)"_s.arg(quoted(tableName), items.join(u','));
@@ -214,7 +262,14 @@ namespace
         return u"%1 %2"_s.arg(quoted(column.name), QString::fromLatin1(definition));
     }
 
-    LoadTorrentParams parseQueryResultRow(const QSqlQuery &query)
+    QString makeSelectTorrentsStatement()
+    {
+        return u"SELECT %1.*, %2.%3 FROM %1 LEFT JOIN %2 ON %1.%4 = %2.%5"_s
+                .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_TABLE_METADATA), quoted(DB_COLUMN_DATA.name)
+                        , quoted(DB_COLUMN_TORRENT_ID.name), quoted(DB_COLUMN_INFO_HASH.name));
+    }
+
+    LoadResumeDataResult parseQueryResultRow(const QSqlQuery &query)
     {
         LoadTorrentParams resumeData;
         resumeData.name = query.value(DB_COLUMN_NAME.name).toString();
@@ -247,7 +302,15 @@ namespace
                         Path(query.value(DB_COLUMN_DOWNLOAD_PATH.name).toString()));
         }
 
-        const QByteArray bencodedResumeData = query.value(DB_COLUMN_RESUMEDATA.name).toByteArray();
+        QByteArray bencodedResumeData = query.value(DB_COLUMN_RESUMEDATA.name).toByteArray();
+        if (Utils::Gzip::isCompressed(bencodedResumeData))
+        {
+            bool ok = false;
+            bencodedResumeData = Utils::Gzip::decompress(bencodedResumeData, &ok);
+            if (!ok)
+                return nonstd::make_unexpected(ResumeDataStorage::tr("Cannot decompress resume data"));
+        }
+
         const auto *pref = Preferences::instance();
         const int bdecodeDepthLimit = pref->getBdecodeDepthLimit();
         const int bdecodeTokenLimit = pref->getBdecodeTokenLimit();
@@ -260,7 +323,7 @@ namespace
 
         p = lt::read_resume_data(resumeDataRoot, ec);
 
-        if (const QByteArray bencodedMetadata = query.value(DB_COLUMN_METADATA.name).toByteArray()
+        if (const QByteArray bencodedMetadata = query.value(DB_COLUMN_DATA.name).toByteArray()
                 ; !bencodedMetadata.isEmpty())
         {
             const lt::bdecode_node torentInfoRoot = lt::bdecode(bencodedMetadata, ec
@@ -283,30 +346,76 @@ namespace
 
 namespace BitTorrent
 {
+    class DBResumeDataStorage::Checkpointer final : public QThread
+    {
+        Q_DISABLE_COPY_MOVE(Checkpointer)
+
+    public:
+        explicit Checkpointer(const Path &dbPath, QObject *parent = nullptr);
+
+        void run() override;
+        void requestInterruption();
+
+        void requestCheckpoint();
+
+    private:
+        const QString m_connectionName = u"ResumeDataStorageCheckpointer"_s;
+        const Path m_path;
+
+        bool m_isCheckpointRequested = false;
+        QMutex m_mutex;
+        QWaitCondition m_waitCondition;
+    };
+
     class DBResumeDataStorage::Worker final : public QThread
     {
         Q_DISABLE_COPY_MOVE(Worker)
 
     public:
-        Worker(const Path &dbPath, QReadWriteLock &dbLock, QObject *parent = nullptr);
+        Worker(const Path &dbPath, QReadWriteLock &dbLock, Checkpointer *checkpointer, QObject *parent = nullptr);
 
         void run() override;
         void requestInterruption();
 
-        void store(const TorrentID &id, const LoadTorrentParams &resumeData);
+        void store(const TorrentID &id, const LoadTorrentParams &resumeData, bool compress);
         void remove(const TorrentID &id);
         void storeQueue(const QVector<TorrentID> &queue);
+        void recompress(const TorrentID &id, bool compress);
+        void flush();
 
     private:
-        void addJob(std::unique_ptr<Job> job);
+        void addJob(const TorrentID &id, std::shared_ptr<Job> job);
+        bool hasPendingJobs() const;
+        bool isCommitJobsLimitReached() const;
+        void applyConnectionOptions(const QSqlDatabase &db) const;
 
         const QString m_connectionName = u"ResumeDataStorageWorker"_s;
         const Path m_path;
         QReadWriteLock &m_dbLock;
-
-        std::queue<std::unique_ptr<Job>> m_jobs;
+        Checkpointer *m_checkpointer = nullptr;
+
+        // Group commit: pending jobs are written in a single transaction
+        // once the commit interval is elapsed or the jobs limit is reached
+        const int m_commitInterval;
+        const int m_commitJobsLimit;
+        const bool m_isRelaxedDurabilityEnabled;
+        const int m_walAutoCheckpoint;
+
+        // Pending jobs are coalesced so only the latest job for each torrent
+        // (and the latest queue positions) is actually written to database
+        QHash<TorrentID, std::shared_ptr<Job>> m_pendingJobs;
+        std::shared_ptr<Job> m_pendingQueueJob;
+        qint64 m_requestedJobsCount = 0;
+        qint64 m_coalescedJobsCount = 0;
         QMutex m_jobsMutex;
         QWaitCondition m_waitCondition;
+
+        // Flush waits for the batch containing the jobs requested so far to be performed
+        qint64 m_takenBatchesCount = 0;
+        qint64 m_performedBatchesCount = 0;
+        int m_flushRequestsCount = 0;
+        bool m_isStopped = false;
+        QWaitCondition m_flushCondition;
     };
 }
 
@@ -332,7 +441,10 @@ BitTorrent::DBResumeDataStorage::DBResumeDataStorage(const Path &dbPath, QObject
             updateDB(dbVersion);
     }
 
-    m_asyncWorker = new Worker(dbPath, m_dbLock, this);
+    m_checkpointer = new Checkpointer(dbPath, this);
+    m_checkpointer->start();
+
+    m_asyncWorker = new Worker(dbPath, m_dbLock, m_checkpointer, this);
     m_asyncWorker->start();
 }
 
@@ -340,6 +452,8 @@ BitTorrent::DBResumeDataStorage::~DBResumeDataStorage()
 {
     m_asyncWorker->requestInterruption();
     m_asyncWorker->wait();
+    m_checkpointer->requestInterruption();
+    m_checkpointer->wait();
     QSqlDatabase::removeDatabase(DB_CONNECTION_NAME);
 }
 
@@ -364,10 +478,39 @@ QVector<BitTorrent::TorrentID> BitTorrent::DBResumeDataStorage::registeredTorren
 
 BitTorrent::LoadResumeDataResult BitTorrent::DBResumeDataStorage::load(const TorrentID &id) const
 {
-    const QString selectTorrentStatement = u"SELECT * FROM %1 WHERE %2 = %3;"_s
+    const QString selectTorrentStatement = makeSelectTorrentsStatement() + u" WHERE %1.%2 = %3;"_s
         .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder);
 
-    auto db = QSqlDatabase::database(DB_CONNECTION_NAME);
+    QSqlDatabase db;
+    if (QThread::currentThread() == thread())
+    {
+        db = QSqlDatabase::database(DB_CONNECTION_NAME);
+    }
+    else
+    {
+        // Connection can be used only by the thread that created it,
+        // so resume data loaded in background (e.g. during migration) uses its own one
+        QThread *currentThread = QThread::currentThread();
+        const QString connectionName = u"%1-%2"_s.arg(DB_CONNECTION_NAME
+                , QString::number(reinterpret_cast<quintptr>(currentThread), 16));
+        if (!QSqlDatabase::contains(connectionName))
+        {
+            auto newDB = QSqlDatabase::addDatabase(u"QSQLITE"_s, connectionName);
+            newDB.setDatabaseName(path().data());
+            connect(currentThread, &QThread::finished, currentThread, [connectionName]()
+            {
+                QSqlDatabase::removeDatabase(connectionName);
+            }, Qt::DirectConnection);
+        }
+
+        db = QSqlDatabase::database(connectionName);
+        if (!db.isOpen())
+        {
+            return nonstd::make_unexpected(tr("Couldn't load resume data of torrent '%1'. Error: %2")
+                .arg(id.toString(), db.lastError().text()));
+        }
+    }
+
     QSqlQuery query {db};
     try
     {
@@ -392,7 +535,7 @@ BitTorrent::LoadResumeDataResult BitTorrent::DBResumeDataStorage::load(const Tor
 
 void BitTorrent::DBResumeDataStorage::store(const TorrentID &id, const LoadTorrentParams &resumeData) const
 {
-    m_asyncWorker->store(id, resumeData);
+    m_asyncWorker->store(id, resumeData, Preferences::instance()->isResumeDataCompressionEnabled());
 }
 
 void BitTorrent::DBResumeDataStorage::remove(const BitTorrent::TorrentID &id) const
@@ -405,6 +548,11 @@ void BitTorrent::DBResumeDataStorage::storeQueue(const QVector<TorrentID> &queue
     m_asyncWorker->storeQueue(queue);
 }
 
+void BitTorrent::DBResumeDataStorage::flush() const
+{
+    m_asyncWorker->flush();
+}
+
 void BitTorrent::DBResumeDataStorage::doLoadAll() const
 {
     const QString connectionName = u"ResumeDataStorageLoadAll"_s;
@@ -432,7 +580,11 @@ void BitTorrent::DBResumeDataStorage::doLoadAll() const
 
         emit const_cast<DBResumeDataStorage *>(this)->loadStarted(registeredTorrents);
 
-        const auto selectStatement = u"SELECT * FROM %1 ORDER BY %2;"_s.arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_QUEUE_POSITION.name));
+        const bool compressionEnabled = Preferences::instance()->isResumeDataCompressionEnabled();
+        QVector<TorrentID> torrentsToRecompress;
+
+        const auto selectStatement = makeSelectTorrentsStatement() + u" ORDER BY %1.%2;"_s
+                .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_QUEUE_POSITION.name));
         if (!query.exec(selectStatement))
             throw RuntimeError(query.lastError().text());
 
@@ -440,7 +592,14 @@ void BitTorrent::DBResumeDataStorage::doLoadAll() const
         {
             const auto torrentID = TorrentID::fromString(query.value(DB_COLUMN_TORRENT_ID.name).toString());
             onResumeDataLoaded(torrentID, parseQueryResultRow(query));
+
+            if (Utils::Gzip::isCompressed(query.value(DB_COLUMN_RESUMEDATA.name).toByteArray()) != compressionEnabled)
+                torrentsToRecompress.append(torrentID);
         }
+
+        // Resume data stored in other format is converted in background
+        for (const TorrentID &torrentID : asConst(torrentsToRecompress))
+            m_asyncWorker->recompress(torrentID, compressionEnabled);
     }
 
     emit const_cast<DBResumeDataStorage *>(this)->loadFinished();
@@ -535,13 +694,21 @@ void BitTorrent::DBResumeDataStorage::createDB() const
             makeColumnDefinition(DB_COLUMN_OPERATING_MODE, "TEXT NOT NULL"),
             makeColumnDefinition(DB_COLUMN_STOPPED, "INTEGER NOT NULL"),
             makeColumnDefinition(DB_COLUMN_STOP_CONDITION, "TEXT NOT NULL DEFAULT `None`"),
-            makeColumnDefinition(DB_COLUMN_RESUMEDATA, "BLOB NOT NULL"),
-            makeColumnDefinition(DB_COLUMN_METADATA, "BLOB")
+            makeColumnDefinition(DB_COLUMN_RESUMEDATA, "BLOB NOT NULL")
         };
         const QString createTableTorrentsQuery = makeCreateTableStatement(DB_TABLE_TORRENTS, tableTorrentsItems);
         if (!query.exec(createTableTorrentsQuery))
             throw RuntimeError(query.lastError().text());
 
+        const QStringList tableMetadataItems = {
+            makeColumnDefinition(DB_COLUMN_ID, "INTEGER PRIMARY KEY"),
+            makeColumnDefinition(DB_COLUMN_INFO_HASH, "BLOB NOT NULL UNIQUE"),
+            makeColumnDefinition(DB_COLUMN_DATA, "BLOB NOT NULL")
+        };
+        const QString createTableMetadataQuery = makeCreateTableStatement(DB_TABLE_METADATA, tableMetadataItems);
+        if (!query.exec(createTableMetadataQuery))
+            throw RuntimeError(query.lastError().text());
+
         const QString torrentsQueuePositionIndexName = u"%1_%2_INDEX"_s.arg(DB_TABLE_TORRENTS, DB_COLUMN_QUEUE_POSITION.name);
         const QString createTorrentsQueuePositionIndexQuery = u"CREATE INDEX %1 ON %2 (%3)"_s
                 .arg(quoted(torrentsQueuePositionIndexName), quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_QUEUE_POSITION.name));
@@ -622,6 +789,30 @@ void BitTorrent::DBResumeDataStorage::updateDB(const int fromVersion) const
             }
         }
 
+        if (fromVersion <= 5)
+        {
+            const QStringList tableMetadataItems = {
+                makeColumnDefinition(DB_COLUMN_ID, "INTEGER PRIMARY KEY"),
+                makeColumnDefinition(DB_COLUMN_INFO_HASH, "BLOB NOT NULL UNIQUE"),
+                makeColumnDefinition(DB_COLUMN_DATA, "BLOB NOT NULL")
+            };
+            const QString createTableMetadataQuery = u"CREATE TABLE IF NOT EXISTS %1 (%2)"_s
+                    .arg(quoted(DB_TABLE_METADATA), tableMetadataItems.join(u','));
+            if (!query.exec(createTableMetadataQuery))
+                throw RuntimeError(query.lastError().text());
+
+            const auto moveMetadataQuery = u"INSERT OR REPLACE INTO %1 (%2, %3) SELECT %4, %5 FROM %6 WHERE %5 IS NOT NULL;"_s
+                    .arg(quoted(DB_TABLE_METADATA), quoted(DB_COLUMN_INFO_HASH.name), quoted(DB_COLUMN_DATA.name)
+                            , quoted(DB_COLUMN_TORRENT_ID.name), quoted(DB_COLUMN_METADATA.name), quoted(DB_TABLE_TORRENTS));
+            if (!query.exec(moveMetadataQuery))
+                throw RuntimeError(query.lastError().text());
+
+            const auto clearLegacyMetadataQuery = u"UPDATE %1 SET %2 = NULL;"_s
+                    .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_METADATA.name));
+            if (!query.exec(clearLegacyMetadataQuery))
+                throw RuntimeError(query.lastError().text());
+        }
+
         const QString updateMetaVersionQuery = makeUpdateStatement(DB_TABLE_META, {DB_COLUMN_NAME, DB_COLUMN_VALUE});
         if (!query.prepare(updateMetaVersionQuery))
             throw RuntimeError(query.lastError().text());
@@ -658,10 +849,91 @@ void BitTorrent::DBResumeDataStorage::enableWALMode() const
         throw RuntimeError(tr("WAL mode is probably unsupported due to filesystem limitations."));
 }
 
-BitTorrent::DBResumeDataStorage::Worker::Worker(const Path &dbPath, QReadWriteLock &dbLock, QObject *parent)
+BitTorrent::DBResumeDataStorage::Checkpointer::Checkpointer(const Path &dbPath, QObject *parent)
+    : QThread(parent)
+    , m_path {dbPath}
+{
+}
+
+void BitTorrent::DBResumeDataStorage::Checkpointer::run()
+{
+    {
+        auto db = QSqlDatabase::addDatabase(u"QSQLITE"_s, m_connectionName);
+        db.setDatabaseName(m_path.data());
+        if (!db.open())
+        {
+            LogMsg(tr("Couldn't open resume data database for checkpointing. Error: %1").arg(db.lastError().text()), Log::WARNING);
+            QSqlDatabase::removeDatabase(m_connectionName);
+            return;
+        }
+
+        while (true)
+        {
+            m_mutex.lock();
+            while (!m_isCheckpointRequested && !isInterruptionRequested())
+                m_waitCondition.wait(&m_mutex);
+            m_isCheckpointRequested = false;
+            m_mutex.unlock();
+
+            // Final checkpoint is performed by SQLite itself when the last connection is closed
+            if (isInterruptionRequested())
+                break;
+
+            // Passive checkpoint doesn't wait for readers and writers so it never blocks
+            // resume data worker. It allows WAL to be reset by the next write transaction.
+            QSqlQuery query {db};
+            if (!query.exec(u"PRAGMA wal_checkpoint(PASSIVE);"_s))
+            {
+                LogMsg(tr("Couldn't checkpoint resume data database. Error: %1").arg(query.lastError().text()), Log::WARNING);
+            }
+            else if (query.next())
+            {
+                qDebug() << "Resume data WAL checkpoint is performed. Busy:" << query.value(0).toInt()
+                         << "WAL frames:" << query.value(1).toInt()
+                         << "Checkpointed frames:" << query.value(2).toInt();
+            }
+            query.finish();
+
+            m_mutex.lock();
+            const QDeadlineTimer deadline {WAL_CHECKPOINT_INTERVAL};
+            while (!isInterruptionRequested() && !deadline.hasExpired())
+                m_waitCondition.wait(&m_mutex, deadline);
+            m_mutex.unlock();
+        }
+
+        db.close();
+    }
+
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+void BitTorrent::DBResumeDataStorage::Checkpointer::requestInterruption()
+{
+    m_mutex.lock();
+    QThread::requestInterruption();
+    m_mutex.unlock();
+
+    m_waitCondition.wakeAll();
+}
+
+void BitTorrent::DBResumeDataStorage::Checkpointer::requestCheckpoint()
+{
+    m_mutex.lock();
+    m_isCheckpointRequested = true;
+    m_mutex.unlock();
+
+    m_waitCondition.wakeAll();
+}
+
+BitTorrent::DBResumeDataStorage::Worker::Worker(const Path &dbPath, QReadWriteLock &dbLock, Checkpointer *checkpointer, QObject *parent)
     : QThread(parent)
     , m_path {dbPath}
     , m_dbLock {dbLock}
+    , m_checkpointer {checkpointer}
+    , m_commitInterval {Preferences::instance()->getResumeDataCommitInterval()}
+    , m_commitJobsLimit {Preferences::instance()->getResumeDataCommitJobsLimit()}
+    , m_isRelaxedDurabilityEnabled {Preferences::instance()->isResumeDataRelaxedDurabilityEnabled()}
+    , m_walAutoCheckpoint {Preferences::instance()->getResumeDataWALAutoCheckpoint()}
 {
 }
 
@@ -673,97 +945,246 @@ void BitTorrent::DBResumeDataStorage::Worker::run()
         if (!db.open())
             throw RuntimeError(db.lastError().text());
 
-        int64_t transactedJobsCount = 0;
-        while (true)
+        applyConnectionOptions(db);
+
         {
-            m_jobsMutex.lock();
-            if (m_jobs.empty())
+            QueryCache queryCache {db};
+
+            int64_t performedJobsCount = 0;
+            while (true)
             {
-                if (transactedJobsCount > 0)
-                {
-                    db.commit();
-                    m_dbLock.unlock();
+                m_jobsMutex.lock();
+                while (!hasPendingJobs() && !isInterruptionRequested())
+                    m_waitCondition.wait(&m_jobsMutex);
 
-                    qDebug() << "Resume data changes are committed. Transacted jobs:" << transactedJobsCount;
-                    transactedJobsCount = 0;
+                // Let the jobs accumulate (and coalesce) for a while
+                // so that they are written using a single transaction
+                if (m_commitInterval > 0)
+                {
+                    const QDeadlineTimer deadline {m_commitInterval};
+                    while (!isInterruptionRequested() && !isCommitJobsLimitReached()
+                           && (m_flushRequestsCount == 0) && !deadline.hasExpired())
+                    {
+                        m_waitCondition.wait(&m_jobsMutex, deadline);
+                    }
                 }
 
-                if (isInterruptionRequested())
+                // Pending jobs are still performed when interruption is requested
+                if (!hasPendingJobs())
                 {
                     m_jobsMutex.unlock();
                     break;
                 }
 
-                m_waitCondition.wait(&m_jobsMutex);
-                if (isInterruptionRequested())
+                // Take all the pending jobs at once. Jobs that arrive while
+                // these ones are performed are coalesced with each other.
+                const QHash<TorrentID, std::shared_ptr<Job>> torrentJobs = std::exchange(m_pendingJobs, {});
+                const std::shared_ptr<Job> queueJob = std::exchange(m_pendingQueueJob, nullptr);
+                ++m_takenBatchesCount;
+                // Counters are updated by the other threads so they are read while the lock is held
+                const qint64 requestedJobsCount = m_requestedJobsCount;
+                const qint64 coalescedJobsCount = m_coalescedJobsCount;
+                m_jobsMutex.unlock();
+
+                const auto logLostJobs = [&torrentJobs, &queueJob]()
                 {
-                    m_jobsMutex.unlock();
-                    break;
-                }
+                    for (auto it = torrentJobs.cbegin(); it != torrentJobs.cend(); ++it)
+                        LogMsg(tr("Resume data changes are lost. Torrent: \"%1\"").arg(it.key().toString()), Log::WARNING);
+                    if (queueJob)
+                        LogMsg(tr("Torrents queue changes are lost."), Log::WARNING);
+                };
 
                 m_dbLock.lockForWrite();
                 if (!db.transaction())
                 {
                     LogMsg(tr("Couldn't begin transaction. Error: %1").arg(db.lastError().text()), Log::WARNING);
                     m_dbLock.unlock();
+                    logLostJobs();
                     break;
                 }
-            }
-            std::unique_ptr<Job> job = std::move(m_jobs.front());
-            m_jobs.pop();
-            m_jobsMutex.unlock();
 
-            job->perform(db);
-            ++transactedJobsCount;
+                for (const std::shared_ptr<Job> &job : torrentJobs)
+                    job->perform(queryCache);
+
+                // Queue positions are stored after torrent jobs
+                // so that newly stored torrents get their positions too
+                if (queueJob)
+                    queueJob->perform(queryCache);
+
+                const bool isCommitted = db.commit();
+                const QString commitError = isCommitted ? QString() : db.lastError().text();
+                if (!isCommitted)
+                    db.rollback();
+                m_dbLock.unlock();
+
+                m_jobsMutex.lock();
+                m_performedBatchesCount = m_takenBatchesCount;
+                m_jobsMutex.unlock();
+                m_flushCondition.wakeAll();
+
+                const qsizetype transactedJobsCount = torrentJobs.size() + (queueJob ? 1 : 0);
+                performedJobsCount += transactedJobsCount;
+                if (!isCommitted)
+                {
+                    LogMsg(tr("Couldn't store resume data. Error: %1").arg(commitError), Log::WARNING);
+                    logLostJobs();
+                    continue;
+                }
+
+                qDebug() << "Resume data changes are committed. Transacted jobs:" << transactedJobsCount
+                         << "Requested jobs (total):" << requestedJobsCount
+                         << "Performed jobs (total):" << performedJobsCount
+                         << "Coalesced jobs (total):" << coalescedJobsCount;
+
+                if (m_checkpointer)
+                    m_checkpointer->requestCheckpoint();
+            }
         }
 
         db.close();
     }
 
+    // Nothing is going to be performed anymore so flush shouldn't wait for it
+    m_jobsMutex.lock();
+    m_isStopped = true;
+    m_jobsMutex.unlock();
+    m_flushCondition.wakeAll();
+
     QSqlDatabase::removeDatabase(m_connectionName);
 }
 
 void DBResumeDataStorage::Worker::requestInterruption()
 {
+    m_jobsMutex.lock();
     QThread::requestInterruption();
+    m_jobsMutex.unlock();
+
     m_waitCondition.wakeAll();
 }
 
-void BitTorrent::DBResumeDataStorage::Worker::store(const TorrentID &id, const LoadTorrentParams &resumeData)
+void BitTorrent::DBResumeDataStorage::Worker::store(const TorrentID &id, const LoadTorrentParams &resumeData, const bool compress)
 {
-    addJob(std::make_unique<StoreJob>(id, resumeData));
+    addJob(id, std::make_shared<StoreJob>(id, resumeData, compress));
 }
 
 void BitTorrent::DBResumeDataStorage::Worker::remove(const TorrentID &id)
 {
-    addJob(std::make_unique<RemoveJob>(id));
+    // Removing torrent cancels its pending store job (if any)
+    addJob(id, std::make_shared<RemoveJob>(id));
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::recompress(const TorrentID &id, const bool compress)
+{
+    m_jobsMutex.lock();
+    // pending job (if any) stores resume data in actual format or removes it at all
+    if (!m_pendingJobs.contains(id))
+    {
+        ++m_requestedJobsCount;
+        m_pendingJobs.insert(id, std::make_shared<RecompressJob>(id, compress));
+    }
+    m_jobsMutex.unlock();
+
+    m_waitCondition.wakeAll();
 }
 
 void BitTorrent::DBResumeDataStorage::Worker::storeQueue(const QVector<TorrentID> &queue)
 {
-    addJob(std::make_unique<StoreQueueJob>(queue));
+    m_jobsMutex.lock();
+    ++m_requestedJobsCount;
+    if (m_pendingQueueJob)
+        ++m_coalescedJobsCount;
+    m_pendingQueueJob = std::make_shared<StoreQueueJob>(queue);
+    m_jobsMutex.unlock();
+
+    m_waitCondition.wakeAll();
 }
 
-void BitTorrent::DBResumeDataStorage::Worker::addJob(std::unique_ptr<Job> job)
+void BitTorrent::DBResumeDataStorage::Worker::flush()
 {
     m_jobsMutex.lock();
-    m_jobs.push(std::move(job));
+    // Pending jobs get into the next batch while the taken ones are being performed
+    const qint64 batchToWait = m_takenBatchesCount + (hasPendingJobs() ? 1 : 0);
+    ++m_flushRequestsCount;
+    m_waitCondition.wakeAll();
+    while (!m_isStopped && (m_performedBatchesCount < batchToWait))
+        m_flushCondition.wait(&m_jobsMutex);
+    --m_flushRequestsCount;
+    m_jobsMutex.unlock();
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::addJob(const TorrentID &id, std::shared_ptr<Job> job)
+{
+    m_jobsMutex.lock();
+    ++m_requestedJobsCount;
+    // the last job for given torrent supersedes the pending one
+    std::shared_ptr<Job> &pendingJob = m_pendingJobs[id];
+    if (pendingJob)
+        ++m_coalescedJobsCount;
+    pendingJob = std::move(job);
     m_jobsMutex.unlock();
 
     m_waitCondition.wakeAll();
 }
 
+bool BitTorrent::DBResumeDataStorage::Worker::isCommitJobsLimitReached() const
+{
+    if (m_commitJobsLimit <= 0)
+        return false;
+
+    return ((m_pendingJobs.size() + (m_pendingQueueJob ? 1 : 0)) >= m_commitJobsLimit);
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::applyConnectionOptions(const QSqlDatabase &db) const
+{
+    QSqlQuery query {db};
+
+    // In WAL mode "NORMAL" keeps database consistent but the last transactions
+    // might be rolled back following a power loss or system crash
+    const QString synchronousMode = m_isRelaxedDurabilityEnabled ? u"NORMAL"_s : u"FULL"_s;
+    if (!query.exec(u"PRAGMA synchronous = %1;"_s.arg(synchronousMode)))
+        LogMsg(tr("Couldn't set resume data database synchronous mode. Error: %1").arg(query.lastError().text()), Log::WARNING);
+
+    // WAL is also checkpointed in background so automatic checkpoints can be disabled (0)
+    // to never block writing resume data
+    if (!query.exec(u"PRAGMA wal_autocheckpoint = %1;"_s.arg(std::max(0, m_walAutoCheckpoint))))
+        LogMsg(tr("Couldn't set resume data database auto checkpoint. Error: %1").arg(query.lastError().text()), Log::WARNING);
+}
+
+bool BitTorrent::DBResumeDataStorage::Worker::hasPendingJobs() const
+{
+    return (!m_pendingJobs.isEmpty() || m_pendingQueueJob);
+}
+
 namespace
 {
     using namespace BitTorrent;
 
-    StoreJob::StoreJob(const TorrentID &torrentID, const LoadTorrentParams &resumeData)
+    QueryCache::QueryCache(QSqlDatabase db)
+        : m_db {std::move(db)}
+    {
+    }
+
+    QSqlQuery &QueryCache::prepared(const QString &statement)
+    {
+        const auto iter = m_queries.find(statement);
+        if (iter != m_queries.end())
+            return iter.value();
+
+        QSqlQuery query {m_db};
+        if (!query.prepare(statement))
+            throw RuntimeError(query.lastError().text());
+
+        return m_queries.insert(statement, query).value();
+    }
+
+    StoreJob::StoreJob(const TorrentID &torrentID, const LoadTorrentParams &resumeData, const bool compress)
         : m_torrentID {torrentID}
         , m_resumeData {resumeData}
+        , m_compress {compress}
     {
     }
 
-    void StoreJob::perform(QSqlDatabase db)
+    void StoreJob::perform(QueryCache &queryCache)
     {
         // We need to adjust native libtorrent resume data
         lt::add_torrent_params p = m_resumeData.ltAddTorrentParams;
@@ -789,7 +1210,7 @@ namespace
             }
         }
 
-        QVector<Column> columns {
+        const QVector<Column> columns {
             DB_COLUMN_TORRENT_ID,
             DB_COLUMN_NAME,
             DB_COLUMN_CATEGORY,
@@ -810,7 +1231,8 @@ namespace
 
         lt::entry data = lt::write_resume_data(p);
 
-        // metadata is stored in separate column
+        // metadata is stored in separate table.
+        // It never changes once received so it is written only if it isn't stored yet.
         QByteArray bencodedMetadata;
         if (p.ti)
         {
@@ -824,8 +1246,17 @@ namespace
 
             try
             {
-                bencodedMetadata.reserve(512 * 1024);
-                lt::bencode(std::back_inserter(bencodedMetadata), metadata);
+                if (!isMetadataStored(queryCache))
+                {
+                    bencodedMetadata.reserve(512 * 1024);
+                    lt::bencode(std::back_inserter(bencodedMetadata), metadata);
+                }
+            }
+            catch (const RuntimeError &err)
+            {
+                LogMsg(ResumeDataStorage::tr("Couldn't save torrent metadata. Error: %1.")
+                        .arg(err.message()), Log::CRITICAL);
+                return;
             }
             catch (const std::exception &err)
             {
@@ -833,28 +1264,34 @@ namespace
                         .arg(QString::fromLocal8Bit(err.what())), Log::CRITICAL);
                 return;
             }
-
-            columns.append(DB_COLUMN_METADATA);
         }
 
         QByteArray bencodedResumeData;
         bencodedResumeData.reserve(256 * 1024);
         lt::bencode(std::back_inserter(bencodedResumeData), data);
+        if (m_compress)
+        {
+            bool ok = false;
+            const QByteArray compressedResumeData = Utils::Gzip::compress(bencodedResumeData, 6, &ok);
+            // Uncompressed data is stored rather than losing it, it is loaded the same way
+            if (ok)
+                bencodedResumeData = compressedResumeData;
+            else
+                LogMsg(ResumeDataStorage::tr("Couldn't compress resume data. Torrent: \"%1\"").arg(m_torrentID.toString()), Log::WARNING);
+        }
 
         const QString insertTorrentStatement = makeInsertStatement(DB_TABLE_TORRENTS, columns)
                 + makeOnConflictUpdateStatement(DB_COLUMN_TORRENT_ID, columns);
-        QSqlQuery query {db};
 
         try
         {
-            if (!query.prepare(insertTorrentStatement))
-                throw RuntimeError(query.lastError().text());
+            QSqlQuery &query = queryCache.prepared(insertTorrentStatement);
 
             query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, m_torrentID.toString());
             query.bindValue(DB_COLUMN_NAME.placeholder, m_resumeData.name);
             query.bindValue(DB_COLUMN_CATEGORY.placeholder, m_resumeData.category);
             query.bindValue(DB_COLUMN_TAGS.placeholder, (m_resumeData.tags.isEmpty()
-                    ? QVariant(QVariant::String) : m_resumeData.tags.join(u","_s)));
+                    ? nullString() : m_resumeData.tags.join(u","_s)));
             query.bindValue(DB_COLUMN_CONTENT_LAYOUT.placeholder, Utils::String::fromEnum(m_resumeData.contentLayout));
             query.bindValue(DB_COLUMN_RATIO_LIMIT.placeholder, static_cast<int>(m_resumeData.ratioLimit * 1000));
             query.bindValue(DB_COLUMN_SEEDING_TIME_LIMIT.placeholder, m_resumeData.seedingTimeLimit);
@@ -870,13 +1307,20 @@ namespace
                 query.bindValue(DB_COLUMN_TARGET_SAVE_PATH.placeholder, Profile::instance()->toPortablePath(m_resumeData.savePath).data());
                 query.bindValue(DB_COLUMN_DOWNLOAD_PATH.placeholder, Profile::instance()->toPortablePath(m_resumeData.downloadPath).data());
             }
+            else
+            {
+                // prepared query is reused so we need to reset previously bound values
+                query.bindValue(DB_COLUMN_TARGET_SAVE_PATH.placeholder, nullString());
+                query.bindValue(DB_COLUMN_DOWNLOAD_PATH.placeholder, nullString());
+            }
 
             query.bindValue(DB_COLUMN_RESUMEDATA.placeholder, bencodedResumeData);
-            if (!bencodedMetadata.isEmpty())
-                query.bindValue(DB_COLUMN_METADATA.placeholder, bencodedMetadata);
 
             if (!query.exec())
                 throw RuntimeError(query.lastError().text());
+
+            if (!bencodedMetadata.isEmpty())
+                storeMetadata(queryCache, bencodedMetadata);
         }
         catch (const RuntimeError &err)
         {
@@ -885,26 +1329,62 @@ namespace
         }
     }
 
+    bool StoreJob::isMetadataStored(QueryCache &queryCache) const
+    {
+        const auto selectMetadataStatement = u"SELECT 1 FROM %1 WHERE %2 = %3;"_s
+                .arg(quoted(DB_TABLE_METADATA), quoted(DB_COLUMN_INFO_HASH.name), DB_COLUMN_INFO_HASH.placeholder);
+
+        QSqlQuery &query = queryCache.prepared(selectMetadataStatement);
+        query.bindValue(DB_COLUMN_INFO_HASH.placeholder, m_torrentID.toString());
+        if (!query.exec())
+            throw RuntimeError(query.lastError().text());
+
+        const bool isStored = query.next();
+        query.finish();
+        return isStored;
+    }
+
+    void StoreJob::storeMetadata(QueryCache &queryCache, const QByteArray &bencodedMetadata) const
+    {
+        // metadata is addressed by info hash which torrent ID is derived from
+        const QVector<Column> columns {DB_COLUMN_INFO_HASH, DB_COLUMN_DATA};
+        const QString insertMetadataStatement = makeInsertStatement(DB_TABLE_METADATA, columns)
+                + makeOnConflictUpdateStatement(DB_COLUMN_INFO_HASH, columns);
+
+        QSqlQuery &query = queryCache.prepared(insertMetadataStatement);
+        query.bindValue(DB_COLUMN_INFO_HASH.placeholder, m_torrentID.toString());
+        query.bindValue(DB_COLUMN_DATA.placeholder, bencodedMetadata);
+        if (!query.exec())
+            throw RuntimeError(query.lastError().text());
+    }
+
     RemoveJob::RemoveJob(const TorrentID &torrentID)
         : m_torrentID {torrentID}
     {
     }
 
-    void RemoveJob::perform(QSqlDatabase db)
+    void RemoveJob::perform(QueryCache &queryCache)
     {
         const auto deleteTorrentStatement = u"DELETE FROM %1 WHERE %2 = %3;"_s
                 .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder);
+        const auto deleteMetadataStatement = u"DELETE FROM %1 WHERE %2 = %3;"_s
+                .arg(quoted(DB_TABLE_METADATA), quoted(DB_COLUMN_INFO_HASH.name), DB_COLUMN_INFO_HASH.placeholder);
 
-        QSqlQuery query {db};
         try
         {
-            if (!query.prepare(deleteTorrentStatement))
-                throw RuntimeError(query.lastError().text());
+            QSqlQuery &query = queryCache.prepared(deleteTorrentStatement);
 
             query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, m_torrentID.toString());
 
             if (!query.exec())
                 throw RuntimeError(query.lastError().text());
+
+            QSqlQuery &metadataQuery = queryCache.prepared(deleteMetadataStatement);
+
+            metadataQuery.bindValue(DB_COLUMN_INFO_HASH.placeholder, m_torrentID.toString());
+
+            if (!metadataQuery.exec())
+                throw RuntimeError(metadataQuery.lastError().text());
         }
         catch (const RuntimeError &err)
         {
@@ -913,12 +1393,64 @@ namespace
         }
     }
 
+    RecompressJob::RecompressJob(const TorrentID &torrentID, const bool compress)
+        : m_torrentID {torrentID}
+        , m_compress {compress}
+    {
+    }
+
+    void RecompressJob::perform(QueryCache &queryCache)
+    {
+        const auto selectResumeDataStatement = u"SELECT %1 FROM %2 WHERE %3 = %4;"_s
+                .arg(quoted(DB_COLUMN_RESUMEDATA.name), quoted(DB_TABLE_TORRENTS)
+                        , quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder);
+        const auto updateResumeDataStatement = u"UPDATE %1 SET %2 = %3 WHERE %4 = %5;"_s
+                .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_RESUMEDATA.name), DB_COLUMN_RESUMEDATA.placeholder
+                        , quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder);
+
+        try
+        {
+            QSqlQuery &selectQuery = queryCache.prepared(selectResumeDataStatement);
+            selectQuery.bindValue(DB_COLUMN_TORRENT_ID.placeholder, m_torrentID.toString());
+            if (!selectQuery.exec())
+                throw RuntimeError(selectQuery.lastError().text());
+
+            // torrent could be removed meanwhile
+            if (!selectQuery.next())
+            {
+                selectQuery.finish();
+                return;
+            }
+
+            const QByteArray data = selectQuery.value(0).toByteArray();
+            selectQuery.finish();
+            if (Utils::Gzip::isCompressed(data) == m_compress)
+                return;
+
+            bool ok = false;
+            const QByteArray convertedData = m_compress ? Utils::Gzip::compress(data, 6, &ok) : Utils::Gzip::decompress(data, &ok);
+            if (!ok)
+                throw RuntimeError(ResumeDataStorage::tr("Couldn't convert data."));
+
+            QSqlQuery &updateQuery = queryCache.prepared(updateResumeDataStatement);
+            updateQuery.bindValue(DB_COLUMN_RESUMEDATA.placeholder, convertedData);
+            updateQuery.bindValue(DB_COLUMN_TORRENT_ID.placeholder, m_torrentID.toString());
+            if (!updateQuery.exec())
+                throw RuntimeError(updateQuery.lastError().text());
+        }
+        catch (const RuntimeError &err)
+        {
+            LogMsg(ResumeDataStorage::tr("Couldn't store resume data for torrent '%1'. Error: %2")
+                    .arg(m_torrentID.toString(), err.message()), Log::WARNING);
+        }
+    }
+
     StoreQueueJob::StoreQueueJob(const QVector<TorrentID> &queue)
         : m_queue {queue}
     {
     }
 
-    void StoreQueueJob::perform(QSqlDatabase db)
+    void StoreQueueJob::perform(QueryCache &queryCache)
     {
         const auto updateQueuePosStatement = u"UPDATE %1 SET %2 = %3 WHERE %4 = %5;"_s
                 .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_QUEUE_POSITION.name), DB_COLUMN_QUEUE_POSITION.placeholder
@@ -926,10 +1458,7 @@ namespace
 
         try
         {
-            QSqlQuery query {db};
-
-            if (!query.prepare(updateQueuePosStatement))
-                throw RuntimeError(query.lastError().text());
+            QSqlQuery &query = queryCache.prepared(updateQueuePosStatement);
 
             int pos = 0;
             for (const TorrentID &torrentID : m_queue)
@@ -53,6 +53,7 @@ namespace BitTorrent
         void store(const TorrentID &id, const LoadTorrentParams &resumeData) const override;
         void remove(const TorrentID &id) const override;
         void storeQueue(const QVector<TorrentID> &queue) const override;
+        void flush() const override;
 
     private:
         void doLoadAll() const override;
@@ -66,6 +67,9 @@ namespace BitTorrent
         class Worker;
         Worker *m_asyncWorker = nullptr;
 
+        class Checkpointer;
+        Checkpointer *m_checkpointer = nullptr;
+
         mutable QReadWriteLock m_dbLock;
     };
 }
@@ -28,414 +28,576 @@
 
 #include "filterparserthread.h"
 
-#include <cctype>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
 
 #include <libtorrent/error_code.hpp>
 
+#include <QCryptographicHash>
 #include <QDataStream>
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
+#include <QThreadPool>
 
 #include "base/global.h"
 #include "base/logger.h"
+#include "base/profile.h"
+#include "base/utils/fs.h"
+#include "base/utils/io.h"
 
 namespace
 {
-    class IPv4Parser
+    const int MAX_LOGGED_ERRORS = 5;
+    // Text filter files are split into chunks of at least this size to be parsed in parallel
+    const qint64 MIN_CHUNK_SIZE = 1024 * 1024; // 1 MiB
+    const qint64 ABORT_CHECK_INTERVAL = 4096; // lines
+
+    const QString FILTER_CACHE_DIRNAME = u"ipfilter"_s;
+    const QByteArray FILTER_CACHE_MAGIC = QByteArrayLiteral("qBtIPFilterCache");
+    const qint32 FILTER_CACHE_VERSION = 1;
+
+    enum class LineParseResult
     {
-    public:
-        bool tryParse(const char *str)
-        {
-            unsigned char octetIndex = 0;
+        Rule,
+        Ignored,
+        Malformed,
+        MalformedStartIP,
+        MalformedEndIP,
+        IPVersionMismatch,
+        Exception
+    };
 
-            const char *octetStart = str;
-            char *endptr = nullptr;
-            for (; *str; ++str)
-            {
-                if (*str == '.')
-                {
-                    const long int extractedNum = strtol(octetStart, &endptr, 10);
-                    if ((extractedNum >= 0L) && (extractedNum <= 255L))
-                        m_buf[octetIndex++] = static_cast<unsigned char>(extractedNum);
-                    else
-                        return false;
-
-                    if (endptr != str)
-                        return false;
-                    if (octetIndex == 4)
-                        return true;
-
-                    octetStart = str + 1;
-                }
-            }
+    using LineParser = LineParseResult (*)(std::string_view line, lt::address &first, lt::address &last);
+
+    struct ParseError
+    {
+        qint64 line = 0;
+        LineParseResult type = LineParseResult::Malformed;
+        QString details;
+    };
+
+    struct ChunkParseResult
+    {
+        lt::ip_filter filter;
+        int ruleCount = 0;
+        qint64 linesCount = 0;
+        int errorCount = 0;
+        // Only the errors that can be logged are kept
+        std::vector<ParseError> errors;
+    };
 
-            if (str != octetStart)
+    bool isSpace(const char c)
+    {
+        return ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') || (c == '\v') || (c == '\f'));
+    }
+
+    std::string_view trimmed(std::string_view str)
+    {
+        while (!str.empty() && isSpace(str.front()))
+            str.remove_prefix(1);
+        while (!str.empty() && isSpace(str.back()))
+            str.remove_suffix(1);
+        return str;
+    }
+
+    // Parses dotted-quad IPv4 address without any intermediate conversions.
+    // Octets can have leading zeros, e.g. "001.009.096.105" as used by eMule DAT format.
+    bool parseIPv4Address(const std::string_view str, lt::address_v4::bytes_type &bytes)
+    {
+        int octetIndex = 0;
+        unsigned int octet = 0;
+        bool hasDigits = false;
+        for (const char c : str)
+        {
+            const unsigned int digit = static_cast<unsigned char>(c) - static_cast<unsigned int>('0');
+            if (digit <= 9)
             {
-                const long int extractedNum = strtol(octetStart, &endptr, 10);
-                if ((extractedNum >= 0L) && (extractedNum <= 255L))
-                    m_buf[octetIndex] = static_cast<unsigned char>(strtol(octetStart, &endptr, 10));
-                else
+                octet = (octet * 10) + digit;
+                if (octet > 255)
                     return false;
-
-                if ((endptr == str) && (octetIndex == 3))
-                    return true;
+                hasDigits = true;
             }
+            else if ((c == '.') && hasDigits && (octetIndex < 3))
+            {
+                bytes[octetIndex++] = static_cast<unsigned char>(octet);
+                octet = 0;
+                hasDigits = false;
+            }
+            else
+            {
+                return false;
+            }
+        }
 
+        if ((octetIndex != 3) || !hasDigits)
             return false;
-        }
 
-        lt::address_v4::bytes_type parsed() const
+        bytes[3] = static_cast<unsigned char>(octet);
+        return true;
+    }
+
+    bool parseIPAddress(const std::string_view str, lt::address &address)
+    {
+        lt::address_v4::bytes_type bytes {};
+        if (parseIPv4Address(str, bytes))
         {
-            return m_buf;
+            address = lt::address_v4(bytes);
+            return true;
         }
 
-    private:
-        lt::address_v4::bytes_type m_buf {};
-    };
-
-    bool parseIPAddress(const char *data, lt::address &address)
-    {
-        IPv4Parser parser;
         lt::error_code ec;
-
-        if (parser.tryParse(data))
-            address = lt::address_v4(parser.parsed());
-        else
-            address = lt::make_address(data, ec);
-
+        address = lt::make_address(std::string(str), ec);
         return !ec;
     }
 
-    const int BUFFER_SIZE = 2 * 1024 * 1024; // 2 MiB
-    const int MAX_LOGGED_ERRORS = 5;
-}
+    LineParseResult parseIPRange(const std::string_view range, lt::address &first, lt::address &last)
+    {
+        // IP Range should be split by a dash
+        const std::string_view::size_type delimIP = range.find('-');
+        if (delimIP == std::string_view::npos)
+            return LineParseResult::Malformed;
 
-FilterParserThread::FilterParserThread(QObject *parent)
-    : QThread(parent)
-{
-}
+        if (!parseIPAddress(trimmed(range.substr(0, delimIP)), first))
+            return LineParseResult::MalformedStartIP;
 
-FilterParserThread::~FilterParserThread()
-{
-    m_abort = true;
-    wait();
-}
+        if (!parseIPAddress(trimmed(range.substr(delimIP + 1)), last))
+            return LineParseResult::MalformedEndIP;
 
-// Parser for eMule ip filter in DAT format
-int FilterParserThread::parseDATFilterFile()
-{
-    int ruleCount = 0;
-    QFile file {m_filePath.data()};
-    if (!file.exists()) return ruleCount;
+        if ((first.is_v4() != last.is_v4()) || (first.is_v6() != last.is_v6()))
+            return LineParseResult::IPVersionMismatch;
+
+        return LineParseResult::Rule;
+    }
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    // Parser for eMule ip filter in DAT format
+    LineParseResult parseDATLine(const std::string_view line, lt::address &first, lt::address &last)
     {
-        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
-        return ruleCount;
+        // Each line should follow this format:
+        // 001.009.096.105 - 001.009.096.105 , 000 , Some organization
+        // The 3rd entry is access level and if above 127 the IP range isn't blocked.
+        const std::string_view::size_type firstComma = line.find(',');
+        if (firstComma == std::string_view::npos)
+            return parseIPRange(line, first, last);
+
+        // Check if there is an access value (apparently not mandatory)
+        std::string_view accessValue = line.substr(firstComma + 1);
+        accessValue = trimmed(accessValue.substr(0, accessValue.find(',')));
+        long int nbAccess = 0;
+        for (const char c : accessValue)
+        {
+            if ((c < '0') || (c > '9'))
+                break;
+
+            nbAccess = (nbAccess * 10) + (c - '0');
+            // Ignoring this rule because access value is too high
+            if (nbAccess > 127L)
+                return LineParseResult::Ignored;
+        }
+
+        return parseIPRange(line.substr(0, firstComma), first, last);
     }
 
-    std::vector<char> buffer(BUFFER_SIZE, 0); // seems a bit faster than QVector
-    qint64 bytesRead = 0;
-    int offset = 0;
-    int start = 0;
-    int endOfLine = -1;
-    int nbLine = 0;
-    int parseErrorCount = 0;
-    const auto addLog = [&parseErrorCount](const QString &msg)
-    {
-        if (parseErrorCount <= MAX_LOGGED_ERRORS)
-            LogMsg(msg, Log::CRITICAL);
-    };
+    // Parser for PeerGuardian ip filter in p2p format
+    LineParseResult parseP2PLine(const std::string_view line, lt::address &first, lt::address &last)
+    {
+        // Each line should follow this format:
+        // Some organization:1.0.0.0-1.255.255.255
+        // The "Some organization" part might contain a ':' char itself so we find the last occurrence
+        const std::string_view::size_type partsDelimiter = line.rfind(':');
+        if (partsDelimiter == std::string_view::npos)
+            return LineParseResult::Malformed;
+
+        return parseIPRange(line.substr(partsDelimiter + 1), first, last);
+    }
 
-    while (true)
+    ChunkParseResult parseChunk(const std::string_view chunk, const LineParser parseLine, const std::atomic_bool &abort)
     {
-        bytesRead = file.read(buffer.data() + offset, BUFFER_SIZE - offset - 1);
-        if (bytesRead < 0)
-            break;
-        const int dataSize = bytesRead + offset;
-        if ((bytesRead == 0) && (dataSize == 0))
-            break;
+        ChunkParseResult result;
 
-        for (start = 0; start < dataSize; ++start)
+        const auto addError = [&result](const LineParseResult type, const QString &details = {})
         {
-            endOfLine = -1;
-            // The file might have ended without the last line having a newline
-            if (!((bytesRead == 0) && (dataSize > 0)))
-            {
-                for (int i = start; i < dataSize; ++i)
-                {
-                    if (buffer[i] == '\n')
-                    {
-                        endOfLine = i;
-                        // We need to NULL the newline in case the line has only an IP range.
-                        // In that case the parser won't work for the end IP, because it ends
-                        // with the newline and not with a number.
-                        buffer[i] = '\0';
-                        break;
-                    }
-                }
-            }
-            else
-            {
-                endOfLine = dataSize;
-                buffer[dataSize] = '\0';
-            }
-
-            if (endOfLine == -1)
-            {
-                // read the next chunk from file
-                // but first move(copy) the leftover data to the front of the buffer
-                offset = dataSize - start;
-                memmove(buffer.data(), buffer.data() + start, offset);
+            ++result.errorCount;
+            if (static_cast<int>(result.errors.size()) < MAX_LOGGED_ERRORS)
+                result.errors.push_back({result.linesCount, type, details});
+        };
+
+        const char *lineBegin = chunk.data();
+        const char *const chunkEnd = chunk.data() + chunk.size();
+        while (lineBegin < chunkEnd)
+        {
+            if (((result.linesCount % ABORT_CHECK_INTERVAL) == 0) && abort)
                 break;
-            }
-
-            ++nbLine;
-
-            if ((buffer[start] == '#')
-                || ((buffer[start] == '/') && ((start + 1 < dataSize) && (buffer[start + 1] == '/'))))
-                {
-                start = endOfLine;
-                continue;
-            }
 
-            // Each line should follow this format:
-            // 001.009.096.105 - 001.009.096.105 , 000 , Some organization
-            // The 3rd entry is access level and if above 127 the IP range isn't blocked.
-            const int firstComma = findAndNullDelimiter(buffer.data(), ',', start, endOfLine);
-            if (firstComma != -1)
-                findAndNullDelimiter(buffer.data(), ',', firstComma + 1, endOfLine);
+            // memchr() is usually vectorized so it finds line ends much faster than byte-by-byte loop
+            const auto *lineEnd = static_cast<const char *>(std::memchr(lineBegin, '\n', (chunkEnd - lineBegin)));
+            if (!lineEnd)
+                lineEnd = chunkEnd;
 
-            // Check if there is an access value (apparently not mandatory)
-            if (firstComma != -1)
-            {
-                // There is possibly one
-                const long int nbAccess = strtol(buffer.data() + firstComma + 1, nullptr, 10);
-                // Ignoring this rule because access value is too high
-                if (nbAccess > 127L)
-                {
-                    start = endOfLine;
-                    continue;
-                }
-            }
+            const std::string_view line = trimmed({lineBegin, static_cast<std::string_view::size_type>(lineEnd - lineBegin)});
+            lineBegin = lineEnd + 1;
+            ++result.linesCount;
 
-            // IP Range should be split by a dash
-            const int endOfIPRange = ((firstComma == -1) ? (endOfLine - 1) : (firstComma - 1));
-            const int delimIP = findAndNullDelimiter(buffer.data(), '-', start, endOfIPRange);
-            if (delimIP == -1)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
+            if (line.empty() || (line.front() == '#') || (line.substr(0, 2) == "//"))
                 continue;
-            }
 
-            lt::address startAddr;
-            int newStart = trim(buffer.data(), start, delimIP - 1);
-            if (!parseIPAddress(buffer.data() + newStart, startAddr))
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. Start IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
+            lt::address first;
+            lt::address last;
+            const LineParseResult parseResult = parseLine(line, first, last);
+            if (parseResult == LineParseResult::Ignored)
                 continue;
-            }
 
-            lt::address endAddr;
-            newStart = trim(buffer.data(), delimIP + 1, endOfIPRange);
-            if (!parseIPAddress(buffer.data() + newStart, endAddr))
+            if (parseResult != LineParseResult::Rule)
             {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. End IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
+                addError(parseResult);
                 continue;
             }
 
-            if ((startAddr.is_v4() != endAddr.is_v4())
-                || (startAddr.is_v6() != endAddr.is_v6()))
-                {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
-
-            start = endOfLine;
-
-            // Now Add to the filter
             try
             {
-                m_filter.add_rule(startAddr, endAddr, lt::ip_filter::blocked);
-                ++ruleCount;
+                result.filter.add_rule(first, last, lt::ip_filter::blocked);
+                ++result.ruleCount;
             }
             catch (const std::exception &e)
             {
-                ++parseErrorCount;
-                addLog(tr("IP filter exception thrown for line %1. Exception is: %2")
-                       .arg(nbLine).arg(QString::fromLocal8Bit(e.what())));
+                addError(LineParseResult::Exception, QString::fromLocal8Bit(e.what()));
             }
         }
 
-        if (start >= dataSize)
-            offset = 0;
+        return result;
     }
 
-    if (parseErrorCount > MAX_LOGGED_ERRORS)
-        LogMsg(tr("%1 extra IP filter parsing errors occurred.", "513 extra IP filter parsing errors occurred.")
-               .arg(parseErrorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
-    return ruleCount;
-}
+    void mergeFilter(lt::ip_filter &filter, const lt::ip_filter &other)
+    {
+        // exported filter covers the whole address space so allowed ranges are skipped
+        const auto [rangesV4, rangesV6] = other.export_filter();
+        for (const auto &range : rangesV4)
+        {
+            if (range.flags == lt::ip_filter::blocked)
+                filter.add_rule(range.first, range.last, lt::ip_filter::blocked);
+        }
+        for (const auto &range : rangesV6)
+        {
+            if (range.flags == lt::ip_filter::blocked)
+                filter.add_rule(range.first, range.last, lt::ip_filter::blocked);
+        }
+    }
 
-// Parser for PeerGuardian ip filter in p2p format
-int FilterParserThread::parseP2PFilterFile()
-{
-    int ruleCount = 0;
-    QFile file {m_filePath.data()};
-    if (!file.exists()) return ruleCount;
+    QString errorMessage(const ParseError &error, const qint64 line)
+    {
+        switch (error.type)
+        {
+        case LineParseResult::MalformedStartIP:
+            return FilterParserThread::tr("IP filter line %1 is malformed. Start IP of the range is malformed.").arg(line);
+        case LineParseResult::MalformedEndIP:
+            return FilterParserThread::tr("IP filter line %1 is malformed. End IP of the range is malformed.").arg(line);
+        case LineParseResult::IPVersionMismatch:
+            return FilterParserThread::tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!").arg(line);
+        case LineParseResult::Exception:
+            return FilterParserThread::tr("IP filter exception thrown for line %1. Exception is: %2").arg(line).arg(error.details);
+        default:
+            return FilterParserThread::tr("IP filter line %1 is malformed.").arg(line);
+        }
+    }
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    // Each filter file has its own cache so that changing one of the lists
+    // doesn't require the others to be parsed again
+    Path filterCachePath(const Path &filePath)
     {
-        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
-        return ruleCount;
+        const QByteArray pathHash = QCryptographicHash::hash(filePath.data().toUtf8(), QCryptographicHash::Md5);
+        return specialFolderLocation(SpecialFolder::Cache) / Path(FILTER_CACHE_DIRNAME)
+                / Path(QString::fromLatin1(pathHash.toHex()) + u".cache");
     }
 
-    std::vector<char> buffer(BUFFER_SIZE, 0); // seems a bit faster than QVector
-    qint64 bytesRead = 0;
-    int offset = 0;
-    int start = 0;
-    int endOfLine = -1;
-    int nbLine = 0;
-    int parseErrorCount = 0;
-    const auto addLog = [&parseErrorCount](const QString &msg)
-    {
-        if (parseErrorCount <= MAX_LOGGED_ERRORS)
-            LogMsg(msg, Log::CRITICAL);
+    struct FilterFileInfo
+    {
+        QString path;
+        qint64 size = -1;
+        qint64 lastModified = 0;
+        QByteArray hash;
     };
 
-    while (true)
+    // File contents hash isn't included since it is required only if the file looks changed
+    FilterFileInfo filterFileInfo(const Path &filePath)
+    {
+        const QFileInfo fileInfo {filePath.data()};
+        if (!fileInfo.isFile() || !fileInfo.isReadable())
+            return {};
+
+        return {filePath.data(), fileInfo.size(), fileInfo.lastModified().toMSecsSinceEpoch(), {}};
+    }
+
+    QByteArray filterFileHash(const Path &filePath)
     {
-        bytesRead = file.read(buffer.data() + offset, BUFFER_SIZE - offset - 1);
-        if (bytesRead < 0)
-            break;
-        const int dataSize = bytesRead + offset;
-        if ((bytesRead == 0) && (dataSize == 0))
-            break;
+        QFile file {filePath.data()};
+        if (!file.open(QIODevice::ReadOnly))
+            return {};
+
+        QCryptographicHash hash {QCryptographicHash::Md5};
+        if (!hash.addData(&file))
+            return {};
+
+        return hash.result();
+    }
+
+    // Cache contains merged blocked ranges of the filter
+    // along with the information about the file it was parsed from.
+    // Cache of the file that is modified but has the same contents
+    // (e.g. downloaded again) is still used but should be updated.
+    bool loadFilterCache(const Path &cachePath, FilterFileInfo &fileInfo, lt::ip_filter &filter, int &ruleCount, bool &isOutdated)
+    {
+        const auto readResult = Utils::IO::readFile(cachePath, -1);
+        if (!readResult)
+            return false;
 
-        for (start = 0; start < dataSize; ++start)
+        QDataStream stream {readResult.value()};
+        stream.setVersion(QDataStream::Qt_5_15);
+
+        QByteArray magic;
+        qint32 version = 0;
+        stream >> magic >> version;
+        if ((stream.status() != QDataStream::Ok) || (magic != FILTER_CACHE_MAGIC) || (version != FILTER_CACHE_VERSION))
+            return false;
+
+        FilterFileInfo cachedFileInfo;
+        qint32 cachedRuleCount = 0;
+        stream >> cachedFileInfo.path >> cachedFileInfo.size >> cachedFileInfo.lastModified >> cachedFileInfo.hash >> cachedRuleCount;
+        if ((stream.status() != QDataStream::Ok) || (cachedFileInfo.path != fileInfo.path))
+            return false;
+
+        isOutdated = ((cachedFileInfo.size != fileInfo.size) || (cachedFileInfo.lastModified != fileInfo.lastModified));
+        if (isOutdated)
         {
-            endOfLine = -1;
-            // The file might have ended without the last line having a newline
-            if (!((bytesRead == 0) && (dataSize > 0)))
-            {
-                for (int i = start; i < dataSize; ++i)
-                {
-                    if (buffer[i] == '\n')
-                    {
-                        endOfLine = i;
-                        // We need to NULL the newline in case the line has only an IP range.
-                        // In that case the parser won't work for the end IP, because it ends
-                        // with the newline and not with a number.
-                        buffer[i] = '\0';
-                        break;
-                    }
-                }
-            }
-            else
-            {
-                endOfLine = dataSize;
-                buffer[dataSize] = '\0';
-            }
+            fileInfo.hash = filterFileHash(Path(fileInfo.path));
+            if (fileInfo.hash.isEmpty() || (fileInfo.hash != cachedFileInfo.hash))
+                return false;
+        }
+        else
+        {
+            fileInfo.hash = cachedFileInfo.hash;
+        }
+
+        lt::ip_filter cachedFilter;
+
+        quint32 rangesCount = 0;
+        stream >> rangesCount;
+        for (quint32 i = 0; (i < rangesCount) && (stream.status() == QDataStream::Ok); ++i)
+        {
+            quint32 first = 0;
+            quint32 last = 0;
+            stream >> first >> last;
+            cachedFilter.add_rule(lt::address_v4(first), lt::address_v4(last), lt::ip_filter::blocked);
+        }
 
-            if (endOfLine == -1)
+        rangesCount = 0;
+        stream >> rangesCount;
+        for (quint32 i = 0; (i < rangesCount) && (stream.status() == QDataStream::Ok); ++i)
+        {
+            lt::address_v6::bytes_type first {};
+            lt::address_v6::bytes_type last {};
+            if ((stream.readRawData(reinterpret_cast<char *>(first.data()), first.size()) != static_cast<int>(first.size()))
+                || (stream.readRawData(reinterpret_cast<char *>(last.data()), last.size()) != static_cast<int>(last.size())))
             {
-                // read the next chunk from file
-                // but first move(copy) the leftover data to the front of the buffer
-                offset = dataSize - start;
-                memmove(buffer.data(), buffer.data() + start, offset);
-                break;
+                return false;
             }
 
-            ++nbLine;
+            cachedFilter.add_rule(lt::address_v6(first), lt::address_v6(last), lt::ip_filter::blocked);
+        }
 
-            if ((buffer[start] == '#')
-                || ((buffer[start] == '/') && ((start + 1 < dataSize) && (buffer[start + 1] == '/'))))
-                {
-                start = endOfLine;
-                continue;
-            }
+        if (stream.status() != QDataStream::Ok)
+            return false;
 
-            // Each line should follow this format:
-            // Some organization:1.0.0.0-1.255.255.255
-            // The "Some organization" part might contain a ':' char itself so we find the last occurrence
-            const int partsDelimiter = findAndNullDelimiter(buffer.data(), ':', start, endOfLine, true);
-            if (partsDelimiter == -1)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        filter = std::move(cachedFilter);
+        ruleCount = cachedRuleCount;
+        return true;
+    }
 
-            // IP Range should be split by a dash
-            const int delimIP = findAndNullDelimiter(buffer.data(), '-', partsDelimiter + 1, endOfLine);
-            if (delimIP == -1)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+    void storeFilterCache(const Path &cachePath, const FilterFileInfo &fileInfo, const lt::ip_filter &filter, const int ruleCount)
+    {
+        const auto isBlocked = [](const auto &range) { return (range.flags == lt::ip_filter::blocked); };
+        const auto [rangesV4, rangesV6] = filter.export_filter();
 
-            lt::address startAddr;
-            int newStart = trim(buffer.data(), partsDelimiter + 1, delimIP - 1);
-            if (!parseIPAddress(buffer.data() + newStart, startAddr))
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. Start IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
+        QByteArray data;
+        QDataStream stream {&data, QIODevice::WriteOnly};
+        stream.setVersion(QDataStream::Qt_5_15);
+
+        stream << FILTER_CACHE_MAGIC << FILTER_CACHE_VERSION;
+        stream << fileInfo.path << fileInfo.size << fileInfo.lastModified << fileInfo.hash << static_cast<qint32>(ruleCount);
+
+        stream << static_cast<quint32>(std::count_if(rangesV4.cbegin(), rangesV4.cend(), isBlocked));
+        for (const auto &range : rangesV4)
+        {
+            if (isBlocked(range))
+                stream << static_cast<quint32>(range.first.to_uint()) << static_cast<quint32>(range.last.to_uint());
+        }
+
+        stream << static_cast<quint32>(std::count_if(rangesV6.cbegin(), rangesV6.cend(), isBlocked));
+        for (const auto &range : rangesV6)
+        {
+            if (!isBlocked(range))
                 continue;
-            }
 
-            lt::address endAddr;
-            newStart = trim(buffer.data(), delimIP + 1, endOfLine);
-            if (!parseIPAddress(buffer.data() + newStart, endAddr))
+            const lt::address_v6::bytes_type first = range.first.to_bytes();
+            const lt::address_v6::bytes_type last = range.last.to_bytes();
+            stream.writeRawData(reinterpret_cast<const char *>(first.data()), first.size());
+            stream.writeRawData(reinterpret_cast<const char *>(last.data()), last.size());
+        }
+
+        Utils::Fs::mkpath(cachePath.parentPath());
+        const nonstd::expected<void, QString> saveResult = Utils::IO::saveToFile(cachePath, data);
+        if (!saveResult)
+            LogMsg(FilterParserThread::tr("Couldn't save IP filter cache. Error: %1").arg(saveResult.error()), Log::WARNING);
+    }
+
+    // The file is memory mapped and split into line-aligned chunks which are parsed in parallel.
+    // Partial filters are merged afterwards.
+    int parseTextFilterFile(const Path &filePath, const LineParser parseLine, lt::ip_filter &filter, const std::atomic_bool &abort)
+    {
+        QFile file {filePath.data()};
+        if (!file.exists())
+            return 0;
+
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            LogMsg(FilterParserThread::tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
+            return 0;
+        }
+
+        const qint64 fileSize = file.size();
+        if (fileSize <= 0)
+            return 0;
+
+        QByteArray fileData;
+        qint64 dataSize = fileSize;
+        const auto *data = reinterpret_cast<const char *>(file.map(0, fileSize));
+        if (!data)
+        {
+            // Mapping isn't supported by some file systems
+            fileData = file.readAll();
+            data = fileData.constData();
+            dataSize = fileData.size();
+        }
+
+        const int threadsCount = std::max(1, QThread::idealThreadCount());
+        const qint64 chunkSize = std::max(MIN_CHUNK_SIZE, ((dataSize + threadsCount - 1) / threadsCount));
+        std::vector<std::string_view> chunks;
+        for (qint64 chunkBegin = 0; chunkBegin < dataSize;)
+        {
+            qint64 chunkEnd = std::min((chunkBegin + chunkSize), dataSize);
+            if (chunkEnd < dataSize)
             {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. End IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
+                const auto *lineEnd = static_cast<const char *>(std::memchr((data + chunkEnd), '\n', (dataSize - chunkEnd)));
+                chunkEnd = (lineEnd ? ((lineEnd - data) + 1) : dataSize);
             }
 
-            if ((startAddr.is_v4() != endAddr.is_v4())
-                || (startAddr.is_v6() != endAddr.is_v6()))
+            chunks.emplace_back((data + chunkBegin), static_cast<std::string_view::size_type>(chunkEnd - chunkBegin));
+            chunkBegin = chunkEnd;
+        }
+
+        std::vector<ChunkParseResult> results(chunks.size());
+        if (chunks.size() == 1)
+        {
+            results[0] = parseChunk(chunks[0], parseLine, abort);
+        }
+        else
+        {
+            QThreadPool threadPool;
+            threadPool.setMaxThreadCount(threadsCount);
+            for (std::size_t i = 0; i < chunks.size(); ++i)
+            {
+                threadPool.start([&results, &chunks, i, parseLine, &abort]
                 {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!").arg(nbLine));
-                start = endOfLine;
-                continue;
+                    results[i] = parseChunk(chunks[i], parseLine, abort);
+                });
             }
+            threadPool.waitForDone();
+        }
 
-            start = endOfLine;
+        if (abort)
+            return 0;
 
-            try
-            {
-                m_filter.add_rule(startAddr, endAddr, lt::ip_filter::blocked);
-                ++ruleCount;
-            }
-            catch (const std::exception &e)
+        int ruleCount = 0;
+        int parseErrorCount = 0;
+        int loggedErrorCount = 0;
+        qint64 lineOffset = 0;
+        for (ChunkParseResult &result : results)
+        {
+            // Errors are logged in the order of lines they occur at
+            for (const ParseError &error : asConst(result.errors))
             {
-                ++parseErrorCount;
-                addLog(tr("IP filter exception thrown for line %1. Exception is: %2")
-                       .arg(nbLine).arg(QString::fromLocal8Bit(e.what())));
+                if (loggedErrorCount >= MAX_LOGGED_ERRORS)
+                    break;
+
+                LogMsg(errorMessage(error, (lineOffset + error.line)), Log::CRITICAL);
+                ++loggedErrorCount;
             }
+
+            parseErrorCount += result.errorCount;
+            lineOffset += result.linesCount;
+            ruleCount += result.ruleCount;
+            if (&result == &results.front())
+                filter = std::move(result.filter);
+            else
+                mergeFilter(filter, result.filter);
         }
 
-        if (start >= dataSize)
-            offset = 0;
+        if (parseErrorCount > MAX_LOGGED_ERRORS)
+        {
+            LogMsg(FilterParserThread::tr("%1 extra IP filter parsing errors occurred.", "513 extra IP filter parsing errors occurred.")
+                   .arg(parseErrorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
+        }
+
+        return ruleCount;
     }
+}
 
-    if (parseErrorCount > MAX_LOGGED_ERRORS)
-        LogMsg(tr("%1 extra IP filter parsing errors occurred.", "513 extra IP filter parsing errors occurred.")
-               .arg(parseErrorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
-    return ruleCount;
+FilterParserThread::FilterParserThread(QObject *parent)
+    : QThread(parent)
+{
+}
+
+FilterParserThread::~FilterParserThread()
+{
+    m_abort = true;
+    wait();
+}
+
+int FilterParserThread::parseFilterFile(const Path &filePath, lt::ip_filter &filter)
+{
+    if (filePath.hasExtension(u".p2p"_s))
+    {
+        // PeerGuardian p2p file
+        return parseP2PFilterFile(filePath, filter);
+    }
+
+    if (filePath.hasExtension(u".p2b"_s))
+    {
+        // PeerGuardian p2b file
+        return parseP2BFilterFile(filePath, filter);
+    }
+
+    if (filePath.hasExtension(u".dat"_s))
+    {
+        // eMule DAT format
+        return parseDATFilterFile(filePath, filter);
+    }
+
+    return 0;
+}
+
+int FilterParserThread::parseDATFilterFile(const Path &filePath, lt::ip_filter &filter)
+{
+    return parseTextFilterFile(filePath, parseDATLine, filter, m_abort);
+}
+
+int FilterParserThread::parseP2PFilterFile(const Path &filePath, lt::ip_filter &filter)
+{
+    return parseTextFilterFile(filePath, parseP2PLine, filter, m_abort);
 }
 
 int FilterParserThread::getlineInStream(QDataStream &stream, std::string &name, const char delim)
@@ -466,10 +628,10 @@ int FilterParserThread::getlineInStream(QDataStream &stream, std::string &name,
 }
 
 // Parser for PeerGuardian ip filter in p2p format
-int FilterParserThread::parseP2BFilterFile()
+int FilterParserThread::parseP2BFilterFile(const Path &filePath, lt::ip_filter &filter)
 {
     int ruleCount = 0;
-    QFile file {m_filePath.data()};
+    QFile file {filePath.data()};
     if (!file.exists()) return ruleCount;
 
     if (!file.open(QIODevice::ReadOnly))
@@ -513,7 +675,7 @@ int FilterParserThread::parseP2BFilterFile()
             // Apply to bittorrent session
             try
             {
-                m_filter.add_rule(first, last, lt::ip_filter::blocked);
+                filter.add_rule(first, last, lt::ip_filter::blocked);
                 ++ruleCount;
             }
             catch (const std::exception &) {}
@@ -571,7 +733,7 @@ int FilterParserThread::parseP2BFilterFile()
             // Apply to bittorrent session
             try
             {
-                m_filter.add_rule(first, last, lt::ip_filter::blocked);
+                filter.add_rule(first, last, lt::ip_filter::blocked);
                 ++ruleCount;
             }
             catch (const std::exception &) {}
@@ -593,6 +755,13 @@ int FilterParserThread::parseP2BFilterFile()
 //  * PeerGuardian Text (P2P): http://wiki.phoenixlabs.org/wiki/P2P_Format
 //  * PeerGuardian Binary (P2B): http://wiki.phoenixlabs.org/wiki/P2B_Format
 void FilterParserThread::processFilterFile(const Path &filePath)
+{
+    processFilterFiles({filePath});
+}
+
+// Process several ip filter files, the resulting filter blocks
+// the ranges of all of them
+void FilterParserThread::processFilterFiles(const PathList &filePaths)
 {
     if (isRunning())
     {
@@ -602,7 +771,7 @@ void FilterParserThread::processFilterFile(const Path &filePath)
     }
 
     m_abort = false;
-    m_filePath = filePath;
+    m_filePaths = filePaths;
     m_filter = lt::ip_filter();
     // Run it
     start();
@@ -615,91 +784,71 @@ lt::ip_filter FilterParserThread::IPfilter()
 
 void FilterParserThread::run()
 {
-    qDebug("Processing filter file");
-    int ruleCount = 0;
-    if (m_filePath.hasExtension(u".p2p"_s))
-    {
-        // PeerGuardian p2p file
-        ruleCount = parseP2PFilterFile();
-    }
-    else if (m_filePath.hasExtension(u".p2b"_s))
-    {
-        // PeerGuardian p2b file
-        ruleCount = parseP2BFilterFile();
-    }
-    else if (m_filePath.hasExtension(u".dat"_s))
-    {
-        // eMule DAT format
-        ruleCount = parseDATFilterFile();
-    }
-
-    if (m_abort) return;
-
-    try
-    {
-        emit IPFilterParsed(ruleCount);
-    }
-    catch (const std::exception &)
-    {
-        emit IPFilterError();
-    }
+    qDebug("Processing filter files");
 
-    qDebug("IP Filter thread: finished parsing, filter applied");
-}
-
-int FilterParserThread::findAndNullDelimiter(char *const data, const char delimiter, const int start, const int end, const bool reverse)
-{
-    if (!reverse)
+    int totalRuleCount = 0;
+    bool isFirstFilter = true;
+    for (const Path &filePath : asConst(m_filePaths))
     {
-        for (int i = start; i <= end; ++i)
+        QElapsedTimer loadingTimer;
+        loadingTimer.start();
+
+        // Parsed filter is cached so the file isn't parsed again until it is changed
+        const Path cachePath = filterCachePath(filePath);
+        FilterFileInfo fileInfo = filterFileInfo(filePath);
+
+        lt::ip_filter filter;
+        int ruleCount = 0;
+        bool isCacheOutdated = false;
+        const bool isCached = ((fileInfo.size >= 0) && loadFilterCache(cachePath, fileInfo, filter, ruleCount, isCacheOutdated));
+        if (!isCached)
         {
-            if (data[i] == delimiter)
+            ruleCount = parseFilterFile(filePath, filter);
+            if (m_abort) return;
+
+            // Broken files aren't cached so that their errors are reported each time
+            if ((fileInfo.size >= 0) && (ruleCount > 0))
             {
-                data[i] = '\0';
-                return i;
+                if (fileInfo.hash.isEmpty())
+                    fileInfo.hash = filterFileHash(filePath);
+                if (!fileInfo.hash.isEmpty())
+                    storeFilterCache(cachePath, fileInfo, filter, ruleCount);
             }
         }
-    }
-    else
-    {
-        for (int i = end; i >= start; --i)
+        else if (isCacheOutdated)
         {
-            if (data[i] == delimiter)
-            {
-                data[i] = '\0';
-                return i;
-            }
+            storeFilterCache(cachePath, fileInfo, filter, ruleCount);
         }
-    }
 
-    return -1;
-}
+        if (m_abort) return;
 
-int FilterParserThread::trim(char *const data, const int start, const int end)
-{
-    if (start >= end) return start;
-    int newStart = start;
+        LogMsg((isCached
+                ? tr("IP filter list loaded from cache. List: \"%1\". Rules: %2. Elapsed time: %3 ms")
+                : tr("IP filter list parsed. List: \"%1\". Rules: %2. Elapsed time: %3 ms"))
+               .arg(filePath.toString(), QString::number(ruleCount), QString::number(loadingTimer.elapsed())));
 
-    for (int i = start; i <= end; ++i)
-    {
-        if (isspace(data[i]) != 0)
+        totalRuleCount += ruleCount;
+        if (isFirstFilter)
         {
-            data[i] = '\0';
+            m_filter = std::move(filter);
+            isFirstFilter = false;
         }
         else
         {
-            newStart = i;
-            break;
+            mergeFilter(m_filter, filter);
         }
     }
 
-    for (int i = end; i >= start; --i)
+    if (m_abort) return;
+
+    try
     {
-        if (isspace(data[i]) != 0)
-            data[i] = '\0';
-        else
-            break;
+        emit IPFilterParsed(totalRuleCount);
+    }
+    catch (const std::exception &)
+    {
+        emit IPFilterError();
     }
 
-    return newStart;
+    qDebug("IP Filter thread: finished parsing, filter applied");
 }
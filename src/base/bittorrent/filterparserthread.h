@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <libtorrent/ip_filter.hpp>
 
 #include <QThread>
@@ -45,6 +47,7 @@ public:
     FilterParserThread(QObject *parent = nullptr);
     ~FilterParserThread();
     void processFilterFile(const Path &filePath);
+    void processFilterFiles(const PathList &filePaths);
     lt::ip_filter IPfilter();
 
 signals:
@@ -55,14 +58,13 @@ protected:
     void run() override;
 
 private:
-    int findAndNullDelimiter(char *data, char delimiter, int start, int end, bool reverse = false);
-    int trim(char *data, int start, int end);
-    int parseDATFilterFile();
-    int parseP2PFilterFile();
+    int parseFilterFile(const Path &filePath, lt::ip_filter &filter);
+    int parseDATFilterFile(const Path &filePath, lt::ip_filter &filter);
+    int parseP2PFilterFile(const Path &filePath, lt::ip_filter &filter);
     int getlineInStream(QDataStream &stream, std::string &name, char delim);
-    int parseP2BFilterFile();
+    int parseP2BFilterFile(const Path &filePath, lt::ip_filter &filter);
 
-    bool m_abort = false;
-    Path m_filePath;
+    std::atomic_bool m_abort {false};
+    PathList m_filePaths;
     lt::ip_filter m_filter;
 };
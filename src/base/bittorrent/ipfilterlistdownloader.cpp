@@ -0,0 +1,288 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "ipfilterlistdownloader.h"
+
+#include <utility>
+
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrl>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/net/downloadmanager.h"
+#include "base/preferences.h"
+#include "base/utils/fs.h"
+#include "base/utils/gzip.h"
+#include "base/utils/io.h"
+
+namespace
+{
+    const QString LISTS_INFO_FILENAME = u"lists.json"_s;
+    const int LISTS_INFO_MAX_SIZE = 1024 * 1024;
+    const qint64 LIST_MAX_SIZE = 256 * 1024 * 1024;
+
+    const QString KEY_FILENAME = u"file_name"_s;
+    const QString KEY_ETAG = u"etag"_s;
+    const QString KEY_LASTMODIFIED = u"last_modified"_s;
+
+    bool hasFilterExtension(const QString &fileName)
+    {
+        return fileName.endsWith(u".dat", Qt::CaseInsensitive)
+                || fileName.endsWith(u".p2p", Qt::CaseInsensitive)
+                || fileName.endsWith(u".p2b", Qt::CaseInsensitive);
+    }
+
+    // Filter file format is detected by its extension so the downloaded list
+    // must have the proper one even if the URL doesn't tell it
+    QString detectFilterExtension(const QString &url, const QByteArray &data)
+    {
+        QString fileName = QUrl(url).fileName();
+        if (fileName.endsWith(u".gz", Qt::CaseInsensitive))
+            fileName.chop(3);
+        if (hasFilterExtension(fileName))
+            return fileName.right(4).toLower();
+
+        if (data.startsWith("\xFF\xFF\xFF\xFFP2B"))
+            return u".p2b"_s;
+
+        // eMule DAT format uses commas to separate fields, PeerGuardian P2P format doesn't
+        for (qsizetype lineBegin = 0; lineBegin < data.size();)
+        {
+            qsizetype lineEnd = data.indexOf('\n', lineBegin);
+            if (lineEnd < 0)
+                lineEnd = data.size();
+
+            const QByteArray line = data.mid(lineBegin, (lineEnd - lineBegin)).trimmed();
+            if (!line.isEmpty() && !line.startsWith('#') && !line.startsWith("//"))
+                return line.contains(',') ? u".dat"_s : u".p2p"_s;
+
+            lineBegin = lineEnd + 1;
+        }
+
+        return u".p2p"_s;
+    }
+}
+
+BitTorrent::IPFilterListDownloader::IPFilterListDownloader(const Path &dirPath, QObject *parent)
+    : QObject(parent)
+    , m_dirPath {dirPath}
+{
+    if (!Utils::Fs::mkpath(m_dirPath))
+    {
+        LogMsg(tr("Couldn't create IP filter lists directory. Path: \"%1\"").arg(m_dirPath.toString()), Log::WARNING);
+    }
+
+    loadListsInfo();
+}
+
+Path BitTorrent::IPFilterListDownloader::listPath(const QString &url) const
+{
+    const auto listIter = m_lists.constFind(url);
+    if (listIter == m_lists.cend())
+        return {};
+
+    return m_dirPath / listIter->fileName;
+}
+
+bool BitTorrent::IPFilterListDownloader::isUpdating() const
+{
+    return !m_pendingURLs.isEmpty();
+}
+
+void BitTorrent::IPFilterListDownloader::update(const QStringList &urls)
+{
+    if (isUpdating())
+    {
+        // Lists will be updated again once the current update is finished
+        m_queuedURLs = urls;
+        m_hasQueuedUpdate = true;
+        return;
+    }
+
+    // Remove the lists that are no longer used
+    for (auto listIter = m_lists.begin(); listIter != m_lists.end();)
+    {
+        if (urls.contains(listIter.key()))
+        {
+            ++listIter;
+            continue;
+        }
+
+        Utils::Fs::removeFile(m_dirPath / listIter->fileName);
+        listIter = m_lists.erase(listIter);
+        m_isChanged = true;
+    }
+
+    for (const QString &url : urls)
+    {
+        if (m_pendingURLs.contains(url))
+            continue;
+
+        auto request = Net::DownloadRequest(url).limit(LIST_MAX_SIZE).priority(Net::DownloadPriority::Low);
+
+        const auto listIter = m_lists.constFind(url);
+        if ((listIter != m_lists.cend()) && (m_dirPath / listIter->fileName).exists())
+            request.ifNoneMatch(listIter->eTag).ifModifiedSince(listIter->lastModified);
+
+        m_pendingURLs.insert(url);
+        Net::DownloadManager::instance()->download(request, Preferences::instance()->useProxyForGeneralPurposes()
+                , this, &IPFilterListDownloader::handleDownloadFinished);
+    }
+
+    if (!isUpdating())
+        finishUpdate();
+}
+
+void BitTorrent::IPFilterListDownloader::handleDownloadFinished(const Net::DownloadResult &result)
+{
+    if (!m_pendingURLs.remove(result.url))
+        return;
+
+    if (result.status != Net::DownloadStatus::Success)
+    {
+        LogMsg(tr("Failed to download IP filter list. URL: \"%1\". Reason: \"%2\"")
+            .arg(result.url, result.errorString), Log::WARNING);
+    }
+    else if (result.notModified)
+    {
+        qDebug("IP filter list isn't modified: %s", qUtf8Printable(result.url));
+    }
+    else
+    {
+        bool isDecompressed = true;
+        const QByteArray data = Utils::Gzip::isCompressed(result.data)
+                ? Utils::Gzip::decompress(result.data, &isDecompressed)
+                : result.data;
+        if (!isDecompressed)
+        {
+            LogMsg(tr("Failed to decompress IP filter list. URL: \"%1\"").arg(result.url), Log::WARNING);
+        }
+        else
+        {
+            const QByteArray urlHash = QCryptographicHash::hash(result.url.toUtf8(), QCryptographicHash::Md5);
+            const Path fileName {QString::fromLatin1(urlHash.toHex()) + detectFilterExtension(result.url, data)};
+
+            const nonstd::expected<void, QString> saveResult = Utils::IO::saveToFile((m_dirPath / fileName), data);
+            if (!saveResult)
+            {
+                LogMsg(tr("Failed to save IP filter list. URL: \"%1\". Reason: \"%2\"")
+                    .arg(result.url, saveResult.error()), Log::WARNING);
+            }
+            else
+            {
+                ListInfo &listInfo = m_lists[result.url];
+                if (!listInfo.fileName.isEmpty() && (listInfo.fileName != fileName))
+                    Utils::Fs::removeFile(m_dirPath / listInfo.fileName);
+
+                listInfo = {fileName, result.eTag, result.lastModified};
+                m_isChanged = true;
+
+                LogMsg(tr("IP filter list is downloaded. URL: \"%1\"").arg(result.url));
+            }
+        }
+    }
+
+    if (!isUpdating())
+        finishUpdate();
+}
+
+void BitTorrent::IPFilterListDownloader::finishUpdate()
+{
+    const bool isChanged = m_isChanged;
+    if (isChanged)
+        storeListsInfo();
+    m_isChanged = false;
+
+    emit updateFinished(isChanged);
+
+    if (m_hasQueuedUpdate)
+    {
+        m_hasQueuedUpdate = false;
+        update(std::exchange(m_queuedURLs, {}));
+    }
+}
+
+void BitTorrent::IPFilterListDownloader::loadListsInfo()
+{
+    const Path path = m_dirPath / Path(LISTS_INFO_FILENAME);
+    const auto readResult = Utils::IO::readFile(path, LISTS_INFO_MAX_SIZE);
+    if (!readResult)
+    {
+        if (readResult.error().status != Utils::IO::ReadError::NotExist)
+        {
+            LogMsg(tr("Failed to read IP filter lists info. %1").arg(readResult.error().message), Log::WARNING);
+        }
+
+        return;
+    }
+
+    QJsonParseError jsonError;
+    const QJsonDocument jsonDoc = QJsonDocument::fromJson(readResult.value(), &jsonError);
+    if ((jsonError.error != QJsonParseError::NoError) || !jsonDoc.isObject())
+    {
+        LogMsg(tr("Failed to parse IP filter lists info. File: \"%1\"").arg(path.toString()), Log::WARNING);
+        return;
+    }
+
+    const QJsonObject jsonObj = jsonDoc.object();
+    for (auto it = jsonObj.constBegin(); it != jsonObj.constEnd(); ++it)
+    {
+        const QJsonObject listObj = it.value().toObject();
+
+        ListInfo listInfo;
+        listInfo.fileName = Path(listObj.value(KEY_FILENAME).toString());
+        listInfo.eTag = listObj.value(KEY_ETAG).toString();
+        listInfo.lastModified = QDateTime::fromString(listObj.value(KEY_LASTMODIFIED).toString(), Qt::ISODate);
+        if (listInfo.fileName.isValid() && hasFilterExtension(listInfo.fileName.data()))
+            m_lists.insert(it.key(), listInfo);
+    }
+}
+
+void BitTorrent::IPFilterListDownloader::storeListsInfo() const
+{
+    QJsonObject jsonObj;
+    for (auto it = m_lists.cbegin(); it != m_lists.cend(); ++it)
+    {
+        jsonObj[it.key()] = QJsonObject {
+            {KEY_FILENAME, it->fileName.data()},
+            {KEY_ETAG, it->eTag},
+            {KEY_LASTMODIFIED, it->lastModified.toString(Qt::ISODate)}
+        };
+    }
+
+    const Path path = m_dirPath / Path(LISTS_INFO_FILENAME);
+    const nonstd::expected<void, QString> saveResult = Utils::IO::saveToFile(path, QJsonDocument(jsonObj).toJson());
+    if (!saveResult)
+    {
+        LogMsg(tr("Failed to save IP filter lists info. File: \"%1\". Error: \"%2\"")
+            .arg(path.toString(), saveResult.error()), Log::WARNING);
+    }
+}
@@ -63,6 +63,8 @@ namespace BitTorrent
         virtual void store(const TorrentID &id, const LoadTorrentParams &resumeData) const = 0;
         virtual void remove(const TorrentID &id) const = 0;
         virtual void storeQueue(const QVector<TorrentID> &queue) const = 0;
+        // Blocks until all the changes requested so far are actually written
+        virtual void flush() const = 0;
 
         void loadAll() const;
         QList<LoadedResumeData> fetchLoadedResumeData() const;
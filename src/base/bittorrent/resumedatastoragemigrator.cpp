@@ -0,0 +1,149 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "resumedatastoragemigrator.h"
+
+#include <algorithm>
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "loadtorrentparams.h"
+#include "resumedatastorage.h"
+
+namespace
+{
+    // Migration is throttled so that it doesn't affect regular work of the session
+    const int MIGRATION_CHUNK_SIZE = 50;
+    const int MIGRATION_CHUNK_INTERVAL = 100; // ms
+}
+
+BitTorrent::ResumeDataStorageMigrator::ResumeDataStorageMigrator(const ResumeDataStorage *sourceStorage
+        , const ResumeDataStorage *targetStorage, const QVector<TorrentID> &torrents, QObject *parent)
+    : QObject(parent)
+    , m_sourceStorage {sourceStorage}
+    , m_targetStorage {targetStorage}
+    , m_torrents {torrents}
+{
+}
+
+BitTorrent::ResumeDataStorageMigrator::~ResumeDataStorageMigrator()
+{
+    if (m_thread)
+        m_thread->requestInterruption();
+}
+
+void BitTorrent::ResumeDataStorageMigrator::start()
+{
+    Q_ASSERT(!m_thread);
+
+    // Target storage shouldn't contain anything that is missing in source one
+    const QSet<TorrentID> torrents {m_torrents.cbegin(), m_torrents.cend()};
+    for (const TorrentID &id : asConst(m_targetStorage->registeredTorrents()))
+    {
+        if (!torrents.contains(id))
+            m_targetStorage->remove(id);
+    }
+
+    m_thread.reset(QThread::create([this]()
+    {
+        migrate();
+    }));
+    // Interrupted migration isn't reported as finished
+    connect(m_thread.get(), &QThread::finished, this, [this]()
+    {
+        if (m_processedCount >= m_torrents.size())
+            emit finished();
+    });
+    m_thread->start(QThread::LowPriority);
+}
+
+int BitTorrent::ResumeDataStorageMigrator::progress() const
+{
+    if (m_torrents.isEmpty())
+        return 100;
+
+    return static_cast<int>((m_processedCount * 100) / m_torrents.size());
+}
+
+void BitTorrent::ResumeDataStorageMigrator::store(const TorrentID &id, const LoadTorrentParams &resumeData)
+{
+    const QMutexLocker locker {&m_updatedTorrentsMutex};
+    m_targetStorage->store(id, resumeData);
+    m_updatedTorrents.insert(id);
+}
+
+void BitTorrent::ResumeDataStorageMigrator::remove(const TorrentID &id)
+{
+    const QMutexLocker locker {&m_updatedTorrentsMutex};
+    m_targetStorage->remove(id);
+    m_updatedTorrents.insert(id);
+}
+
+void BitTorrent::ResumeDataStorageMigrator::migrate()
+{
+    // Changes requested before migration started are passed to source storage only
+    // so they should be actually written to be loaded from there
+    m_sourceStorage->flush();
+
+    QThread *thread = QThread::currentThread();
+    while (!thread->isInterruptionRequested() && (m_processedCount < m_torrents.size()))
+    {
+        const qsizetype chunkEnd = std::min<qsizetype>((m_processedCount + MIGRATION_CHUNK_SIZE), m_torrents.size());
+        for (qsizetype i = m_processedCount; i < chunkEnd; ++i)
+        {
+            const TorrentID &id = m_torrents.at(i);
+            {
+                const QMutexLocker locker {&m_updatedTorrentsMutex};
+                if (m_updatedTorrents.contains(id))
+                    continue;
+            }
+
+            const LoadResumeDataResult loadResult = m_sourceStorage->load(id);
+            if (!loadResult)
+            {
+                LogMsg(tr("Failed to migrate resume data. Torrent: \"%1\". Reason: \"%2\"")
+                       .arg(id.toString(), loadResult.error()), Log::WARNING);
+                continue;
+            }
+
+            // Resume data might be changed while it was being loaded
+            const QMutexLocker locker {&m_updatedTorrentsMutex};
+            if (!m_updatedTorrents.contains(id))
+                m_targetStorage->store(id, loadResult.value());
+        }
+
+        m_processedCount = chunkEnd;
+        emit progressUpdated(progress());
+
+        if (m_processedCount < m_torrents.size())
+            QThread::msleep(MIGRATION_CHUNK_INTERVAL);
+    }
+}
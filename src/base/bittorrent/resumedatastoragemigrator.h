@@ -0,0 +1,82 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QVector>
+
+#include "base/utils/thread.h"
+#include "infohash.h"
+
+namespace BitTorrent
+{
+    class ResumeDataStorage;
+    struct LoadTorrentParams;
+
+    // Copies resume data of the given torrents from one storage to another in background thread.
+    // Source storage remains in use during migration, so all the changes made to it
+    // should be passed to the migrator as well to keep target storage up to date.
+    class ResumeDataStorageMigrator final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY_MOVE(ResumeDataStorageMigrator)
+
+    public:
+        ResumeDataStorageMigrator(const ResumeDataStorage *sourceStorage, const ResumeDataStorage *targetStorage
+                , const QVector<TorrentID> &torrents, QObject *parent = nullptr);
+        ~ResumeDataStorageMigrator() override;
+
+        void start();
+        int progress() const;
+
+        void store(const TorrentID &id, const LoadTorrentParams &resumeData);
+        void remove(const TorrentID &id);
+
+    signals:
+        void progressUpdated(int progress);
+        void finished();
+
+    private:
+        void migrate();
+
+        const ResumeDataStorage *m_sourceStorage = nullptr;
+        const ResumeDataStorage *m_targetStorage = nullptr;
+        const QVector<TorrentID> m_torrents;
+        std::atomic<qsizetype> m_processedCount = 0;
+        // Torrents which resume data has been changed since migration started
+        // are already actual in target storage
+        QSet<TorrentID> m_updatedTorrents;
+        QMutex m_updatedTorrentsMutex;
+        Utils::Thread::UniquePtr m_thread;
+    };
+}
@@ -310,6 +310,10 @@ namespace BitTorrent
         virtual void setIPFilteringEnabled(bool enabled) = 0;
         virtual Path IPFilterFile() const = 0;
         virtual void setIPFilterFile(const Path &path) = 0;
+        virtual QStringList IPFilterSources() const = 0;
+        virtual void setIPFilterSources(const QStringList &sources) = 0;
+        virtual int IPFilterRefreshInterval() const = 0;
+        virtual void setIPFilterRefreshInterval(int hours) = 0;
         virtual bool announceToAllTrackers() const = 0;
         virtual void setAnnounceToAllTrackers(bool val) = 0;
         virtual bool announceToAllTiers() const = 0;
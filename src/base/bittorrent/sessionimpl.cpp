@@ -35,6 +35,7 @@
 #include <ctime>
 #include <queue>
 #include <string>
+#include <utility>
 
 #ifdef Q_OS_WIN
 #include <Windows.h>
@@ -58,8 +59,10 @@
 #include <libtorrent/session_status.hpp>
 #include <libtorrent/torrent_info.hpp>
 
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
+#include <QFileInfo>
 #include <QHostAddress>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -93,6 +96,7 @@
 #include "base/utils/misc.h"
 #include "base/utils/net.h"
 #include "base/utils/random.h"
+#include "base/utils/string.h"
 #include "base/version.h"
 #include "bandwidthscheduler.h"
 #include "bencoderesumedatastorage.h"
@@ -102,6 +106,7 @@
 #include "extensiondata.h"
 #include "filesearcher.h"
 #include "filterparserthread.h"
+#include "ipfilterlistdownloader.h"
 #include "loadtorrentparams.h"
 #include "lttypecast.h"
 #include "magneturi.h"
@@ -110,6 +115,7 @@
 #include "peer_filter_session_plugin.hpp"
 #include "portforwarderimpl.h"
 #include "resumedatastorage.h"
+#include "resumedatastoragemigrator.h"
 #include "torrentimpl.h"
 #include "tracker.h"
 
@@ -118,7 +124,9 @@ using namespace BitTorrent;
 
 const Path CATEGORIES_FILE_NAME {u"categories.json"_s};
 const int MAX_PROCESSING_RESUMEDATA_COUNT = 50;
+const QString MIGRATION_DB_FILENAME = u"torrents.db.migrating"_s;
 const int STATISTICS_SAVE_INTERVAL = std::chrono::milliseconds(15min).count();
+const int METADATA_STATISTICS_UPDATE_INTERVAL = std::chrono::milliseconds(10s).count();
 
 #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
 namespace std
@@ -143,6 +151,27 @@ namespace
     const char PEER_ID[] = "qB";
     const auto USER_AGENT = QStringLiteral("qBittorrent/" QBT_VERSION_2);
 
+    void removeDatabaseFiles(const Path &dbPath)
+    {
+        Utils::Fs::removeFile(dbPath);
+        Utils::Fs::removeFile(dbPath + u"-wal");
+        Utils::Fs::removeFile(dbPath + u"-shm");
+    }
+
+    // Files are considered unchanged while their size and modification time are the same
+    QStringList filesState(const PathList &filePaths)
+    {
+        QStringList state;
+        state.reserve(filePaths.size());
+        for (const Path &filePath : filePaths)
+        {
+            const QFileInfo fileInfo {filePath.data()};
+            state.append(u"%1|%2|%3"_s.arg(filePath.data(), QString::number(fileInfo.size())
+                    , QString::number(fileInfo.lastModified().toMSecsSinceEpoch())));
+        }
+        return state;
+    }
+
     void torrentQueuePositionUp(const lt::torrent_handle &handle)
     {
         try
@@ -413,6 +442,8 @@ SessionImpl::SessionImpl(QObject *parent)
     , m_isIPFilteringEnabled(BITTORRENT_SESSION_KEY(u"IPFilteringEnabled"_s), false)
     , m_isTrackerFilteringEnabled(BITTORRENT_SESSION_KEY(u"TrackerFilteringEnabled"_s), false)
     , m_IPFilterFile(BITTORRENT_SESSION_KEY(u"IPFilter"_s))
+    , m_IPFilterSources(BITTORRENT_SESSION_KEY(u"IPFilterSources"_s))
+    , m_IPFilterRefreshInterval(BITTORRENT_SESSION_KEY(u"IPFilterRefreshInterval"_s), 24, clampValue(1, 168))
     , m_announceToAllTrackers(BITTORRENT_SESSION_KEY(u"AnnounceToAllTrackers"_s), false)
     , m_announceToAllTiers(BITTORRENT_SESSION_KEY(u"AnnounceToAllTiers"_s), true)
     , m_asyncIOThreads(BITTORRENT_SESSION_KEY(u"AsyncIOThreadsCount"_s), 10)
@@ -634,6 +665,10 @@ SessionImpl::~SessionImpl()
         m_needSaveTorrentsQueue = true;
     }
 
+    // Unfinished migration will be started over next time
+    if (m_resumeDataStorageMigrator)
+        cancelResumeDataStorageMigration();
+
     // Do some bittorrent related saving
     // After this, (ideally) no more important alerts will be generated/handled
     saveResumeData();
@@ -783,16 +818,23 @@ void SessionImpl::setPublicTrackers(const QString &trackers)
 void SessionImpl::updatePublicTracker()
 {
     Preferences *const pref = Preferences::instance();
-    Net::DownloadManager::instance()->download(Net::DownloadRequest(pref->customizeTrackersListUrl()).userAgent(QStringLiteral("qBittorrent Enhanced/" QBT_VERSION_2)), Preferences::instance()->useProxyForGeneralPurposes(), this, &SessionImpl::handlePublicTrackerTxtDownloadFinished);
+    Net::DownloadManager::instance()->download(Net::DownloadRequest(pref->customizeTrackersListUrl()).userAgent(QStringLiteral("qBittorrent Enhanced/" QBT_VERSION_2)).priority(Net::DownloadPriority::Low).useCache(true), Preferences::instance()->useProxyForGeneralPurposes(), this, &SessionImpl::handlePublicTrackerTxtDownloadFinished);
 }
 
 void SessionImpl::handlePublicTrackerTxtDownloadFinished(const Net::DownloadResult &result)
 {
     switch (result.status) {
-        case Net::DownloadStatus::Success:
+        case Net::DownloadStatus::Success: {
+            // The list is the same as the one that was applied last time
+            const QByteArray hash = QCryptographicHash::hash(result.data, QCryptographicHash::Sha1);
+            if ((result.url == m_publicTrackersURL) && (hash == m_publicTrackersHash))
+                break;
             setPublicTrackers(QString::fromUtf8(result.data.data()));
+            m_publicTrackersURL = result.url;
+            m_publicTrackersHash = hash;
             LogMsg(tr("The public tracker list updated."), Log::INFO);
             break;
+        }
         default:
             LogMsg(tr("Updating the public tracker list failed: %1").arg(result.errorString, Log::WARNING));
     }
@@ -2538,6 +2580,8 @@ bool SessionImpl::deleteTorrent(const TorrentID &id, const DeleteOption deleteOp
 
     // Remove it from torrent resume directory
     m_resumeDataStorage->remove(torrent->id());
+    if (m_resumeDataStorageMigrator)
+        m_resumeDataStorageMigrator->remove(torrent->id());
 
     delete torrent;
     return true;
@@ -2741,7 +2785,7 @@ bool SessionImpl::addTorrent(const QString &source, const AddTorrentParams &para
         const auto *pref = Preferences::instance();
         // Launch downloader
         Net::DownloadManager::instance()->download(Net::DownloadRequest(source).limit(pref->getTorrentFileSizeLimit())
-                , pref->useProxyForGeneralPurposes(), this, &SessionImpl::handleDownloadFinished);
+                .priority(Net::DownloadPriority::High), pref->useProxyForGeneralPurposes(), this, &SessionImpl::handleDownloadFinished);
         m_downloadedTorrents[source] = params;
         return true;
     }
@@ -3281,6 +3325,20 @@ void SessionImpl::generateResumeData()
             m_needSaveResumeDataTorrents.remove(torrent->id());
         }
     }
+
+    // release metadata which may have been restored while inspecting a stopped torrent
+    for (auto it = m_restoredMetadataTorrents.begin(); it != m_restoredMetadataTorrents.end();)
+    {
+        TorrentImpl *torrent = m_torrents.value(*it);
+        if (torrent && torrent->isValid())
+            torrent->releaseMetadata();
+
+        // torrent that can't be released yet (e.g. being moved) is checked next time
+        if (!torrent || !torrent->isPaused() || torrent->isMetadataCold())
+            it = m_restoredMetadataTorrents.erase(it);
+        else
+            ++it;
+    }
 }
 
 // Called on exit
@@ -4047,6 +4105,44 @@ void SessionImpl::setIPFilterFile(const Path &path)
     }
 }
 
+QStringList SessionImpl::IPFilterSources() const
+{
+    return m_IPFilterSources;
+}
+
+void SessionImpl::setIPFilterSources(const QStringList &sources)
+{
+    QStringList filteredSources;
+    for (const QString &source : sources)
+    {
+        const QString trimmedSource = source.trimmed();
+        if (!trimmedSource.isEmpty() && !filteredSources.contains(trimmedSource))
+            filteredSources.append(trimmedSource);
+    }
+
+    if (filteredSources != IPFilterSources())
+    {
+        m_IPFilterSources = filteredSources;
+        m_IPFilteringConfigured = false;
+        configureDeferred();
+    }
+}
+
+int SessionImpl::IPFilterRefreshInterval() const
+{
+    return m_IPFilterRefreshInterval;
+}
+
+void SessionImpl::setIPFilterRefreshInterval(const int hours)
+{
+    if (hours != IPFilterRefreshInterval())
+    {
+        m_IPFilterRefreshInterval = hours;
+        m_IPFilteringConfigured = false;
+        configureDeferred();
+    }
+}
+
 bool SessionImpl::isExcludedFileNamesEnabled() const
 {
     return m_isExcludedFileNamesEnabled;
@@ -4143,12 +4239,150 @@ void SessionImpl::setBannedIPs(const QStringList &newList)
 
 ResumeDataStorageType SessionImpl::resumeDataStorageType() const
 {
+    // Storage type is actually changed when migration is finished
+    if (m_resumeDataStorageMigrator)
+        return m_migrationTargetStorageType;
+
     return m_resumeDataStorageType;
 }
 
 void SessionImpl::setResumeDataStorageType(const ResumeDataStorageType type)
 {
+    if (type == resumeDataStorageType())
+        return;
+
+    // Resume data storage being used at startup is switched on the next startup
+    if (!isRestored())
+    {
+        m_resumeDataStorageType = type;
+        return;
+    }
+
+    if (m_resumeDataStorageMigrator)
+        cancelResumeDataStorageMigration();
+
+    if (type != m_resumeDataStorageType.get())
+        startResumeDataStorageMigration(type);
+}
+
+void SessionImpl::startResumeDataStorageMigration(const ResumeDataStorageType type)
+{
+    Q_ASSERT(!m_resumeDataStorageMigrator);
+
+    try
+    {
+        if (type == ResumeDataStorageType::SQLite)
+        {
+            // Database is built aside and takes place of the actual one only when it's complete
+            const Path dbPath = specialFolderLocation(SpecialFolder::Data) / Path(MIGRATION_DB_FILENAME);
+            removeDatabaseFiles(dbPath);
+            m_migrationTargetStorage = new DBResumeDataStorage(dbPath, this);
+        }
+        else
+        {
+            const Path dataPath = specialFolderLocation(SpecialFolder::Data) / Path(u"BT_backup"_s);
+            m_migrationTargetStorage = new BencodeResumeDataStorage(dataPath, this);
+        }
+    }
+    catch (const RuntimeError &err)
+    {
+        LogMsg(tr("Failed to switch resume data storage. Error: \"%1\"").arg(err.message()), Log::CRITICAL);
+        return;
+    }
+
+    QVector<TorrentID> torrentIDs;
+    torrentIDs.reserve(m_torrents.size() + m_loadingTorrents.size());
+    for (auto it = m_torrents.cbegin(); it != m_torrents.cend(); ++it)
+        torrentIDs.append(it.key());
+    for (auto it = m_loadingTorrents.cbegin(); it != m_loadingTorrents.cend(); ++it)
+        torrentIDs.append(it.key());
+
+    m_migrationTargetStorageType = type;
+    m_resumeDataStorageMigrator = new ResumeDataStorageMigrator(m_resumeDataStorage, m_migrationTargetStorage, torrentIDs, this);
+    connect(m_resumeDataStorageMigrator, &ResumeDataStorageMigrator::progressUpdated, this
+            , [lastLoggedProgress = 0](const int progress) mutable
+    {
+        if ((progress - lastLoggedProgress) < 10)
+            return;
+
+        lastLoggedProgress = progress;
+        LogMsg(tr("Migrating resume data. Progress: %1%").arg(progress));
+    });
+    connect(m_resumeDataStorageMigrator, &ResumeDataStorageMigrator::finished
+            , this, &SessionImpl::finishResumeDataStorageMigration);
+
+    LogMsg(tr("Started migrating resume data to another storage. Storage type: %1. Torrents: %2")
+           .arg(Utils::String::fromEnum(type), QString::number(torrentIDs.size())));
+    m_resumeDataStorageMigrator->start();
+}
+
+void SessionImpl::finishResumeDataStorageMigration()
+{
+    m_resumeDataStorageMigrator->deleteLater();
+    m_resumeDataStorageMigrator = nullptr;
+
+    ResumeDataStorage *oldStorage = m_resumeDataStorage;
+    ResumeDataStorage *newStorage = std::exchange(m_migrationTargetStorage, nullptr);
+    const ResumeDataStorageType type = m_migrationTargetStorageType;
+
+    if (type == ResumeDataStorageType::SQLite)
+    {
+        const Path migrationDBPath = newStorage->path();
+        // Deleting the storage makes it to write all the pending changes and to close database
+        delete newStorage;
+        newStorage = nullptr;
+
+        const Path dbPath = specialFolderLocation(SpecialFolder::Data) / Path(u"torrents.db"_s);
+        removeDatabaseFiles(dbPath);
+        if (!Utils::Fs::renameFile(migrationDBPath, dbPath))
+        {
+            LogMsg(tr("Failed to switch resume data storage. Couldn't rename \"%1\" to \"%2\"")
+                   .arg(migrationDBPath.toString(), dbPath.toString()), Log::CRITICAL);
+            removeDatabaseFiles(migrationDBPath);
+            return;
+        }
+
+        try
+        {
+            newStorage = new DBResumeDataStorage(dbPath, this);
+        }
+        catch (const RuntimeError &err)
+        {
+            // Old storage keeps being used so the database that can't be opened
+            // shouldn't take its place on the next startup either
+            LogMsg(tr("Failed to switch resume data storage. Error: \"%1\"").arg(err.message()), Log::CRITICAL);
+            removeDatabaseFiles(dbPath);
+            return;
+        }
+    }
+
+    m_resumeDataStorage = newStorage;
     m_resumeDataStorageType = type;
+    if (isQueueingSystemEnabled())
+        saveTorrentsQueue();
+
+    const Path oldStoragePath = oldStorage->path();
+    delete oldStorage;
+    // The same as switching storage at startup, database isn't kept
+    if (type == ResumeDataStorageType::Legacy)
+        removeDatabaseFiles(oldStoragePath);
+
+    LogMsg(tr("Resume data storage is switched. Storage type: %1").arg(Utils::String::fromEnum(type)));
+}
+
+void SessionImpl::cancelResumeDataStorageMigration()
+{
+    delete m_resumeDataStorageMigrator;
+    m_resumeDataStorageMigrator = nullptr;
+
+    const Path targetStoragePath = m_migrationTargetStorage->path();
+    delete m_migrationTargetStorage;
+    m_migrationTargetStorage = nullptr;
+
+    if (m_migrationTargetStorageType == ResumeDataStorageType::SQLite)
+        removeDatabaseFiles(targetStoragePath);
+
+    LogMsg(tr("Resume data migration is cancelled"));
 }
 
 bool SessionImpl::isMergeTrackersEnabled() const
@@ -5175,6 +5409,11 @@ void SessionImpl::handleTorrentMetadataReceived(TorrentImpl *const torrent)
     emit torrentMetadataReceived(torrent);
 }
 
+void SessionImpl::handleTorrentMetadataRestored(const TorrentImpl *torrent)
+{
+    m_restoredMetadataTorrents.insert(torrent->id());
+}
+
 void SessionImpl::handleTorrentPaused(TorrentImpl *const torrent)
 {
     LogMsg(tr("Torrent paused. Torrent: \"%1\"").arg(torrent->name()));
@@ -5223,10 +5462,15 @@ void SessionImpl::handleTorrentResumeDataReady(TorrentImpl *const torrent, const
     --m_numResumeData;
 
     m_resumeDataStorage->store(torrent->id(), data);
+    if (m_resumeDataStorageMigrator)
+        m_resumeDataStorageMigrator->store(torrent->id(), data);
+
     const auto iter = m_changedTorrentIDs.find(torrent->id());
     if (iter != m_changedTorrentIDs.end())
     {
         m_resumeDataStorage->remove(iter.value());
+        if (m_resumeDataStorageMigrator)
+            m_resumeDataStorageMigrator->remove(iter.value());
         m_changedTorrentIDs.erase(iter);
     }
 }
@@ -5467,21 +5711,35 @@ void SessionImpl::configureDeferred()
 }
 
 // Enable IP Filtering
-// this method creates ban list from scratch combining user ban list and 3rd party ban list file
+// this method creates ban list from scratch combining user ban list and 3rd party ban list files
 void SessionImpl::enableIPFilter()
 {
     qDebug("Enabling IPFilter");
-    // 1. Parse the IP filter
+    // 1. Parse the IP filter lists that are currently available
     // 2. In the slot add the manually banned IPs to the provided lt::ip_filter
     // 3. Set the ip_filter in one go so there isn't a time window where there isn't an ip_filter
     //    set between clearing the old one and setting the new one.
-    if (!m_filterParser)
+    // 4. Update remote lists in background and parse them again only if they are changed
+    if (!m_IPFilterListDownloader)
     {
-        m_filterParser = new FilterParserThread(this);
-        connect(m_filterParser.data(), &FilterParserThread::IPFilterParsed, this, &SessionImpl::handleIPFilterParsed);
-        connect(m_filterParser.data(), &FilterParserThread::IPFilterError, this, &SessionImpl::handleIPFilterError);
+        m_IPFilterListDownloader = new IPFilterListDownloader((specialFolderLocation(SpecialFolder::Data) / Path(u"ipfilter_lists"_s)), this);
+        connect(m_IPFilterListDownloader, &IPFilterListDownloader::updateFinished, this, &SessionImpl::handleIPFilterListsUpdated);
     }
-    m_filterParser->processFilterFile(IPFilterFile());
+
+    if (!m_IPFilterRefreshTimer)
+    {
+        m_IPFilterRefreshTimer = new QTimer(this);
+        connect(m_IPFilterRefreshTimer, &QTimer::timeout, this, [this]
+        {
+            refreshIPFilter();
+            updateIPFilterLists();
+        });
+    }
+
+    processIPFilterFiles(IPFilterFilePaths());
+
+    m_IPFilterRefreshTimer->start(std::chrono::hours(IPFilterRefreshInterval()));
+    updateIPFilterLists();
 }
 
 // Disable IP Filtering
@@ -5494,6 +5752,10 @@ void SessionImpl::disableIPFilter()
         delete m_filterParser;
     }
 
+    if (m_IPFilterRefreshTimer)
+        m_IPFilterRefreshTimer->stop();
+    m_IPFilterFilesState.clear();
+
     // Add the banned IPs after the IPFilter disabling
     // which creates an empty filter and overrides all previously
     // applied bans.
@@ -5502,6 +5764,66 @@ void SessionImpl::disableIPFilter()
     m_nativeSession->set_ip_filter(filter);
 }
 
+PathList SessionImpl::IPFilterFilePaths() const
+{
+    PathList filePaths;
+    if (!IPFilterFile().isEmpty())
+        filePaths.append(IPFilterFile());
+
+    for (const QString &source : asConst(IPFilterSources()))
+    {
+        // Remote lists that haven't been downloaded yet are skipped
+        const Path filePath = Net::DownloadManager::hasSupportedScheme(source)
+                ? m_IPFilterListDownloader->listPath(source)
+                : Path(source);
+        if (!filePath.isEmpty() && !filePaths.contains(filePath))
+            filePaths.append(filePath);
+    }
+
+    return filePaths;
+}
+
+void SessionImpl::processIPFilterFiles(const PathList &filePaths)
+{
+    m_IPFilterFilesState = filesState(filePaths);
+
+    if (!m_filterParser)
+    {
+        m_filterParser = new FilterParserThread(this);
+        connect(m_filterParser.data(), &FilterParserThread::IPFilterParsed, this, &SessionImpl::handleIPFilterParsed);
+        connect(m_filterParser.data(), &FilterParserThread::IPFilterError, this, &SessionImpl::handleIPFilterError);
+    }
+    m_filterParser->processFilterFiles(filePaths);
+}
+
+// Parse the filter lists again only if some of them are changed
+void SessionImpl::refreshIPFilter()
+{
+    if (!isIPFilteringEnabled())
+        return;
+
+    const PathList filePaths = IPFilterFilePaths();
+    if (filesState(filePaths) != m_IPFilterFilesState)
+        processIPFilterFiles(filePaths);
+}
+
+void SessionImpl::updateIPFilterLists()
+{
+    QStringList urls;
+    for (const QString &source : asConst(IPFilterSources()))
+    {
+        if (Net::DownloadManager::hasSupportedScheme(source))
+            urls.append(source);
+    }
+    m_IPFilterListDownloader->update(urls);
+}
+
+void SessionImpl::handleIPFilterListsUpdated(const bool isChanged)
+{
+    if (isChanged)
+        refreshIPFilter();
+}
+
 void SessionImpl::recursiveTorrentDownload(const TorrentID &id)
 {
     const TorrentImpl *torrent = m_torrents.value(id);
@@ -6177,6 +6499,30 @@ void SessionImpl::handleSessionStatsAlert(const lt::session_stats_alert *p)
     m_status.diskWriteQueue = stats[m_metricIndices.peer.numPeersDownDisk];
     m_status.peersCount = stats[m_metricIndices.peer.numPeersConnected];
 
+    // Metadata statistics require all the torrents to be inspected so they are updated less often
+    if (!m_metadataStatisticsUpdateTimer.isValid() || m_metadataStatisticsUpdateTimer.hasExpired(METADATA_STATISTICS_UPDATE_INTERVAL))
+    {
+        m_status.hotTorrentsCount = 0;
+        m_status.coldTorrentsCount = 0;
+        m_status.hotMetadataMemoryUsage = 0;
+        m_status.coldMetadataMemoryUsage = 0;
+        for (const TorrentImpl *torrent : asConst(m_torrents))
+        {
+            if (torrent->isMetadataCold())
+            {
+                ++m_status.coldTorrentsCount;
+                m_status.coldMetadataMemoryUsage += torrent->metadataMemoryUsage();
+            }
+            else
+            {
+                ++m_status.hotTorrentsCount;
+                m_status.hotMetadataMemoryUsage += torrent->metadataMemoryUsage();
+            }
+        }
+
+        m_metadataStatisticsUpdateTimer.start();
+    }
+
     if (totalDownload > m_status.totalDownload)
     {
         m_status.totalDownload = totalDownload;
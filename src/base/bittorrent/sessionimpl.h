@@ -80,8 +80,10 @@ namespace Net
 namespace BitTorrent
 {
     class InfoHash;
+    class IPFilterListDownloader;
     class MagnetUri;
     class ResumeDataStorage;
+    class ResumeDataStorageMigrator;
     class Torrent;
     class TorrentImpl;
     class Tracker;
@@ -274,6 +276,10 @@ namespace BitTorrent
         void setIPFilteringEnabled(bool enabled) override;
         Path IPFilterFile() const override;
         void setIPFilterFile(const Path &path) override;
+        QStringList IPFilterSources() const override;
+        void setIPFilterSources(const QStringList &sources) override;
+        int IPFilterRefreshInterval() const override;
+        void setIPFilterRefreshInterval(int hours) override;
         bool announceToAllTrackers() const override;
         void setAnnounceToAllTrackers(bool val) override;
         bool announceToAllTiers() const override;
@@ -444,6 +450,7 @@ namespace BitTorrent
         void handleTorrentTagRemoved(TorrentImpl *torrent, const QString &tag);
         void handleTorrentSavingModeChanged(TorrentImpl *torrent);
         void handleTorrentMetadataReceived(TorrentImpl *torrent);
+        void handleTorrentMetadataRestored(const TorrentImpl *torrent);
         void handleTorrentPaused(TorrentImpl *torrent);
         void handleTorrentResumed(TorrentImpl *torrent);
         void handleTorrentChecked(TorrentImpl *torrent);
@@ -501,6 +508,9 @@ namespace BitTorrent
         void generateResumeData();
         void handleIPFilterParsed(int ruleCount);
         void handleIPFilterError();
+        void handleIPFilterListsUpdated(bool isChanged);
+        void refreshIPFilter();
+        void updateIPFilterLists();
         void handleDownloadFinished(const Net::DownloadResult &result);
         void fileSearchFinished(const TorrentID &id, const Path &savePath, const PathList &fileNames);
 
@@ -557,6 +567,8 @@ namespace BitTorrent
         void populateAdditionalTrackers();
         void enableIPFilter();
         void disableIPFilter();
+        PathList IPFilterFilePaths() const;
+        void processIPFilterFiles(const PathList &filePaths);
         void processTrackerStatuses();
         void populateExcludedFileNamesRegExpList();
         void prepareStartup();
@@ -564,6 +576,10 @@ namespace BitTorrent
         void processNextResumeData(ResumeSessionContext *context);
         void endStartup(ResumeSessionContext *context);
 
+        void startResumeDataStorageMigration(ResumeDataStorageType type);
+        void finishResumeDataStorageMigration();
+        void cancelResumeDataStorageMigration();
+
         LoadTorrentParams initLoadTorrentParams(const AddTorrentParams &addTorrentParams);
         bool addTorrent_impl(const std::variant<MagnetUri, TorrentInfo> &source, const AddTorrentParams &addTorrentParams);
 
@@ -633,6 +649,8 @@ namespace BitTorrent
         CachedSettingValue<bool> m_isIPFilteringEnabled;
         CachedSettingValue<bool> m_isTrackerFilteringEnabled;
         CachedSettingValue<Path> m_IPFilterFile;
+        CachedSettingValue<QStringList> m_IPFilterSources;
+        CachedSettingValue<int> m_IPFilterRefreshInterval;
         CachedSettingValue<bool> m_announceToAllTrackers;
         CachedSettingValue<bool> m_announceToAllTiers;
         CachedSettingValue<int> m_asyncIOThreads;
@@ -753,6 +771,9 @@ namespace BitTorrent
         CachedSettingValue<bool> m_autoBanBTPlayerPeer;
         CachedSettingValue<bool> m_isAutoUpdateTrackersEnabled;
         QTimer *m_updateTimer;
+        // Source of the public tracker list that was applied last time
+        QString m_publicTrackersURL;
+        QByteArray m_publicTrackersHash;
 
         bool m_isRestored = false;
 
@@ -769,6 +790,7 @@ namespace BitTorrent
 
         // Statistics
         mutable QElapsedTimer m_statisticsLastUpdateTimer;
+        QElapsedTimer m_metadataStatisticsUpdateTimer;
         mutable bool m_isStatisticsDirty = false;
         qint64 m_previouslyUploaded = 0;
         qint64 m_previouslyDownloaded = 0;
@@ -780,6 +802,10 @@ namespace BitTorrent
         QTimer *m_resumeDataTimer = nullptr;
         // IP filtering
         QPointer<FilterParserThread> m_filterParser;
+        IPFilterListDownloader *m_IPFilterListDownloader = nullptr;
+        QTimer *m_IPFilterRefreshTimer = nullptr;
+        // Size and modification time of the filter files that were parsed last time
+        QStringList m_IPFilterFilesState;
         QPointer<BandwidthScheduler> m_bwScheduler;
         // Tracker
         QPointer<Tracker> m_tracker;
@@ -787,6 +813,9 @@ namespace BitTorrent
         Utils::Thread::UniquePtr m_ioThread;
         QThreadPool *m_asyncWorker = nullptr;
         ResumeDataStorage *m_resumeDataStorage = nullptr;
+        ResumeDataStorageMigrator *m_resumeDataStorageMigrator = nullptr;
+        ResumeDataStorage *m_migrationTargetStorage = nullptr;
+        ResumeDataStorageType m_migrationTargetStorageType = ResumeDataStorageType::Legacy;
         FileSearcher *m_fileSearcher = nullptr;
 
         QHash<TorrentID, lt::torrent_handle> m_downloadedMetadata;
@@ -797,6 +826,8 @@ namespace BitTorrent
         QHash<QString, AddTorrentParams> m_downloadedTorrents;
         QHash<TorrentID, RemovingTorrentData> m_removingTorrents;
         QSet<TorrentID> m_needSaveResumeDataTorrents;
+        // Torrents which metadata has been restored so it may be released again
+        QSet<TorrentID> m_restoredMetadataTorrents;
         QHash<TorrentID, TorrentID> m_changedTorrentIDs;
         QMap<QString, CategoryOptions> m_categories;
         QSet<QString> m_tags;
@@ -73,5 +73,12 @@ namespace BitTorrent
         qint64 diskWriteQueue = 0;
         qint64 dhtNodes = 0;
         qint64 peersCount = 0;
+
+        // Torrents which metadata is released ("cold") or loaded ("hot")
+        // and estimated memory usage of their metadata
+        qint64 hotTorrentsCount = 0;
+        qint64 coldTorrentsCount = 0;
+        qint64 hotMetadataMemoryUsage = 0;
+        qint64 coldMetadataMemoryUsage = 0;
     };
 }
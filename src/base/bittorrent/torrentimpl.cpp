@@ -337,6 +337,9 @@ TorrentImpl::TorrentImpl(SessionImpl *session, lt::session *nativeSession
         }
     }
     // == END UPGRADE CODE ==
+
+    if (m_isStopped)
+        releaseMetadata();
 }
 
 TorrentImpl::~TorrentImpl() = default;
@@ -357,7 +360,7 @@ QString TorrentImpl::name() const
         return m_name;
 
     if (hasMetadata())
-        return m_torrentInfo.name();
+        return m_isMetadataCold ? m_metadataSummary.name : m_torrentInfo.name();
 
     const QString name = QString::fromStdString(m_nativeStatus.name);
     if (!name.isEmpty())
@@ -368,27 +371,27 @@ QString TorrentImpl::name() const
 
 QDateTime TorrentImpl::creationDate() const
 {
-    return m_torrentInfo.creationDate();
+    return m_isMetadataCold ? m_metadataSummary.creationDate : m_torrentInfo.creationDate();
 }
 
 QString TorrentImpl::creator() const
 {
-    return m_torrentInfo.creator();
+    return m_isMetadataCold ? m_metadataSummary.creator : m_torrentInfo.creator();
 }
 
 QString TorrentImpl::comment() const
 {
-    return m_torrentInfo.comment();
+    return m_isMetadataCold ? m_metadataSummary.comment : m_torrentInfo.comment();
 }
 
 bool TorrentImpl::isPrivate() const
 {
-    return m_torrentInfo.isPrivate();
+    return m_isMetadataCold ? m_metadataSummary.isPrivate : m_torrentInfo.isPrivate();
 }
 
 qlonglong TorrentImpl::totalSize() const
 {
-    return m_torrentInfo.totalSize();
+    return m_isMetadataCold ? m_metadataSummary.totalSize : m_torrentInfo.totalSize();
 }
 
 // size without the "don't download" files
@@ -404,7 +407,7 @@ qlonglong TorrentImpl::completedSize() const
 
 qlonglong TorrentImpl::pieceLength() const
 {
-    return m_torrentInfo.pieceLength();
+    return m_isMetadataCold ? m_metadataSummary.pieceLength : m_torrentInfo.pieceLength();
 }
 
 qlonglong TorrentImpl::wastedSize() const
@@ -748,6 +751,49 @@ bool TorrentImpl::needSaveResumeData() const
     return m_nativeStatus.need_save_resume;
 }
 
+bool TorrentImpl::isMetadataCold() const
+{
+    return m_isMetadataCold;
+}
+
+void TorrentImpl::releaseMetadata()
+{
+    if (m_isMetadataCold || !m_torrentInfo.isValid())
+        return;
+
+    if (!m_isStopped || (m_maintenanceJob != MaintenanceJob::None) || m_storageIsMoving || (m_renameCount > 0))
+        return;
+
+    m_metadataSummary.name = m_torrentInfo.name();
+    m_metadataSummary.creationDate = m_torrentInfo.creationDate();
+    m_metadataSummary.creator = m_torrentInfo.creator();
+    m_metadataSummary.comment = m_torrentInfo.comment();
+    m_metadataSummary.isPrivate = m_torrentInfo.isPrivate();
+    m_metadataSummary.totalSize = m_torrentInfo.totalSize();
+    m_metadataSummary.pieceLength = m_torrentInfo.pieceLength();
+    m_metadataSummary.piecesCount = m_torrentInfo.piecesCount();
+    m_metadataSummary.filesCount = m_torrentInfo.filesCount();
+
+    m_torrentInfo = TorrentInfo();
+    m_isMetadataCold = true;
+}
+
+qint64 TorrentImpl::metadataMemoryUsage() const
+{
+    // It is rough estimation since there is no way to get actual memory usage of lt::torrent_info
+    if (m_isMetadataCold)
+    {
+        return sizeof(MetadataSummary) + ((m_metadataSummary.name.size() + m_metadataSummary.creator.size()
+                + m_metadataSummary.comment.size()) * static_cast<qint64>(sizeof(QChar)));
+    }
+
+    if (!m_torrentInfo.isValid())
+        return 0;
+
+    // the whole info dictionary (including piece hashes) is stored in lt::torrent_info
+    return m_torrentInfo.nativeInfo()->metadata_size();
+}
+
 void TorrentImpl::saveResumeData(lt::resume_data_flags_t flags)
 {
     m_nativeHandle.save_resume_data(flags);
@@ -756,12 +802,12 @@ void TorrentImpl::saveResumeData(lt::resume_data_flags_t flags)
 
 int TorrentImpl::filesCount() const
 {
-    return m_torrentInfo.filesCount();
+    return m_isMetadataCold ? m_metadataSummary.filesCount : m_torrentInfo.filesCount();
 }
 
 int TorrentImpl::piecesCount() const
 {
-    return m_torrentInfo.piecesCount();
+    return m_isMetadataCold ? m_metadataSummary.piecesCount : m_torrentInfo.piecesCount();
 }
 
 int TorrentImpl::piecesHave() const
@@ -882,7 +928,7 @@ Path TorrentImpl::filePath(const int index) const
 
 Path TorrentImpl::actualFilePath(const int index) const
 {
-    const QVector<lt::file_index_t> nativeIndexes = m_torrentInfo.nativeIndexes();
+    const QVector<lt::file_index_t> nativeIndexes = loadedTorrentInfo().nativeIndexes();
 
     Q_ASSERT(index >= 0);
     Q_ASSERT(index < nativeIndexes.size());
@@ -894,7 +940,7 @@ Path TorrentImpl::actualFilePath(const int index) const
 
 qlonglong TorrentImpl::fileSize(const int index) const
 {
-    return m_torrentInfo.fileSize(index);
+    return loadedTorrentInfo().fileSize(index);
 }
 
 PathList TorrentImpl::filePaths() const
@@ -909,7 +955,7 @@ QVector<DownloadPriority> TorrentImpl::filePriorities() const
 
 TorrentInfo TorrentImpl::info() const
 {
-    return m_torrentInfo;
+    return loadedTorrentInfo();
 }
 
 bool TorrentImpl::isPaused() const
@@ -1113,7 +1159,7 @@ void TorrentImpl::updateState()
 
 bool TorrentImpl::hasMetadata() const
 {
-    return m_torrentInfo.isValid();
+    return (m_isMetadataCold || m_torrentInfo.isValid());
 }
 
 bool TorrentImpl::hasMissingFiles() const
@@ -1573,7 +1619,8 @@ void TorrentImpl::applyFirstLastPiecePriority(const bool enabled)
 
     // Download first and last pieces first for every file in the torrent
 
-    auto piecePriorities = std::vector<lt::download_priority_t>(m_torrentInfo.piecesCount(), LT::toNative(DownloadPriority::Ignored));
+    const TorrentInfo &torrentInfo = loadedTorrentInfo();
+    auto piecePriorities = std::vector<lt::download_priority_t>(torrentInfo.piecesCount(), LT::toNative(DownloadPriority::Ignored));
 
     // Updating file priorities is an async operation in libtorrent, when we just updated it and immediately query it
     // we might get the old/wrong values, so we rely on `updatedFilePrio` in this case.
@@ -1585,7 +1632,7 @@ void TorrentImpl::applyFirstLastPiecePriority(const bool enabled)
 
         // Determine the priority to set
         const lt::download_priority_t piecePrio = LT::toNative(enabled ? DownloadPriority::Maximum : filePrio);
-        const TorrentInfo::PieceRange pieceRange = m_torrentInfo.filePieces(fileIndex);
+        const TorrentInfo::PieceRange pieceRange = torrentInfo.filePieces(fileIndex);
 
         // worst case: AVI index = 1% of total file size (at the end of the file)
         const int numPieces = std::ceil(fileSize(fileIndex) * 0.01 / pieceLength());
@@ -1638,6 +1685,22 @@ std::shared_ptr<const libtorrent::torrent_info> TorrentImpl::nativeTorrentInfo()
     return m_nativeStatus.torrent_file.lock();
 }
 
+const TorrentInfo &TorrentImpl::loadedTorrentInfo() const
+{
+    if (m_isMetadataCold)
+    {
+        // restore released metadata, summary keeps being used until it is actually restored
+        if (const std::shared_ptr<const lt::torrent_info> nativeInfo = nativeTorrentInfo())
+        {
+            m_torrentInfo = TorrentInfo(*nativeInfo);
+            m_isMetadataCold = false;
+            m_session->handleTorrentMetadataRestored(this);
+        }
+    }
+
+    return m_torrentInfo;
+}
+
 void TorrentImpl::endReceivedMetadataHandling(const Path &savePath, const PathList &fileNames)
 {
     Q_ASSERT(m_maintenanceJob == MaintenanceJob::HandleMetadata);
@@ -1771,6 +1834,8 @@ void TorrentImpl::pause()
 
         m_payloadRateMonitor.reset();
     }
+
+    releaseMetadata();
 }
 
 void TorrentImpl::resume(const TorrentOperatingMode mode)
@@ -1783,6 +1848,9 @@ void TorrentImpl::resume(const TorrentOperatingMode mode)
 
     m_operatingMode = mode;
 
+    // active torrent should have its metadata loaded
+    loadedTorrentInfo();
+
     if (m_hasMissingFiles)
     {
         m_hasMissingFiles = false;
@@ -2269,7 +2337,7 @@ void TorrentImpl::manageIncompleteFiles()
     {
         const Path path = filePath(i);
 
-        const auto nativeIndex = m_torrentInfo.nativeIndexes().at(i);
+        const auto nativeIndex = loadedTorrentInfo().nativeIndexes().at(i);
         const Path actualPath {nativeFiles.file_path(nativeIndex)};
         const Path wantedPath = wantedActualPath(i, path);
         if (actualPath != wantedPath)
@@ -2291,7 +2359,7 @@ void TorrentImpl::adjustStorageLocation()
 
 void TorrentImpl::doRenameFile(int index, const Path &path)
 {
-    const QVector<lt::file_index_t> nativeIndexes = m_torrentInfo.nativeIndexes();
+    const QVector<lt::file_index_t> nativeIndexes = loadedTorrentInfo().nativeIndexes();
 
     Q_ASSERT(index >= 0);
     Q_ASSERT(index < nativeIndexes.size());
@@ -2393,19 +2461,20 @@ void TorrentImpl::updateProgress()
     const QBitArray oldPieces = std::exchange(m_pieces, LT::toQBitArray(m_nativeStatus.pieces));
     const QBitArray newPieces = m_pieces ^ oldPieces;
 
-    const int64_t pieceSize = m_torrentInfo.pieceLength();
+    const int64_t pieceSize = pieceLength();
     for (qsizetype index = 0; index < newPieces.size(); ++index)
     {
         if (!newPieces.at(index))
             continue;
 
-        int64_t size = m_torrentInfo.pieceLength(index);
+        const TorrentInfo &torrentInfo = loadedTorrentInfo();
+        int64_t size = torrentInfo.pieceLength(index);
         int64_t pieceOffset = index * pieceSize;
 
-        for (const int fileIndex : asConst(m_torrentInfo.fileIndicesForPiece(index)))
+        for (const int fileIndex : asConst(torrentInfo.fileIndicesForPiece(index)))
         {
-            const int64_t fileOffsetInPiece = pieceOffset - m_torrentInfo.fileOffset(fileIndex);
-            const int64_t add = std::min<int64_t>((m_torrentInfo.fileSize(fileIndex) - fileOffsetInPiece), size);
+            const int64_t fileOffsetInPiece = pieceOffset - torrentInfo.fileOffset(fileIndex);
+            const int64_t add = std::min<int64_t>((torrentInfo.fileSize(fileIndex) - fileOffsetInPiece), size);
 
             m_filesProgress[fileIndex] += add;
 
@@ -2692,7 +2761,7 @@ void TorrentImpl::fetchPieceAvailability(std::function<void (QVector<int>)> resu
 
 void TorrentImpl::fetchDownloadingPieces(std::function<void (QBitArray)> resultHandler) const
 {
-    invokeAsync([nativeHandle = m_nativeHandle, torrentInfo = m_torrentInfo]() -> QBitArray
+    invokeAsync([nativeHandle = m_nativeHandle, torrentInfo = loadedTorrentInfo()]() -> QBitArray
     {
         try
         {
@@ -2717,7 +2786,7 @@ void TorrentImpl::fetchDownloadingPieces(std::function<void (QBitArray)> resultH
 
 void TorrentImpl::fetchAvailableFileFractions(std::function<void (QVector<qreal>)> resultHandler) const
 {
-    invokeAsync([nativeHandle = m_nativeHandle, torrentInfo = m_torrentInfo]() -> QVector<qreal>
+    invokeAsync([nativeHandle = m_nativeHandle, torrentInfo = loadedTorrentInfo()]() -> QVector<qreal>
     {
         if (!torrentInfo.isValid() || (torrentInfo.filesCount() <= 0))
             return {};
@@ -2775,9 +2844,10 @@ void TorrentImpl::prioritizeFiles(const QVector<DownloadPriority> &priorities)
         }
     }
 
-    const int internalFilesCount = m_torrentInfo.nativeInfo()->files().num_files(); // including .pad files
+    const TorrentInfo &torrentInfo = loadedTorrentInfo();
+    const int internalFilesCount = torrentInfo.nativeInfo()->files().num_files(); // including .pad files
     auto nativePriorities = std::vector<lt::download_priority_t>(internalFilesCount, LT::toNative(DownloadPriority::Normal));
-    const auto nativeIndexes = m_torrentInfo.nativeIndexes();
+    const auto nativeIndexes = torrentInfo.nativeIndexes();
     for (int i = 0; i < priorities.size(); ++i)
         nativePriorities[LT::toUnderlyingType(nativeIndexes[i])] = LT::toNative(priorities[i]);
 
@@ -2801,11 +2871,12 @@ QVector<qreal> TorrentImpl::availableFileFractions() const
     // libtorrent returns empty array for seeding only torrents
     if (piecesAvailability.empty()) return QVector<qreal>(filesCount, -1);
 
+    const TorrentInfo &torrentInfo = loadedTorrentInfo();
     QVector<qreal> res;
     res.reserve(filesCount);
     for (int i = 0; i < filesCount; ++i)
     {
-        const TorrentInfo::PieceRange filePieces = m_torrentInfo.filePieces(i);
+        const TorrentInfo::PieceRange filePieces = torrentInfo.filePieces(i);
 
         int availablePieces = 0;
         for (const int piece : filePieces)
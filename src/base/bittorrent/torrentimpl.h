@@ -254,6 +254,10 @@ namespace BitTorrent
 
         bool needSaveResumeData() const;
 
+        bool isMetadataCold() const;
+        void releaseMetadata();
+        qint64 metadataMemoryUsage() const;
+
         // Session interface
         lt::torrent_handle nativeHandle() const;
 
@@ -270,6 +274,7 @@ namespace BitTorrent
         using EventTrigger = std::function<void ()>;
 
         std::shared_ptr<const lt::torrent_info> nativeTorrentInfo() const;
+        const TorrentInfo &loadedTorrentInfo() const;
 
         void updateStatus(const lt::torrent_status &nativeStatus);
         void updateProgress();
@@ -317,7 +322,25 @@ namespace BitTorrent
         lt::torrent_handle m_nativeHandle;
         mutable lt::torrent_status m_nativeStatus;
         TorrentState m_state = TorrentState::Unknown;
-        TorrentInfo m_torrentInfo;
+        mutable TorrentInfo m_torrentInfo;
+
+        // Metadata of stopped torrent can be released to save memory ("cold" state).
+        // Only basic properties are kept in this case while the whole metadata
+        // is restored from libtorrent when it is required.
+        struct MetadataSummary
+        {
+            QString name;
+            QDateTime creationDate;
+            QString creator;
+            QString comment;
+            bool isPrivate = false;
+            qlonglong totalSize = 0;
+            qlonglong pieceLength = 0;
+            int piecesCount = 0;
+            int filesCount = 0;
+        };
+        MetadataSummary m_metadataSummary;
+        mutable bool m_isMetadataCold = false;
         PathList m_filePaths;
         QHash<lt::file_index_t, int> m_indexMap;
         QVector<DownloadPriority> m_filePriorities;
@@ -65,6 +65,8 @@ Net::DownloadHandlerImpl::DownloadHandlerImpl(DownloadManager *manager
 {
     m_result.url = url();
     m_result.status = DownloadStatus::Success;
+
+    m_timer.start();
 }
 
 void Net::DownloadHandlerImpl::cancel()
@@ -87,6 +89,13 @@ void Net::DownloadHandlerImpl::assignNetworkReply(QNetworkReply *reply)
 
     m_reply = reply;
     m_reply->setParent(this);
+
+    m_waitingTime = m_timer.restart();
+    connect(m_reply, &QNetworkReply::metaDataChanged, this, [this]
+    {
+        if (m_responseTime < 0)
+            m_responseTime = m_timer.elapsed();
+    });
     if (m_downloadRequest.limit() > 0)
         connect(m_reply, &QNetworkReply::downloadProgress, this, &DownloadHandlerImpl::checkDownloadSize);
     connect(m_reply, &QNetworkReply::finished, this, &DownloadHandlerImpl::processFinishedDownload);
@@ -108,6 +117,21 @@ bool Net::DownloadHandlerImpl::useProxy() const
     return m_useProxy;
 }
 
+qint64 Net::DownloadHandlerImpl::waitingTime() const
+{
+    return m_waitingTime;
+}
+
+qint64 Net::DownloadHandlerImpl::responseTime() const
+{
+    return m_responseTime;
+}
+
+qint64 Net::DownloadHandlerImpl::downloadTime() const
+{
+    return m_reply ? m_timer.elapsed() : 0;
+}
+
 void Net::DownloadHandlerImpl::processFinishedDownload()
 {
     qDebug("Download finished: %s", qUtf8Printable(url()));
@@ -130,6 +154,19 @@ void Net::DownloadHandlerImpl::processFinishedDownload()
         return;
     }
 
+    m_result.eTag = QString::fromLatin1(m_reply->rawHeader("ETag"));
+    m_result.lastModified = m_reply->header(QNetworkRequest::LastModifiedHeader).toDateTime();
+    // Fresh cached response or the one that was successfully revalidated
+    m_result.fromCache = m_reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+
+    // The resource wasn't modified since the last (conditional) request
+    if (m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304)
+    {
+        m_result.notModified = true;
+        finish();
+        return;
+    }
+
     // Success
 #ifdef QT_NO_COMPRESS
     m_result.data = (m_reply->rawHeader("Content-Encoding") == "gzip")
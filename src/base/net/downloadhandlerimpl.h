@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QNetworkReply>
 
 #include "base/net/downloadmanager.h"
@@ -52,6 +53,13 @@ namespace Net
         DownloadRequest downloadRequest() const;
         bool useProxy() const;
 
+        // time spent waiting in the queue (-1 until the request is started)
+        qint64 waitingTime() const;
+        // time until the response headers were received (-1 until then)
+        qint64 responseTime() const;
+        // time since the request was started
+        qint64 downloadTime() const;
+
         void assignNetworkReply(QNetworkReply *reply);
 
     private:
@@ -69,5 +77,9 @@ namespace Net
         const bool m_useProxy = false;
         short m_redirectionCount = 0;
         DownloadResult m_result;
+
+        QElapsedTimer m_timer;
+        qint64 m_waitingTime = -1;
+        qint64 m_responseTime = -1;
     };
 }
@@ -36,6 +36,7 @@
 #include <QNetworkAccessManager>
 #include <QNetworkCookie>
 #include <QNetworkCookieJar>
+#include <QNetworkDiskCache>
 #include <QNetworkProxy>
 #include <QNetworkReply>
 #include <QNetworkRequest>
@@ -45,6 +46,7 @@
 #include "base/global.h"
 #include "base/logger.h"
 #include "base/preferences.h"
+#include "base/profile.h"
 #include "downloadhandlerimpl.h"
 #include "proxyconfigurationmanager.h"
 
@@ -52,6 +54,16 @@ namespace
 {
     // Disguise as Firefox to avoid web server banning
     const char DEFAULT_USER_AGENT[] = "Mozilla/5.0 (X11; Linux x86_64; rv:68.0) Gecko/20100101 Firefox/68.0";
+
+    const int MAX_ACTIVE_REQUESTS = 16;
+    // slots that are always left for requests of normal and high priority
+    const int RESERVED_REQUESTS = 4;
+    // QNetworkAccessManager doesn't open more connections per host anyway
+    const int MAX_SERVICE_REQUESTS = 6;
+    // QNetworkAccessManager keeps idle connections for this long
+    const qint64 CONNECTION_IDLE_TIMEOUT = 120 * 1000;
+
+    const qint64 MAX_CACHE_SIZE = 50 * 1024 * 1024;
 }
 
 class Net::DownloadManager::NetworkCookieJar final : public QNetworkCookieJar
@@ -117,7 +129,14 @@ Net::DownloadManager::DownloadManager(QObject *parent)
     , m_networkCookieJar {new NetworkCookieJar(this)}
     , m_networkManager {new QNetworkAccessManager(this)}
 {
+    m_clock.start();
+
     m_networkManager->setCookieJar(m_networkCookieJar);
+
+    auto *cache = new QNetworkDiskCache(m_networkManager);
+    cache->setCacheDirectory((specialFolderLocation(SpecialFolder::Cache) / Path(u"http"_s)).data());
+    cache->setMaximumCacheSize(MAX_CACHE_SIZE);
+    m_networkManager->setCache(cache);
     connect(m_networkManager, &QNetworkAccessManager::sslErrors, this
             , [](QNetworkReply *reply, const QList<QSslError> &errors)
     {
@@ -155,28 +174,20 @@ Net::DownloadManager *Net::DownloadManager::instance()
 
 Net::DownloadHandler *Net::DownloadManager::download(const DownloadRequest &downloadRequest, const bool useProxy)
 {
-    // Process download request
-    const ServiceID id = ServiceID::fromURL(downloadRequest.url());
-    const bool isSequentialService = m_sequentialServices.contains(id);
-
     auto *downloadHandler = new DownloadHandlerImpl(this, downloadRequest, useProxy);
     connect(downloadHandler, &DownloadHandler::finished, downloadHandler, &QObject::deleteLater);
-    connect(downloadHandler, &QObject::destroyed, this, [this, id, downloadHandler]()
+    // Canceled waiting request finishes immediately so it shouldn't be started anymore
+    connect(downloadHandler, &DownloadHandler::finished, this, [this, downloadHandler]()
     {
-        m_waitingJobs[id].removeOne(downloadHandler);
+        m_waitingRequests[static_cast<int>(downloadHandler->downloadRequest().priority())].removeOne(downloadHandler);
     });
-
-    if (isSequentialService && m_busyServices.contains(id))
-    {
-        m_waitingJobs[id].enqueue(downloadHandler);
-    }
-    else
+    connect(downloadHandler, &QObject::destroyed, this, [this, downloadHandler]()
     {
-        qDebug("Downloading %s...", qUtf8Printable(downloadRequest.url()));
-        if (isSequentialService)
-            m_busyServices.insert(id);
-        processRequest(downloadHandler);
-    }
+        handleHandlerDestroyed(downloadHandler);
+    });
+
+    m_waitingRequests[static_cast<int>(downloadRequest.priority())].append(downloadHandler);
+    processWaitingRequests();
 
     return downloadHandler;
 }
@@ -186,6 +197,11 @@ void Net::DownloadManager::registerSequentialService(const Net::ServiceID &servi
     m_sequentialServices.insert(serviceID);
 }
 
+QHash<Net::ServiceID, Net::ServiceStatistics> Net::DownloadManager::statistics() const
+{
+    return m_statistics;
+}
+
 QList<QNetworkCookie> Net::DownloadManager::cookiesForUrl(const QUrl &url) const
 {
     return m_networkCookieJar->cookiesForUrl(url);
@@ -259,25 +275,106 @@ void Net::DownloadManager::applyProxySettings()
         m_proxy.setCapabilities(m_proxy.capabilities() & ~QNetworkProxy::HostNameLookupCapability);
 }
 
-void Net::DownloadManager::handleDownloadFinished(DownloadHandlerImpl *finishedHandler)
+void Net::DownloadManager::handleDownloadFinished(DownloadHandlerImpl *finishedHandler, const QNetworkReply *reply)
+{
+    if (!m_activeRequests.contains(finishedHandler))
+        return;
+
+    const ServiceID id = m_activeRequests.value(finishedHandler);
+    ServiceStatistics &stats = m_statistics[id];
+    ++stats.finishedRequests;
+    if (reply->error() != QNetworkReply::NoError)
+        ++stats.failedRequests;
+    const qint64 waitingTime = finishedHandler->waitingTime();
+    stats.totalWaitingTime += waitingTime;
+    stats.maxWaitingTime = std::max(stats.maxWaitingTime, waitingTime);
+    const qint64 responseTime = std::max<qint64>(finishedHandler->responseTime(), 0);
+    stats.totalResponseTime += responseTime;
+    stats.maxResponseTime = std::max(stats.maxResponseTime, responseTime);
+    stats.totalDownloadTime += finishedHandler->downloadTime();
+
+    qDebug("Download of %s took %lld ms (waited in queue for %lld ms)", qUtf8Printable(finishedHandler->url())
+           , static_cast<long long>(finishedHandler->downloadTime()), static_cast<long long>(waitingTime));
+
+    releaseSlot(finishedHandler);
+    processWaitingRequests();
+}
+
+void Net::DownloadManager::handleHandlerDestroyed(DownloadHandlerImpl *handler)
 {
-    const ServiceID id = ServiceID::fromURL(finishedHandler->url());
-    const auto waitingJobsIter = m_waitingJobs.find(id);
-    if ((waitingJobsIter == m_waitingJobs.end()) || waitingJobsIter.value().isEmpty())
+    for (QList<DownloadHandlerImpl *> &waitingRequests : m_waitingRequests)
+        waitingRequests.removeOne(handler);
+
+    // Handler can be destroyed while its request is still active
+    if (m_activeRequests.contains(handler))
     {
-        // No more waiting jobs for given ServiceID
-        m_busyServices.remove(id);
+        releaseSlot(handler);
+        processWaitingRequests();
+    }
+}
+
+void Net::DownloadManager::releaseSlot(DownloadHandlerImpl *handler)
+{
+    const ServiceID id = m_activeRequests.take(handler);
+    m_lastServiceActivity[id] = m_clock.elapsed();
+
+    const auto iter = m_activeServiceRequests.find(id);
+    if (iter == m_activeServiceRequests.end())
         return;
+
+    if (--iter.value() <= 0)
+        m_activeServiceRequests.erase(iter);
+}
+
+void Net::DownloadManager::processWaitingRequests()
+{
+    // Requests are started in order of their priority. Waiting requests of busy service
+    // don't block the requests of other services that are queued after them.
+    for (int priority = static_cast<int>(DownloadPriority::High); priority >= static_cast<int>(DownloadPriority::Low); --priority)
+    {
+        const int maxActiveRequests = (priority == static_cast<int>(DownloadPriority::Low))
+                ? (MAX_ACTIVE_REQUESTS - RESERVED_REQUESTS) : MAX_ACTIVE_REQUESTS;
+
+        QList<DownloadHandlerImpl *> &waitingRequests = m_waitingRequests[priority];
+        for (int i = 0; i < waitingRequests.size();)
+        {
+            if (m_activeRequests.size() >= maxActiveRequests)
+                return;
+
+            DownloadHandlerImpl *handler = waitingRequests[i];
+            const ServiceID id = ServiceID::fromURL(handler->url());
+            if (m_activeServiceRequests.value(id) >= serviceRequestsLimit(id))
+            {
+                ++i;
+                continue;
+            }
+
+            waitingRequests.removeAt(i);
+            processRequest(handler);
+        }
     }
+}
 
-    auto *handler = waitingJobsIter.value().dequeue();
-    qDebug("Downloading %s...", qUtf8Printable(handler->url()));
-    processRequest(handler);
-    handler->disconnect(this);
+int Net::DownloadManager::serviceRequestsLimit(const ServiceID &serviceID) const
+{
+    return m_sequentialServices.contains(serviceID) ? 1 : MAX_SERVICE_REQUESTS;
 }
 
 void Net::DownloadManager::processRequest(DownloadHandlerImpl *downloadHandler)
 {
+    qDebug("Downloading %s...", qUtf8Printable(downloadHandler->url()));
+
+    const ServiceID id = ServiceID::fromURL(downloadHandler->url());
+    m_activeRequests.insert(downloadHandler, id);
+    const int serviceRequests = ++m_activeServiceRequests[id];
+    // Connection is most likely reused if there is some idle one left from the previous requests
+    const auto lastActivityIter = m_lastServiceActivity.constFind(id);
+    if ((serviceRequests == 1) && (lastActivityIter != m_lastServiceActivity.cend())
+            && ((m_clock.elapsed() - lastActivityIter.value()) < CONNECTION_IDLE_TIMEOUT))
+    {
+        ++m_statistics[id].reusedConnections;
+    }
+
     m_networkManager->setProxy((downloadHandler->useProxy() == true) ? m_proxy : QNetworkProxy(QNetworkProxy::NoProxy));
 
     const DownloadRequest downloadRequest = downloadHandler->downloadRequest();
@@ -296,13 +393,26 @@ void Net::DownloadManager::processRequest(DownloadHandlerImpl *downloadHandler)
     // gzip encoding and manually decompress the reply data.
     request.setRawHeader("Accept-Encoding", "gzip");
 #endif
+    if (!downloadRequest.ifNoneMatch().isEmpty())
+        request.setRawHeader("If-None-Match", downloadRequest.ifNoneMatch().toUtf8());
+    if (downloadRequest.ifModifiedSince().isValid())
+        request.setHeader(QNetworkRequest::IfModifiedSinceHeader, downloadRequest.ifModifiedSince());
+    if (downloadRequest.useCache())
+    {
+        request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferNetwork);
+    }
+    else
+    {
+        request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+        request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+    }
     // Qt doesn't support Magnet protocol so we need to handle redirections manually
     request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::ManualRedirectPolicy);
 
     QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, downloadHandler]
+    connect(reply, &QNetworkReply::finished, this, [this, downloadHandler, reply]
     {
-        handleDownloadFinished(downloadHandler);
+        handleDownloadFinished(downloadHandler, reply);
     });
     downloadHandler->assignNetworkReply(reply);
 }
@@ -367,6 +477,50 @@ Net::DownloadRequest &Net::DownloadRequest::destFileName(const Path &value)
     return *this;
 }
 
+QString Net::DownloadRequest::ifNoneMatch() const
+{
+    return m_ifNoneMatch;
+}
+
+Net::DownloadRequest &Net::DownloadRequest::ifNoneMatch(const QString &value)
+{
+    m_ifNoneMatch = value;
+    return *this;
+}
+
+QDateTime Net::DownloadRequest::ifModifiedSince() const
+{
+    return m_ifModifiedSince;
+}
+
+Net::DownloadRequest &Net::DownloadRequest::ifModifiedSince(const QDateTime &value)
+{
+    m_ifModifiedSince = value;
+    return *this;
+}
+
+Net::DownloadPriority Net::DownloadRequest::priority() const
+{
+    return m_priority;
+}
+
+Net::DownloadRequest &Net::DownloadRequest::priority(const DownloadPriority value)
+{
+    m_priority = value;
+    return *this;
+}
+
+bool Net::DownloadRequest::useCache() const
+{
+    return m_useCache;
+}
+
+Net::DownloadRequest &Net::DownloadRequest::useCache(const bool value)
+{
+    m_useCache = value;
+    return *this;
+}
+
 Net::ServiceID Net::ServiceID::fromURL(const QUrl &url)
 {
     return {url.host(), url.port(80)};
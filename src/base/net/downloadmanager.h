@@ -29,11 +29,15 @@
 
 #pragma once
 
+#include <array>
+
 #include <QtGlobal>
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QList>
 #include <QNetworkProxy>
 #include <QObject>
-#include <QQueue>
 #include <QSet>
 
 #include "base/path.h"
@@ -68,6 +72,15 @@ namespace Net
         Failed
     };
 
+    // Requests with higher priority are started first, low priority ones
+    // can't occupy all the download slots (see DownloadManager)
+    enum class DownloadPriority
+    {
+        Low,
+        Normal,
+        High
+    };
+
     class DownloadRequest
     {
     public:
@@ -92,12 +105,32 @@ namespace Net
         Path destFileName() const;
         DownloadRequest &destFileName(const Path &value);
 
+        // conditional request validators, if the resource wasn't modified
+        // the result will have "notModified" flag set and no data
+        QString ifNoneMatch() const;
+        DownloadRequest &ifNoneMatch(const QString &value);
+
+        QDateTime ifModifiedSince() const;
+        DownloadRequest &ifModifiedSince(const QDateTime &value);
+
+        DownloadPriority priority() const;
+        DownloadRequest &priority(DownloadPriority value);
+
+        // if useCache is set, the response is stored in the on-disk cache and
+        // it is revalidated according to its Cache-Control/ETag/Last-Modified headers
+        bool useCache() const;
+        DownloadRequest &useCache(bool value);
+
     private:
         QString m_url;
         QString m_userAgent;
         qint64 m_limit = 0;
         bool m_saveToFile = false;
         Path m_destFileName;
+        QString m_ifNoneMatch;
+        QDateTime m_ifModifiedSince;
+        DownloadPriority m_priority = DownloadPriority::Normal;
+        bool m_useCache = false;
     };
 
     struct DownloadResult
@@ -108,6 +141,25 @@ namespace Net
         QByteArray data;
         Path filePath;
         QString magnet;
+        QString eTag;
+        QDateTime lastModified;
+        bool notModified = false;
+        // the data was loaded from the cache, i.e. it is the same as when it was downloaded last time
+        bool fromCache = false;
+    };
+
+    // All times are in milliseconds
+    struct ServiceStatistics
+    {
+        int finishedRequests = 0;
+        int failedRequests = 0;
+        // estimated, since QNetworkAccessManager doesn't tell whether the connection was reused
+        int reusedConnections = 0;
+        qint64 totalWaitingTime = 0;
+        qint64 totalResponseTime = 0;
+        qint64 totalDownloadTime = 0;
+        qint64 maxWaitingTime = 0;
+        qint64 maxResponseTime = 0;
     };
 
     class DownloadHandler : public QObject
@@ -143,6 +195,8 @@ namespace Net
 
         void registerSequentialService(const ServiceID &serviceID);
 
+        QHash<ServiceID, ServiceStatistics> statistics() const;
+
         QList<QNetworkCookie> cookiesForUrl(const QUrl &url) const;
         bool setCookiesFromUrl(const QList<QNetworkCookie> &cookieList, const QUrl &url);
         QList<QNetworkCookie> allCookies() const;
@@ -157,8 +211,12 @@ namespace Net
         explicit DownloadManager(QObject *parent = nullptr);
 
         void applyProxySettings();
-        void handleDownloadFinished(DownloadHandlerImpl *finishedHandler);
+        void handleDownloadFinished(DownloadHandlerImpl *finishedHandler, const QNetworkReply *reply);
+        void handleHandlerDestroyed(DownloadHandlerImpl *handler);
+        void releaseSlot(DownloadHandlerImpl *handler);
+        void processWaitingRequests();
         void processRequest(DownloadHandlerImpl *downloadHandler);
+        int serviceRequestsLimit(const ServiceID &serviceID) const;
 
         static DownloadManager *m_instance;
         NetworkCookieJar *m_networkCookieJar = nullptr;
@@ -166,8 +224,14 @@ namespace Net
         QNetworkProxy m_proxy;
 
         QSet<ServiceID> m_sequentialServices;
-        QSet<ServiceID> m_busyServices;
-        QHash<ServiceID, QQueue<DownloadHandlerImpl *>> m_waitingJobs;
+        // waiting requests of each priority in order of their arrival
+        std::array<QList<DownloadHandlerImpl *>, 3> m_waitingRequests;
+        QHash<DownloadHandlerImpl *, ServiceID> m_activeRequests;
+        QHash<ServiceID, int> m_activeServiceRequests;
+
+        QElapsedTimer m_clock;
+        QHash<ServiceID, qint64> m_lastServiceActivity;
+        QHash<ServiceID, ServiceStatistics> m_statistics;
     };
 
     template <typename Context, typename Func>
@@ -130,7 +130,7 @@ void GeoIPManager::downloadDatabaseFile()
     const QDateTime curDatetime = QDateTime::currentDateTimeUtc();
     const QString curUrl = DATABASE_URL.arg(QLocale::c().toString(curDatetime, u"yyyy-MM"));
     DownloadManager::instance()->download(
-            {curUrl}, Preferences::instance()->useProxyForGeneralPurposes()
+            DownloadRequest(curUrl).priority(DownloadPriority::Low).useCache(true), Preferences::instance()->useProxyForGeneralPurposes()
             , this, &GeoIPManager::downloadFinished);
 }
 
@@ -432,6 +432,10 @@ void GeoIPManager::downloadFinished(const DownloadResult &result)
         return;
     }
 
+    // The database was already processed when it was downloaded last time
+    if (result.fromCache && m_geoIPDatabase)
+        return;
+
     bool ok = false;
     const QByteArray data = Utils::Gzip::decompress(result.data, &ok);
     if (!ok)
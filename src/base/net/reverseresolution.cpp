@@ -28,61 +28,181 @@
 
 #include "reverseresolution.h"
 
-#include <QHostInfo>
+#include <algorithm>
+#include <utility>
+
+#include <QDnsLookup>
 #include <QString>
+#include <QStringList>
+#include <QTimer>
 
-const int CACHE_SIZE = 2048;
+#include "base/global.h"
 
 using namespace Net;
 
 namespace
 {
+    const int CACHE_SIZE = 2048;
+    const int MAX_CONCURRENT_LOOKUPS = 8;
+    const int RESULTS_BATCH_INTERVAL = 250;  // ms
+
+    // Failed lookups are cached too, so unresolvable peers don't flood the DNS server
+    const qint64 MIN_TTL = 60;  // secs
+    const qint64 MAX_TTL = 24 * 60 * 60;  // secs
+    const qint64 NOT_FOUND_TTL = 30 * 60;  // secs
+    const qint64 FAILURE_TTL = 5 * 60;  // secs
+
     bool isUsefulHostName(const QString &hostname, const QHostAddress &ip)
     {
         return (!hostname.isEmpty() && (hostname != ip.toString()));
     }
+
+    QString reverseLookupName(const QHostAddress &ip)
+    {
+        bool isIPv4 = false;
+        const quint32 ipv4 = ip.toIPv4Address(&isIPv4);
+        if (isIPv4)
+        {
+            return u"%1.%2.%3.%4.in-addr.arpa"_s.arg(QString::number(ipv4 & 0xFF), QString::number((ipv4 >> 8) & 0xFF)
+                    , QString::number((ipv4 >> 16) & 0xFF), QString::number((ipv4 >> 24) & 0xFF));
+        }
+
+        const Q_IPV6ADDR ipv6 = ip.toIPv6Address();
+        QString name;
+        name.reserve(72);
+        for (int i = 15; i >= 0; --i)
+        {
+            name.append(QString::number((ipv6[i] & 0x0F), 16) + u'.');
+            name.append(QString::number(((ipv6[i] >> 4) & 0x0F), 16) + u'.');
+        }
+        name.append(u"ip6.arpa");
+        return name;
+    }
 }
 
 ReverseResolution::ReverseResolution(QObject *parent)
     : QObject(parent)
+    , m_resultsTimer {new QTimer(this)}
 {
     m_cache.setMaxCost(CACHE_SIZE);
+
+    m_resultsTimer->setSingleShot(true);
+    m_resultsTimer->setInterval(RESULTS_BATCH_INTERVAL);
+    connect(m_resultsTimer, &QTimer::timeout, this, &ReverseResolution::flushResults);
 }
 
 ReverseResolution::~ReverseResolution()
+{
+    clear();
+}
+
+void ReverseResolution::resolve(const QList<QHostAddress> &ips)
+{
+    for (const QHostAddress &ip : ips)
+    {
+        if (m_pendingIPs.contains(ip))
+            continue;
+
+        const CacheEntry *cacheEntry = m_cache.object(ip);
+        if (cacheEntry && !cacheEntry->expiration.hasExpired())
+        {
+            m_results[ip] = cacheEntry->hostname;
+            continue;
+        }
+
+        m_pendingIPs.insert(ip);
+        m_waitingIPs.append(ip);
+    }
+
+    if (!m_results.isEmpty() && !m_resultsTimer->isActive())
+        m_resultsTimer->start();
+
+    startLookups();
+}
+
+void ReverseResolution::clear()
 {
     // abort on-going lookups instead of waiting them
     for (auto iter = m_lookups.cbegin(); iter != m_lookups.cend(); ++iter)
-        QHostInfo::abortHostLookup(iter.key());
+    {
+        QDnsLookup *lookup = iter.key();
+        lookup->disconnect(this);
+        lookup->abort();
+        lookup->deleteLater();
+    }
+
+    m_lookups.clear();
+    m_waitingIPs.clear();
+    m_pendingIPs.clear();
+    m_results.clear();
+    m_resultsTimer->stop();
 }
 
-void ReverseResolution::resolve(const QHostAddress &ip)
+void ReverseResolution::startLookups()
 {
-    const QString *hostname = m_cache.object(ip);
-    if (hostname)
+    while (!m_waitingIPs.isEmpty() && (m_lookups.size() < MAX_CONCURRENT_LOOKUPS))
     {
-        emit ipResolved(ip, *hostname);
-        return;
-    }
+        const QHostAddress ip = m_waitingIPs.takeFirst();
 
-    // do reverse lookup: IP -> hostname
-    const int lookupId = QHostInfo::lookupHost(ip.toString(), this, &ReverseResolution::hostResolved);
-    m_lookups.insert(lookupId, ip);
+        // do reverse lookup: IP -> hostname
+        auto *lookup = new QDnsLookup(QDnsLookup::PTR, reverseLookupName(ip), this);
+        connect(lookup, &QDnsLookup::finished, this, [this, lookup]
+        {
+            handleLookupFinished(lookup);
+        });
+        m_lookups.insert(lookup, ip);
+        lookup->lookup();
+    }
 }
 
-void ReverseResolution::hostResolved(const QHostInfo &host)
+void ReverseResolution::handleLookupFinished(QDnsLookup *lookup)
 {
-    const QHostAddress ip = m_lookups.take(host.lookupId());
+    lookup->deleteLater();
+    const QHostAddress ip = m_lookups.take(lookup);
+    m_pendingIPs.remove(ip);
 
-    if (host.error() != QHostInfo::NoError)
+    switch (lookup->error())
     {
-        emit ipResolved(ip, {});
-        return;
+    case QDnsLookup::NoError:
+        {
+            const QList<QDnsDomainNameRecord> records = lookup->pointerRecords();
+            if (records.isEmpty())
+            {
+                addResult(ip, {}, NOT_FOUND_TTL);
+                break;
+            }
+
+            const QDnsDomainNameRecord &record = records.first();
+            QString hostname = record.value();
+            if (hostname.endsWith(u'.'))
+                hostname.chop(1);
+            addResult(ip, (isUsefulHostName(hostname, ip) ? hostname : QString()), record.timeToLive());
+        }
+        break;
+    case QDnsLookup::NotFoundError:
+        addResult(ip, {}, NOT_FOUND_TTL);
+        break;
+    case QDnsLookup::OperationCancelledError:
+        break;
+    default:
+        addResult(ip, {}, FAILURE_TTL);
+        break;
     }
 
-    const QString hostname = isUsefulHostName(host.hostName(), ip)
-        ? host.hostName()
-        : QString();
-    m_cache.insert(ip, new QString(hostname));
-    emit ipResolved(ip, hostname);
+    startLookups();
+}
+
+void ReverseResolution::addResult(const QHostAddress &ip, const QString &hostname, const qint64 ttl)
+{
+    const qint64 expiration = std::clamp(ttl, MIN_TTL, MAX_TTL) * 1000;
+    m_cache.insert(ip, new CacheEntry {hostname, QDeadlineTimer(expiration)});
+
+    m_results[ip] = hostname;
+    if (!m_resultsTimer->isActive())
+        m_resultsTimer->start();
+}
+
+void ReverseResolution::flushResults()
+{
+    emit ipsResolved(std::exchange(m_results, {}));
 }
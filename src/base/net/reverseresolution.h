@@ -29,11 +29,16 @@
 #pragma once
 
 #include <QCache>
+#include <QDeadlineTimer>
+#include <QHash>
 #include <QHostAddress>
+#include <QList>
 #include <QObject>
+#include <QSet>
 
-class QHostInfo;
+class QDnsLookup;
 class QString;
+class QTimer;
 
 namespace Net
 {
@@ -46,16 +51,31 @@ namespace Net
         explicit ReverseResolution(QObject *parent = nullptr);
         ~ReverseResolution();
 
-        void resolve(const QHostAddress &ip);
+        void resolve(const QList<QHostAddress> &ips);
+        // cancels the lookups that aren't finished yet and drops the results that aren't reported
+        void clear();
 
     signals:
-        void ipResolved(const QHostAddress &ip, const QString &hostname);
-
-    private slots:
-        void hostResolved(const QHostInfo &host);
+        // resolved IPs are reported in batches, empty hostname means that it can't be resolved
+        void ipsResolved(const QHash<QHostAddress, QString> &hostnames);
 
     private:
-        QHash<int, QHostAddress> m_lookups;  // <LookupID, IP>
-        QCache<QHostAddress, QString> m_cache;  // <IP, HostName>
+        struct CacheEntry
+        {
+            QString hostname;
+            QDeadlineTimer expiration;
+        };
+
+        void startLookups();
+        void handleLookupFinished(QDnsLookup *lookup);
+        void addResult(const QHostAddress &ip, const QString &hostname, qint64 ttl);
+        void flushResults();
+
+        QHash<QDnsLookup *, QHostAddress> m_lookups;
+        QList<QHostAddress> m_waitingIPs;
+        QSet<QHostAddress> m_pendingIPs;  // both waiting and being resolved
+        QCache<QHostAddress, CacheEntry> m_cache;
+        QHash<QHostAddress, QString> m_results;
+        QTimer *m_resultsTimer = nullptr;
     };
 }
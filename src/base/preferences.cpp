@@ -332,6 +332,71 @@ void Preferences::setBdecodeTokenLimit(const int value)
     setValue(u"BitTorrent/BdecodeTokenLimit"_s, value);
 }
 
+bool Preferences::isResumeDataCompressionEnabled() const
+{
+    return value(u"BitTorrent/ResumeDataCompression"_s, false);
+}
+
+void Preferences::setResumeDataCompressionEnabled(const bool enabled)
+{
+    if (enabled == isResumeDataCompressionEnabled())
+        return;
+
+    setValue(u"BitTorrent/ResumeDataCompression"_s, enabled);
+}
+
+int Preferences::getResumeDataCommitInterval() const
+{
+    return value(u"BitTorrent/ResumeDataCommitInterval"_s, 1000);
+}
+
+void Preferences::setResumeDataCommitInterval(const int value)
+{
+    if (value == getResumeDataCommitInterval())
+        return;
+
+    setValue(u"BitTorrent/ResumeDataCommitInterval"_s, value);
+}
+
+int Preferences::getResumeDataCommitJobsLimit() const
+{
+    return value(u"BitTorrent/ResumeDataCommitJobsLimit"_s, 500);
+}
+
+void Preferences::setResumeDataCommitJobsLimit(const int value)
+{
+    if (value == getResumeDataCommitJobsLimit())
+        return;
+
+    setValue(u"BitTorrent/ResumeDataCommitJobsLimit"_s, value);
+}
+
+bool Preferences::isResumeDataRelaxedDurabilityEnabled() const
+{
+    return value(u"BitTorrent/ResumeDataRelaxedDurability"_s, false);
+}
+
+void Preferences::setResumeDataRelaxedDurabilityEnabled(const bool enabled)
+{
+    if (enabled == isResumeDataRelaxedDurabilityEnabled())
+        return;
+
+    setValue(u"BitTorrent/ResumeDataRelaxedDurability"_s, enabled);
+}
+
+int Preferences::getResumeDataWALAutoCheckpoint() const
+{
+    return value(u"BitTorrent/ResumeDataWALAutoCheckpoint"_s, 1000);
+}
+
+void Preferences::setResumeDataWALAutoCheckpoint(const int value)
+{
+    if (value == getResumeDataWALAutoCheckpoint())
+        return;
+
+    setValue(u"BitTorrent/ResumeDataWALAutoCheckpoint"_s, value);
+}
+
 bool Preferences::isToolbarDisplayed() const
 {
     return value(u"Preferences/General/ToolbarDisplayed"_s, true);
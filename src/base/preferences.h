@@ -332,6 +332,16 @@ public:
     void setBdecodeDepthLimit(int value);
     int getBdecodeTokenLimit() const;
     void setBdecodeTokenLimit(int value);
+    bool isResumeDataCompressionEnabled() const;
+    void setResumeDataCompressionEnabled(bool enabled);
+    int getResumeDataCommitInterval() const;
+    void setResumeDataCommitInterval(int value);
+    int getResumeDataCommitJobsLimit() const;
+    void setResumeDataCommitJobsLimit(int value);
+    bool isResumeDataRelaxedDurabilityEnabled() const;
+    void setResumeDataRelaxedDurabilityEnabled(bool enabled);
+    int getResumeDataWALAutoCheckpoint() const;
+    void setResumeDataWALAutoCheckpoint(int value);
 
     // Stuff that don't appear in the Options GUI but are saved
     // in the same file.
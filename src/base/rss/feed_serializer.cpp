@@ -31,53 +31,144 @@
 
 #include "feed_serializer.h"
 
+#include <algorithm>
+
+#include <QFile>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QVector>
 
+#include "base/global.h"
 #include "base/logger.h"
 #include "base/path.h"
+#include "base/utils/fs.h"
 #include "base/utils/io.h"
 #include "rss_article.h"
 
 const int ARTICLEDATALIST_TYPEID = qRegisterMetaType<QVector<QVariantHash>>();
 
+namespace
+{
+    const QString JOURNAL_KEY_TYPE = u"type"_s;
+    const QString JOURNAL_KEY_ARTICLE = u"article"_s;
+    const QString JOURNAL_KEY_ID = u"id"_s;
+    const QString JOURNAL_TYPE_ADD = u"add"_s;
+    const QString JOURNAL_TYPE_READ = u"read"_s;
+
+    QJsonObject articleToJson(const QVariantHash &data)
+    {
+        auto jsonObj = QJsonObject::fromVariantHash(data);
+        // JSON object doesn't support DateTime so we need to convert it
+        jsonObj[RSS::Article::KeyDate] = data[RSS::Article::KeyDate].toDateTime().toString(Qt::RFC2822Date);
+        return jsonObj;
+    }
+
+    QVariantHash articleFromJson(const QJsonObject &jsonObj)
+    {
+        auto varHash = jsonObj.toVariantHash();
+        // JSON object store DateTime as string so we need to convert it
+        varHash[RSS::Article::KeyDate] =
+                QDateTime::fromString(jsonObj.value(RSS::Article::KeyDate).toString(), Qt::RFC2822Date);
+        return varHash;
+    }
+}
+
+Path RSS::Private::FeedSerializer::journalFileName(const Path &dataFileName)
+{
+    return dataFileName.removedExtension() + u".journal";
+}
+
 void RSS::Private::FeedSerializer::load(const Path &dataFileName, const QString &url)
 {
+    QVector<QVariantHash> articles;
+
     const auto readResult = Utils::IO::readFile(dataFileName, -1);
-    if (!readResult)
+    if (readResult)
+    {
+        articles = loadArticles(readResult.value(), url);
+    }
+    else if (readResult.error().status != Utils::IO::ReadError::NotExist)
     {
-        if (readResult.error().status == Utils::IO::ReadError::NotExist)
-        {
-            emit loadingFinished({});
-            return;
-        }
-
         LogMsg(tr("Failed to read RSS session data. %1").arg(readResult.error().message), Log::WARNING);
         return;
     }
 
-    emit loadingFinished(loadArticles(readResult.value(), url));
+    // Changes made after the articles were stored last time are kept in the journal
+    int journalEntryCount = 0;
+    const auto journalReadResult = Utils::IO::readFile(journalFileName(dataFileName), -1);
+    if (journalReadResult)
+    {
+        journalEntryCount = replayJournal(journalReadResult.value(), url, articles);
+    }
+    else if (journalReadResult.error().status != Utils::IO::ReadError::NotExist)
+    {
+        LogMsg(tr("Failed to read RSS session data. %1").arg(journalReadResult.error().message), Log::WARNING);
+    }
+
+    std::sort(articles.begin(), articles.end(), [](const QVariantHash &left, const QVariantHash &right)
+    {
+        return (left.value(Article::KeyDate).toDateTime() > right.value(Article::KeyDate).toDateTime());
+    });
+
+    emit loadingFinished(articles, journalEntryCount);
 }
 
 void RSS::Private::FeedSerializer::store(const Path &dataFileName, const QVector<QVariantHash> &articlesData)
 {
     QJsonArray arr;
     for (const QVariantHash &data : articlesData)
-    {
-        auto jsonObj = QJsonObject::fromVariantHash(data);
-        // JSON object doesn't support DateTime so we need to convert it
-        jsonObj[Article::KeyDate] = data[Article::KeyDate].toDateTime().toString(Qt::RFC2822Date);
-
-        arr << jsonObj;
-    }
+        arr << articleToJson(data);
 
     const nonstd::expected<void, QString> result = Utils::IO::saveToFile(dataFileName, QJsonDocument(arr).toJson());
     if (!result)
     {
        LogMsg(tr("Failed to save RSS feed in '%1', Reason: %2").arg(dataFileName.toString(), result.error())
               , Log::WARNING);
+       return;
+    }
+
+    // All the changes are in the data file now. If we crash before the journal is removed
+    // it is just replayed once more, which doesn't change anything.
+    Utils::Fs::removeFile(journalFileName(dataFileName));
+}
+
+void RSS::Private::FeedSerializer::storeChanges(const Path &dataFileName, const QVector<QVariantHash> &newArticlesData
+        , const QStringList &readArticleIDs)
+{
+    QByteArray data;
+    for (const QVariantHash &articleData : newArticlesData)
+    {
+        const QJsonObject entry {{JOURNAL_KEY_TYPE, JOURNAL_TYPE_ADD}, {JOURNAL_KEY_ARTICLE, articleToJson(articleData)}};
+        data += QJsonDocument(entry).toJson(QJsonDocument::Compact) + '\n';
+    }
+    for (const QString &articleID : readArticleIDs)
+    {
+        const QJsonObject entry {{JOURNAL_KEY_TYPE, JOURNAL_TYPE_READ}, {JOURNAL_KEY_ID, articleID}};
+        data += QJsonDocument(entry).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    const Path journalPath = journalFileName(dataFileName);
+    QFile journalFile {journalPath.data()};
+    if (!journalFile.open(QIODevice::ReadWrite | QIODevice::Append))
+    {
+        LogMsg(tr("Failed to save RSS feed in '%1', Reason: %2").arg(journalPath.toString(), journalFile.errorString())
+               , Log::WARNING);
+        return;
+    }
+
+    // The last entry can be incomplete if the application was terminated while writing it,
+    // so new entries have to start on a new line to be parsed separately from it
+    if ((journalFile.size() > 0) && journalFile.seek(journalFile.size() - 1) && (journalFile.read(1) != "\n"))
+        data.prepend('\n');
+
+    if (!journalFile.seek(journalFile.size())
+        || (journalFile.write(data) != data.size())
+        || !journalFile.flush())
+    {
+        LogMsg(tr("Failed to save RSS feed in '%1', Reason: %2").arg(journalPath.toString(), journalFile.errorString())
+               , Log::WARNING);
     }
 }
 
@@ -111,19 +202,61 @@ QVector<QVariantHash> RSS::Private::FeedSerializer::loadArticles(const QByteArra
             continue;
         }
 
-        const auto jsonObj = jsonVal.toObject();
-        auto varHash = jsonObj.toVariantHash();
-        // JSON object store DateTime as string so we need to convert it
-        varHash[Article::KeyDate] =
-                QDateTime::fromString(jsonObj.value(Article::KeyDate).toString(), Qt::RFC2822Date);
-
-        result.push_back(varHash);
+        result.push_back(articleFromJson(jsonVal.toObject()));
     }
 
-    std::sort(result.begin(), result.end(), [](const QVariantHash &left, const QVariantHash &right)
+    return result;
+}
+
+int RSS::Private::FeedSerializer::replayJournal(const QByteArray &data, const QString &url, QVector<QVariantHash> &articles)
+{
+    QHash<QString, qsizetype> articleIndexes;
+    articleIndexes.reserve(articles.size());
+    for (qsizetype i = 0; i < articles.size(); ++i)
+        articleIndexes.insert(articles[i].value(Article::KeyId).toString(), i);
+
+    int entryCount = 0;
+    const QList<QByteArray> lines = data.split('\n');
+    for (const QByteArray &line : lines)
     {
-        return (left.value(Article::KeyDate).toDateTime() > right.value(Article::KeyDate).toDateTime());
-    });
+        if (line.trimmed().isEmpty())
+            continue;
 
-    return result;
+        ++entryCount;
+
+        // The last entry can be incomplete if the application was terminated while writing it
+        const QJsonDocument jsonDoc = QJsonDocument::fromJson(line);
+        if (!jsonDoc.isObject())
+        {
+            LogMsg(tr("Couldn't load RSS article '%1#%2'. Invalid data format.")
+                   .arg(url, QString::number(entryCount)), Log::WARNING);
+            continue;
+        }
+
+        const QJsonObject entry = jsonDoc.object();
+        const QString entryType = entry.value(JOURNAL_KEY_TYPE).toString();
+        if (entryType == JOURNAL_TYPE_ADD)
+        {
+            const QVariantHash articleData = articleFromJson(entry.value(JOURNAL_KEY_ARTICLE).toObject());
+            const QString articleID = articleData.value(Article::KeyId).toString();
+            if (const auto indexIter = articleIndexes.constFind(articleID); indexIter != articleIndexes.cend())
+            {
+                articles[indexIter.value()] = articleData;
+            }
+            else
+            {
+                articleIndexes.insert(articleID, articles.size());
+                articles.append(articleData);
+            }
+        }
+        else if (entryType == JOURNAL_TYPE_READ)
+        {
+            // The article could be already removed as the oldest one
+            const qsizetype index = articleIndexes.value(entry.value(JOURNAL_KEY_ID).toString(), -1);
+            if (index >= 0)
+                articles[index][Article::KeyIsRead] = true;
+        }
+    }
+
+    return entryCount;
 }
@@ -34,6 +34,7 @@
 #include <QtContainerFwd>
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QVariantHash>
 
 #include "base/pathfwd.h"
@@ -48,13 +49,20 @@ namespace RSS::Private
     public:
         using QObject::QObject;
 
+        static Path journalFileName(const Path &dataFileName);
+
         void load(const Path &dataFileName, const QString &url);
+        // Stores all the articles and discards the journal
         void store(const Path &dataFileName, const QVector<QVariantHash> &articlesData);
+        // Appends the changes made since the last storing to the journal
+        void storeChanges(const Path &dataFileName, const QVector<QVariantHash> &newArticlesData
+                , const QStringList &readArticleIDs);
 
     signals:
-        void loadingFinished(const QVector<QVariantHash> &articles);
+        void loadingFinished(const QVector<QVariantHash> &articles, int journalEntryCount);
 
     private:
         QVector<QVariantHash> loadArticles(const QByteArray &data, const QString &url);
+        int replayJournal(const QByteArray &data, const QString &url, QVector<QVariantHash> &articles);
     };
 }
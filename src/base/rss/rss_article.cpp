@@ -30,11 +30,35 @@
 
 #include "rss_article.h"
 
+#include <QSet>
 #include <QVariant>
 
 #include "base/global.h"
 #include "rss_feed.h"
 
+namespace
+{
+    const int MIN_COMPRESSED_DESCRIPTION_LENGTH = 512;
+    const int MAX_SHARED_STRING_LENGTH = 128;
+    const int MAX_SHARED_STRING_COUNT = 65536;
+
+    // Values such as authors or categories are repeated across lots of articles
+    // so they share the same string data instead of keeping their own copies
+    QString sharedString(const QString &str)
+    {
+        if (str.isEmpty() || (str.size() > MAX_SHARED_STRING_LENGTH))
+            return str;
+
+        static QSet<QString> sharedStrings;
+        if (const auto iter = sharedStrings.constFind(str); iter != sharedStrings.cend())
+            return *iter;
+
+        if (sharedStrings.size() < MAX_SHARED_STRING_COUNT)
+            sharedStrings.insert(str);
+        return str;
+    }
+}
+
 using namespace RSS;
 
 const QString Article::KeyId = u"id"_s;
@@ -47,18 +71,42 @@ const QString Article::KeyLink = u"link"_s;
 const QString Article::KeyIsRead = u"isRead"_s;
 
 Article::Article(Feed *feed, const QVariantHash &varHash)
-    : QObject(feed)
-    , m_feed(feed)
-    , m_guid(varHash.value(KeyId).toString())
-    , m_date(varHash.value(KeyDate).toDateTime())
-    , m_title(varHash.value(KeyTitle).toString())
-    , m_author(varHash.value(KeyAuthor).toString())
-    , m_description(varHash.value(KeyDescription).toString())
-    , m_torrentURL(varHash.value(KeyTorrentURL).toString())
-    , m_link(varHash.value(KeyLink).toString())
-    , m_isRead(varHash.value(KeyIsRead, false).toBool())
-    , m_data(varHash)
+    : m_feed(feed)
 {
+    for (auto it = varHash.cbegin(); it != varHash.cend(); ++it)
+    {
+        const QString &key = it.key();
+        const QVariant &value = it.value();
+
+        if (key == KeyId)
+            m_guid = value.toString();
+        else if (key == KeyDate)
+            m_date = value.toDateTime();
+        else if (key == KeyTitle)
+            m_title = value.toString();
+        else if (key == KeyAuthor)
+            m_author = sharedString(value.toString());
+        else if (key == KeyDescription)
+            m_description = value.toString();
+        else if (key == KeyTorrentURL)
+            m_torrentURL = value.toString();
+        else if (key == KeyLink)
+            m_link = value.toString();
+        else if (key == KeyIsRead)
+            m_isRead = value.toBool();
+        else if (value.userType() == QMetaType::QString)
+            m_extraData.insert(sharedString(key), sharedString(value.toString()));
+        else
+            m_extraData.insert(sharedString(key), value);
+    }
+
+    if (m_description.size() >= MIN_COMPRESSED_DESCRIPTION_LENGTH)
+    {
+        m_compressedDescription = qCompress(m_description.toUtf8());
+        m_description.clear();
+    }
+
+    m_extraData.squeeze();
 }
 
 QString Article::guid() const
@@ -83,6 +131,9 @@ QString Article::author() const
 
 QString Article::description() const
 {
+    if (!m_compressedDescription.isEmpty())
+        return QString::fromUtf8(qUncompress(m_compressedDescription));
+
     return m_description;
 }
 
@@ -103,7 +154,24 @@ bool Article::isRead() const
 
 QVariantHash Article::data() const
 {
-    return m_data;
+    QVariantHash data = m_extraData;
+    data.insert(KeyId, m_guid);
+    if (m_date.isValid())
+        data.insert(KeyDate, m_date);
+    if (!m_title.isEmpty())
+        data.insert(KeyTitle, m_title);
+    if (!m_author.isEmpty())
+        data.insert(KeyAuthor, m_author);
+    if (const QString description = this->description(); !description.isEmpty())
+        data.insert(KeyDescription, description);
+    if (!m_torrentURL.isEmpty())
+        data.insert(KeyTorrentURL, m_torrentURL);
+    if (!m_link.isEmpty())
+        data.insert(KeyLink, m_link);
+    if (m_isRead)
+        data.insert(KeyIsRead, m_isRead);
+
+    return data;
 }
 
 void Article::markAsRead()
@@ -111,8 +179,7 @@ void Article::markAsRead()
     if (!m_isRead)
     {
         m_isRead = true;
-        m_data[KeyIsRead] = m_isRead;
-        emit read(this);
+        m_feed->handleArticleRead(this);
     }
 }
 
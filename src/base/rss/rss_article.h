@@ -30,8 +30,10 @@
 
 #pragma once
 
+#include <QtGlobal>
+#include <QByteArray>
 #include <QDateTime>
-#include <QObject>
+#include <QMetaType>
 #include <QString>
 #include <QVariantHash>
 
@@ -39,9 +41,11 @@ namespace RSS
 {
     class Feed;
 
-    class Article final : public QObject
+    // Articles are numerous so they are kept as compact as possible:
+    // known fields are stored as members, long descriptions are compressed
+    // and the full data is only materialized on demand
+    class Article final
     {
-        Q_OBJECT
         Q_DISABLE_COPY_MOVE(Article)
 
         friend class Feed;
@@ -73,9 +77,6 @@ namespace RSS
 
         static bool articleDateRecentThan(const Article *article, const QDateTime &date);
 
-    signals:
-        void read(Article *article = nullptr);
-
     private:
         Feed *m_feed = nullptr;
         QString m_guid;
@@ -83,9 +84,12 @@ namespace RSS
         QString m_title;
         QString m_author;
         QString m_description;
+        QByteArray m_compressedDescription;
         QString m_torrentURL;
         QString m_link;
         bool m_isRead = false;
-        QVariantHash m_data;
+        QVariantHash m_extraData;
     };
 }
+
+Q_DECLARE_METATYPE(RSS::Article *)
@@ -28,10 +28,12 @@
 
 #include "rss_autodownloader.h"
 
+#include <algorithm>
 #include <queue>
 
 #include <QDataStream>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
@@ -63,6 +65,8 @@ struct ProcessingJob
 
 const QString CONF_FOLDER_NAME = u"rss"_s;
 const QString RULES_FILE_NAME = u"download_rules.json"_s;
+// Articles are processed in batches limited by time so that the event loop isn't blocked
+const int PROCESSING_BATCH_TIME = 50; // milliseconds
 
 namespace
 {
@@ -183,6 +187,11 @@ QList<AutoDownloadRule> AutoDownloader::rules() const
     return m_rules;
 }
 
+AutoDownloadRuleStatistics AutoDownloader::ruleStatistics(const QString &ruleName) const
+{
+    return m_rulesStatistics.value(ruleName);
+}
+
 void AutoDownloader::setRule(const AutoDownloadRule &rule)
 {
     if (!hasRule(rule.name()))
@@ -215,6 +224,8 @@ bool AutoDownloader::renameRule(const QString &ruleName, const QString &newRuleN
     const auto index = m_rulesByName.take(ruleName);
     m_rules[index].setName(newRuleName);
     m_rulesByName.insert(newRuleName, index);
+    if (m_rulesStatistics.contains(ruleName))
+        m_rulesStatistics.insert(newRuleName, m_rulesStatistics.take(ruleName));
     m_dirty = true;
     store();
     emit ruleRenamed(newRuleName, ruleName);
@@ -235,6 +246,8 @@ void AutoDownloader::removeRule(const QString &ruleName)
         const AutoDownloadRule &rule = m_rules[i];
         m_rulesByName[rule.name()] = i;
     }
+    m_rulesStatistics.remove(ruleName);
+    updateRulesIndex();
 
     m_dirty = true;
     store();
@@ -350,10 +363,17 @@ void AutoDownloader::process()
     if (m_processingQueue.isEmpty()) // processing was disabled
         return;
 
-    processJob(m_processingQueue.takeFirst());
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+    do
+    {
+        processJob(m_processingQueue.takeFirst());
+    }
+    while (!m_processingQueue.isEmpty() && !batchTimer.hasExpired(PROCESSING_BATCH_TIME));
+
     if (!m_processingQueue.isEmpty())
     {
-        // Schedule to process the next torrent (if any)
+        // Schedule to process the next batch
         m_processingTimer->start();
     }
 }
@@ -395,6 +415,7 @@ void AutoDownloader::handleFeedURLChanged(Feed *feed, const QString &oldURL)
             m_dirty = true;
         }
     }
+    updateRulesIndex();
 
     for (const QSharedPointer<ProcessingJob> &job : asConst(m_processingQueue))
     {
@@ -438,6 +459,38 @@ void AutoDownloader::sortRules()
         const AutoDownloadRule &rule = m_rules[i];
         m_rulesByName[rule.name()] = i;
     }
+
+    updateRulesIndex();
+}
+
+void AutoDownloader::updateRulesIndex()
+{
+    m_rulesByFeedURL.clear();
+    m_rulesKeywords.clear();
+    m_keywordMatcher.clear();
+
+    m_rulesKeywords.resize(m_rules.size());
+    for (qsizetype i = 0; i < m_rules.size(); ++i)
+    {
+        const AutoDownloadRule &rule = m_rules[i];
+        if (!rule.isEnabled())
+            continue;
+
+        for (const QString &feedURL : asConst(rule.feedURLs()))
+        {
+            QVector<qsizetype> &feedRules = m_rulesByFeedURL[feedURL];
+            if (feedRules.isEmpty() || (feedRules.last() != i))
+                feedRules.append(i);
+        }
+
+        if (const std::optional<QStringList> keywords = rule.mustContainKeywords())
+        {
+            for (const QString &keyword : *keywords)
+                m_rulesKeywords[i].append(m_keywordMatcher.addKeyword(keyword));
+        }
+    }
+
+    m_keywordMatcher.build();
 }
 
 void AutoDownloader::addJobForArticle(const Article *article)
@@ -456,15 +509,35 @@ void AutoDownloader::addJobForArticle(const Article *article)
 
 void AutoDownloader::processJob(const QSharedPointer<ProcessingJob> &job)
 {
-    for (AutoDownloadRule &rule : m_rules)
+    const QVector<qsizetype> feedRules = m_rulesByFeedURL.value(job->feedURL);
+    if (feedRules.isEmpty())
+        return;
+
+    // All the keywords are searched at once, so the title is scanned only once regardless of rules count
+    const std::vector<bool> foundKeywords = m_keywordMatcher.findKeywords(job->articleData.value(Article::KeyTitle).toString());
+
+    for (const qsizetype ruleIndex : feedRules)
     {
-        if (!rule.isEnabled())
-            continue;
-        if (!rule.feedURLs().contains(job->feedURL))
+        AutoDownloadRule &rule = m_rules[ruleIndex];
+        AutoDownloadRuleStatistics &statistics = m_rulesStatistics[rule.name()];
+
+        const QVector<int> &ruleKeywords = m_rulesKeywords[ruleIndex];
+        if (!ruleKeywords.isEmpty() && std::none_of(ruleKeywords.cbegin(), ruleKeywords.cend()
+                , [&foundKeywords](const int keywordID) { return foundKeywords[keywordID]; }))
+        {
+            ++statistics.skippedCount;
             continue;
-        if (!rule.accepts(job->articleData))
+        }
+
+        QElapsedTimer evaluationTimer;
+        evaluationTimer.start();
+        const bool isAccepted = rule.accepts(job->articleData);
+        statistics.evaluationTime += (evaluationTimer.nsecsElapsed() / 1000);
+        ++statistics.evaluatedCount;
+        if (!isAccepted)
             continue;
 
+        ++statistics.acceptedCount;
         m_dirty = true;
         storeDeferred();
 
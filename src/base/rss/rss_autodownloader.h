@@ -35,10 +35,12 @@
 #include <QPointer>
 #include <QRegularExpression>
 #include <QSharedPointer>
+#include <QVector>
 
 #include "base/exceptions.h"
 #include "base/settingvalue.h"
 #include "base/utils/thread.h"
+#include "rss_keywordmatcher.h"
 
 class QThread;
 class QTimer;
@@ -61,6 +63,15 @@ namespace RSS
         using RuntimeError::RuntimeError;
     };
 
+    struct AutoDownloadRuleStatistics
+    {
+        // articles rejected by keywords prefilter without evaluating the rule
+        qint64 skippedCount = 0;
+        qint64 evaluatedCount = 0;
+        qint64 acceptedCount = 0;
+        qint64 evaluationTime = 0; // in microseconds
+    };
+
     class AutoDownloader final : public QObject
     {
         Q_OBJECT
@@ -93,6 +104,7 @@ namespace RSS
         bool hasRule(const QString &ruleName) const;
         AutoDownloadRule ruleByName(const QString &ruleName) const;
         QList<AutoDownloadRule> rules() const;
+        AutoDownloadRuleStatistics ruleStatistics(const QString &ruleName) const;
 
         void setRule(const AutoDownloadRule &rule);
         bool renameRule(const QString &ruleName, const QString &newRuleName);
@@ -119,6 +131,7 @@ namespace RSS
         void timerEvent(QTimerEvent *event) override;
         void setRule_impl(const AutoDownloadRule &rule);
         void sortRules();
+        void updateRulesIndex();
         void resetProcessingQueue();
         void startProcessing();
         void addJobForArticle(const Article *article);
@@ -144,6 +157,12 @@ namespace RSS
         AsyncFileStorage *m_fileStorage = nullptr;
         QList<AutoDownloadRule> m_rules;
         QHash<QString, qsizetype> m_rulesByName;
+        // Enabled rules applicable to articles of the feed, in the order of their priority
+        QHash<QString, QVector<qsizetype>> m_rulesByFeedURL;
+        // Keyword IDs of each rule, rule without keywords must always be evaluated
+        QVector<QVector<int>> m_rulesKeywords;
+        KeywordMatcher m_keywordMatcher;
+        QHash<QString, AutoDownloadRuleStatistics> m_rulesStatistics;
         QList<QSharedPointer<ProcessingJob>> m_processingQueue;
         QHash<QString, QSharedPointer<ProcessingJob>> m_waitingJobs;
         bool m_dirty = false;
@@ -407,6 +407,57 @@ bool AutoDownloadRule::matchesSmartEpisodeFilter(const QString &articleTitle) co
     return true;
 }
 
+std::optional<QStringList> AutoDownloadRule::mustContainKeywords() const
+{
+    if (m_dataPtr->useRegex || m_dataPtr->mustContain.isEmpty())
+        return std::nullopt;
+
+    const QRegularExpression whitespace {u"\\s+"_s};
+
+    // Each wildcard expression matches only if all its tokens match, so the longest
+    // literal part of its tokens is required for the expression to match
+    QStringList keywords;
+    keywords.reserve(m_dataPtr->mustContain.size());
+    for (const QString &expression : asConst(m_dataPtr->mustContain))
+    {
+        QString keyword;
+        for (const QString &wildcard : asConst(expression.split(whitespace, Qt::SkipEmptyParts)))
+        {
+            QString literal;
+            bool inBrackets = false;
+            for (const QChar c : wildcard)
+            {
+                if (inBrackets)
+                {
+                    inBrackets = (c != u']');
+                }
+                else if ((c == u'*') || (c == u'?') || (c == u'[') || (c == u'\\'))
+                {
+                    if (literal.size() > keyword.size())
+                        keyword = literal;
+                    literal.clear();
+                    inBrackets = (c == u'[');
+                }
+                else
+                {
+                    literal.append(c);
+                }
+            }
+
+            if (literal.size() > keyword.size())
+                keyword = literal;
+        }
+
+        // Expression without any literal part may match any title
+        if (keyword.isEmpty())
+            return std::nullopt;
+
+        keywords.append(keyword);
+    }
+
+    return keywords;
+}
+
 bool AutoDownloadRule::matches(const QVariantHash &articleData) const
 {
     const QDateTime articleDate {articleData[Article::KeyDate].toDateTime()};
@@ -87,6 +87,10 @@ namespace RSS
         BitTorrent::AddTorrentParams addTorrentParams() const;
         void setAddTorrentParams(BitTorrent::AddTorrentParams addTorrentParams);
 
+        // Returns the keywords at least one of which must be present in the title of matching article,
+        // or nothing if the rule can't be reduced to such keywords (e.g. uses regular expressions)
+        std::optional<QStringList> mustContainKeywords() const;
+
         bool matches(const QVariantHash &articleData) const;
         bool accepts(const QVariantHash &articleData);
 
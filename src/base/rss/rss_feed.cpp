@@ -34,6 +34,7 @@
 #include <utility>
 #include <vector>
 
+#include <QCryptographicHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -60,6 +61,8 @@ const QString KEY_LASTBUILDDATE = u"lastBuildDate"_s;
 const QString KEY_ISLOADING = u"isLoading"_s;
 const QString KEY_HASERROR = u"hasError"_s;
 const QString KEY_ARTICLES = u"articles"_s;
+// All the articles are stored again once the journal becomes bigger than that
+const int MIN_JOURNAL_COMPACTION_SIZE = 100;
 
 using namespace RSS;
 
@@ -87,7 +90,7 @@ Feed::Feed(const QUuid &uid, const QString &url, const QString &path, Session *s
     connect(m_serializer, &Private::FeedSerializer::loadingFinished, this, &Feed::handleArticleLoadFinished);
 
     m_parser = new Private::Parser(m_lastBuildDate);
-    m_parser->moveToThread(m_session->workingThread());
+    m_parser->moveToThread(m_session->parsingThread());
     connect(this, &Feed::destroyed, m_parser, &Private::Parser::deleteLater);
     connect(m_parser, &Private::Parser::finished, this, &Feed::handleParsingFinished);
 
@@ -107,6 +110,7 @@ Feed::~Feed()
 {
     store();
     emit aboutToBeDestroyed(this);
+    qDeleteAll(m_articles);
 }
 
 QList<Article *> Feed::articles() const
@@ -121,9 +125,9 @@ void Feed::markAsRead()
     {
         if (!article->isRead())
         {
-            article->disconnect(this);
-            article->markAsRead();
+            article->m_isRead = true;
             --m_unreadCount;
+            m_readArticleIDs.append(article->guid());
             emit articleRead(article);
         }
     }
@@ -144,12 +148,18 @@ void Feed::refresh()
         return;
     }
 
-    if (m_downloadHandler)
-        m_downloadHandler->cancel();
-
     // NOTE: Should we allow manually refreshing for disabled session?
 
-    m_downloadHandler = Net::DownloadManager::instance()->download(m_url, Preferences::instance()->useProxyForRSS());
+    m_session->enqueueFeedRefresh(this);
+}
+
+void Feed::startRefresh()
+{
+    Q_ASSERT(!m_downloadHandler);
+
+    const auto downloadRequest = Net::DownloadRequest(m_url).ifNoneMatch(m_eTag)
+            .ifModifiedSince(m_lastModified).priority(Net::DownloadPriority::Low);
+    m_downloadHandler = Net::DownloadManager::instance()->download(downloadRequest, Preferences::instance()->useProxyForRSS());
     connect(m_downloadHandler, &Net::DownloadHandler::finished, this, &Feed::handleDownloadFinished);
 
     if (!m_iconPath.exists())
@@ -220,6 +230,21 @@ void Feed::handleDownloadFinished(const Net::DownloadResult &result)
 
     if (result.status == Net::DownloadStatus::Success)
     {
+        const QByteArray dataHash = result.notModified
+                ? m_dataHash : QCryptographicHash::hash(result.data, QCryptographicHash::Md5);
+        if (result.notModified || (!m_dataHash.isEmpty() && (dataHash == m_dataHash)))
+        {
+            LogMsg(tr("RSS feed at '%1' is not modified since last update.").arg(result.url));
+            m_isLoading = false;
+            m_hasError = false;
+            emit stateChanged(this);
+            return;
+        }
+
+        m_eTag = result.eTag;
+        m_lastModified = result.lastModified;
+        m_dataHash = dataHash;
+
         LogMsg(tr("RSS feed at '%1' is successfully downloaded. Starting to parse it.")
                 .arg(result.url));
         // Parse the download RSS
@@ -243,6 +268,13 @@ void Feed::handleDownloadFinished(const Net::DownloadResult &result)
 void Feed::handleParsingFinished(const RSS::Private::ParsingResult &result)
 {
     m_hasError = !result.error.isEmpty();
+    if (m_hasError)
+    {
+        // Make sure the feed is parsed again next time even if its data isn't changed
+        m_eTag.clear();
+        m_lastModified = {};
+        m_dataHash.clear();
+    }
 
     if (!result.title.isEmpty() && (title() != result.title))
     {
@@ -294,18 +326,37 @@ void Feed::store()
     m_dirty = false;
     m_savingTimer.stop();
 
-    QVector<QVariantHash> articlesData;
-    articlesData.reserve(m_articles.size());
+    const Path path = m_session->dataFileStorage()->storageDir() / m_dataFileName;
+    const int changeCount = m_newArticlesData.size() + m_readArticleIDs.size();
+    if (m_needStoreAll || ((m_journalEntryCount + changeCount) > std::max<int>(m_articles.size(), MIN_JOURNAL_COMPACTION_SIZE)))
+    {
+        QVector<QVariantHash> articlesData;
+        articlesData.reserve(m_articles.size());
+
+        for (Article *article :asConst(m_articles))
+            articlesData.push_back(article->data());
 
-    for (Article *article :asConst(m_articles))
-        articlesData.push_back(article->data());
+        QMetaObject::invokeMethod(m_serializer, [articlesData, path, serializer = m_serializer]
+        {
+            serializer->store(path, articlesData);
+        });
 
-    QMetaObject::invokeMethod(m_serializer
-            , [articlesData, serializer = m_serializer
-                , path = (m_session->dataFileStorage()->storageDir() / m_dataFileName)]
+        m_journalEntryCount = 0;
+    }
+    else if (changeCount > 0)
     {
-        serializer->store(path, articlesData);
-    });
+        QMetaObject::invokeMethod(m_serializer
+                , [newArticlesData = m_newArticlesData, readArticleIDs = m_readArticleIDs, path, serializer = m_serializer]
+        {
+            serializer->storeChanges(path, newArticlesData, readArticleIDs);
+        });
+
+        m_journalEntryCount += changeCount;
+    }
+
+    m_newArticlesData.clear();
+    m_readArticleIDs.clear();
+    m_needStoreAll = false;
 }
 
 void Feed::storeDeferred()
@@ -329,11 +380,9 @@ bool Feed::addArticle(const QVariantHash &articleData)
     m_articles[article->guid()] = article;
     m_articlesByDate.insert(lowerBound, article);
     if (!article->isRead())
-    {
         increaseUnreadCount();
-        connect(article, &Article::read, this, &Feed::handleArticleRead);
-    }
 
+    m_newArticlesData.append(article->data());
     m_dirty = true;
     emit newArticle(article);
 
@@ -379,6 +428,7 @@ void Feed::downloadIcon()
     const auto iconUrl = u"%1://%2/favicon.ico"_s.arg(url.scheme(), url.host());
     Net::DownloadManager::instance()->download(
             Net::DownloadRequest(iconUrl).saveToFile(true).destFileName(m_iconPath)
+                    .priority(Net::DownloadPriority::Low).useCache(true)
             , Preferences::instance()->useProxyForRSS(), this, &Feed::handleIconDownloadFinished);
 }
 
@@ -457,6 +507,14 @@ Path Feed::iconPath() const
 
 void Feed::setURL(const QString &url)
 {
+    // Data being downloaded from old URL is no longer of interest
+    if (m_downloadHandler)
+        m_downloadHandler->cancel();
+
+    m_eTag.clear();
+    m_lastModified = {};
+    m_dataHash.clear();
+
     const QString oldURL = m_url;
     m_url = url;
     emit urlChanged(oldURL);
@@ -501,15 +559,15 @@ void Feed::handleSessionProcessingEnabledChanged(const bool enabled)
 
 void Feed::handleArticleRead(Article *article)
 {
-    article->disconnect(this);
     decreaseUnreadCount();
     emit articleRead(article);
     // will be stored deferred
+    m_readArticleIDs.append(article->guid());
     m_dirty = true;
     storeDeferred();
 }
 
-void Feed::handleArticleLoadFinished(QVector<QVariantHash> articles)
+void Feed::handleArticleLoadFinished(QVector<QVariantHash> articles, const int journalEntryCount)
 {
     Q_ASSERT(m_articles.isEmpty());
     Q_ASSERT(m_unreadCount == 0);
@@ -532,10 +590,7 @@ void Feed::handleArticleLoadFinished(QVector<QVariantHash> articles)
         m_articles[articleID] = article;
         m_articlesByDate.append(article);
         if (!article->isRead())
-        {
             ++m_unreadCount;
-            connect(article, &Article::read, this, &Feed::handleArticleRead);
-        }
 
         emit newArticle(article);
     }
@@ -543,6 +598,15 @@ void Feed::handleArticleLoadFinished(QVector<QVariantHash> articles)
     if (m_unreadCount > 0)
         emit unreadCountChanged(this);
 
+    // Compact the journal left since the previous run
+    m_journalEntryCount = journalEntryCount;
+    if (m_journalEntryCount > std::max<int>(m_articles.size(), MIN_JOURNAL_COMPACTION_SIZE))
+    {
+        m_needStoreAll = true;
+        m_dirty = true;
+        storeDeferred();
+    }
+
     m_isInitialized = true;
     emit stateChanged(this);
 
@@ -557,7 +621,9 @@ void Feed::cleanup()
 {
     m_dirty = false;
     m_savingTimer.stop();
-    Utils::Fs::removeFile(m_session->dataFileStorage()->storageDir() / m_dataFileName);
+    const Path dataFilePath = m_session->dataFileStorage()->storageDir() / m_dataFileName;
+    Utils::Fs::removeFile(dataFilePath);
+    Utils::Fs::removeFile(Private::FeedSerializer::journalFileName(dataFilePath));
     Utils::Fs::removeFile(m_iconPath);
 }
 
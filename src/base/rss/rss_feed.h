@@ -32,10 +32,14 @@
 
 #include <QtContainerFwd>
 #include <QBasicTimer>
+#include <QByteArray>
+#include <QDateTime>
 #include <QHash>
 #include <QList>
+#include <QStringList>
 #include <QUuid>
 #include <QVariantHash>
+#include <QVector>
 
 #include "base/path.h"
 #include "rss_item.h"
@@ -65,6 +69,7 @@ namespace RSS
         Q_OBJECT
         Q_DISABLE_COPY_MOVE(Feed)
 
+        friend class Article;
         friend class Session;
 
         Feed(const QUuid &uid, const QString &url, const QString &path, Session *session);
@@ -99,19 +104,20 @@ namespace RSS
         void handleIconDownloadFinished(const Net::DownloadResult &result);
         void handleDownloadFinished(const Net::DownloadResult &result);
         void handleParsingFinished(const Private::ParsingResult &result);
-        void handleArticleRead(Article *article);
-        void handleArticleLoadFinished(QVector<QVariantHash> articles);
+        void handleArticleLoadFinished(QVector<QVariantHash> articles, int journalEntryCount);
 
     private:
         void timerEvent(QTimerEvent *event) override;
         void cleanup() override;
         void load();
+        void startRefresh();
         void store();
         void storeDeferred();
         bool addArticle(const QVariantHash &articleData);
         void removeOldestArticle();
         void increaseUnreadCount();
         void decreaseUnreadCount();
+        void handleArticleRead(Article *article);
         void downloadIcon();
         int updateArticles(const QList<QVariantHash> &loadedArticles);
         void setURL(const QString &url);
@@ -127,6 +133,10 @@ namespace RSS
         bool m_isLoading = false;
         bool m_isInitialized = false;
         bool m_pendingRefresh = false;
+        // Validators of the last successfully parsed data, used to skip unchanged feed
+        QString m_eTag;
+        QDateTime m_lastModified;
+        QByteArray m_dataHash;
         QHash<QString, Article *> m_articles;
         QList<Article *> m_articlesByDate;
         int m_unreadCount = 0;
@@ -134,6 +144,12 @@ namespace RSS
         Path m_dataFileName;
         QBasicTimer m_savingTimer;
         bool m_dirty = false;
+        // Changes which aren't stored yet, they are appended to the journal
+        // unless all the articles need to be stored
+        QVector<QVariantHash> m_newArticlesData;
+        QStringList m_readArticleIDs;
+        bool m_needStoreAll = false;
+        int m_journalEntryCount = 0;
         Net::DownloadHandler *m_downloadHandler = nullptr;
     };
 }
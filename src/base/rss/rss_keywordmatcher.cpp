@@ -0,0 +1,161 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "rss_keywordmatcher.h"
+
+#include <queue>
+
+#include <QChar>
+
+namespace
+{
+    // Simple (one-to-one) case folding is used for both keywords and text
+    // so that they are always folded the same way
+    QString foldCase(const QStringView str)
+    {
+        QString result;
+        result.reserve(str.size());
+        for (const QChar c : str)
+            result.append(c.toCaseFolded());
+        return result;
+    }
+}
+
+using namespace RSS;
+
+KeywordMatcher::KeywordMatcher()
+    : m_nodes(1)
+{
+}
+
+int KeywordMatcher::addKeyword(const QString &keyword)
+{
+    Q_ASSERT(!keyword.isEmpty());
+
+    const QString foldedKeyword = foldCase(keyword);
+    if (const auto idIter = m_keywordIDs.constFind(foldedKeyword); idIter != m_keywordIDs.cend())
+        return idIter.value();
+
+    int nodeIndex = 0;
+    for (const QChar c : foldedKeyword)
+    {
+        int childIndex = m_nodes[nodeIndex].children.value(c, -1);
+        if (childIndex < 0)
+        {
+            childIndex = static_cast<int>(m_nodes.size());
+            m_nodes[nodeIndex].children.insert(c, childIndex);
+            m_nodes.emplace_back();
+        }
+
+        nodeIndex = childIndex;
+    }
+
+    const int keywordID = m_keywordIDs.size();
+    m_keywordIDs.insert(foldedKeyword, keywordID);
+    m_nodes[nodeIndex].keywordIDs.append(keywordID);
+    m_isBuilt = false;
+    return keywordID;
+}
+
+int KeywordMatcher::keywordCount() const
+{
+    return m_keywordIDs.size();
+}
+
+void KeywordMatcher::clear()
+{
+    m_nodes.assign(1, {});
+    m_keywordIDs.clear();
+    m_isBuilt = true;
+}
+
+void KeywordMatcher::build()
+{
+    if (m_isBuilt)
+        return;
+
+    // Failure links are computed in breadth-first order so the link
+    // of the parent node is always known before its children are visited
+    std::queue<int> nodesQueue;
+    for (const int childIndex : m_nodes[0].children)
+    {
+        m_nodes[childIndex].failure = 0;
+        nodesQueue.push(childIndex);
+    }
+
+    while (!nodesQueue.empty())
+    {
+        const int nodeIndex = nodesQueue.front();
+        nodesQueue.pop();
+
+        for (auto childIter = m_nodes[nodeIndex].children.cbegin(); childIter != m_nodes[nodeIndex].children.cend(); ++childIter)
+        {
+            const int childIndex = childIter.value();
+            const int failure = nextNode(m_nodes[nodeIndex].failure, childIter.key());
+            m_nodes[childIndex].failure = failure;
+            // Keywords which are suffixes of the current one are found at the same position
+            m_nodes[childIndex].keywordIDs.append(m_nodes[failure].keywordIDs);
+            nodesQueue.push(childIndex);
+        }
+    }
+
+    m_isBuilt = true;
+}
+
+std::vector<bool> KeywordMatcher::findKeywords(const QStringView text) const
+{
+    Q_ASSERT(m_isBuilt);
+
+    std::vector<bool> result(m_keywordIDs.size(), false);
+    if (m_keywordIDs.isEmpty())
+        return result;
+
+    int nodeIndex = 0;
+    for (const QChar c : text)
+    {
+        nodeIndex = nextNode(nodeIndex, c.toCaseFolded());
+        for (const int keywordID : m_nodes[nodeIndex].keywordIDs)
+            result[keywordID] = true;
+    }
+
+    return result;
+}
+
+int KeywordMatcher::nextNode(int nodeIndex, const QChar c) const
+{
+    while (true)
+    {
+        const int childIndex = m_nodes[nodeIndex].children.value(c, -1);
+        if (childIndex >= 0)
+            return childIndex;
+        if (nodeIndex == 0)
+            return 0;
+
+        nodeIndex = m_nodes[nodeIndex].failure;
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+namespace RSS
+{
+    // Finds all the occurrences of multiple keywords in a single pass over the text
+    // using Aho-Corasick automaton. Matching is case insensitive.
+    class KeywordMatcher
+    {
+    public:
+        KeywordMatcher();
+
+        // Returns ID of the keyword which is its index in the flags returned by findKeywords()
+        int addKeyword(const QString &keyword);
+        int keywordCount() const;
+        void clear();
+
+        // Must be called after adding keywords and before finding them
+        void build();
+        std::vector<bool> findKeywords(QStringView text) const;
+
+    private:
+        struct Node
+        {
+            QHash<QChar, int> children;
+            int failure = 0;
+            QVector<int> keywordIDs;
+        };
+
+        int nextNode(int nodeIndex, QChar c) const;
+
+        std::vector<Node> m_nodes;
+        QHash<QString, int> m_keywordIDs;
+        bool m_isBuilt = true;
+    };
+}
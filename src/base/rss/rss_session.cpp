@@ -30,6 +30,7 @@
 
 #include "rss_session.h"
 
+#include <algorithm>
 #include <chrono>
 
 #include <QDebug>
@@ -46,6 +47,7 @@
 #include "../settingsstorage.h"
 #include "../utils/fs.h"
 #include "../utils/io.h"
+#include "../utils/random.h"
 #include "rss_article.h"
 #include "rss_feed.h"
 #include "rss_folder.h"
@@ -54,6 +56,10 @@
 const QString CONF_FOLDER_NAME = u"rss"_s;
 const QString DATA_FOLDER_NAME = u"rss/articles"_s;
 const QString FEEDS_FILE_NAME = u"feeds.json"_s;
+const int MAX_PARSING_THREADS = 4;
+const int MAX_ACTIVE_REFRESHES = 8;
+// Periodic refreshes are spread over a small window so that feeds aren't requested all at once
+const std::chrono::milliseconds MAX_REFRESH_JITTER = std::chrono::minutes(5);
 
 using namespace RSS;
 
@@ -89,13 +95,23 @@ Session::Session()
     m_itemsByPath.insert(u""_s, new Folder); // root folder
 
     m_workingThread->start();
+
+    const int parsingThreadCount = std::clamp(QThread::idealThreadCount(), 1, MAX_PARSING_THREADS);
+    m_parsingThreads.reserve(parsingThreadCount);
+    for (int i = 0; i < parsingThreadCount; ++i)
+    {
+        auto &thread = m_parsingThreads.emplace_back(new QThread);
+        thread->setObjectName(u"RSS parsing thread %1"_s.arg(i + 1));
+        thread->start();
+    }
+
     load();
 
-    connect(&m_refreshTimer, &QTimer::timeout, this, &Session::refresh);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &Session::refreshPeriodically);
     if (isProcessingEnabled())
     {
         m_refreshTimer.start(std::chrono::minutes(refreshInterval()));
-        refresh();
+        refreshPeriodically();
     }
 
     // Remove legacy/corrupted settings
@@ -125,6 +141,8 @@ Session::~Session()
     qDebug() << "Deleting RSS Session...";
 
     //store();
+    m_pendingRefreshes.clear();
+    m_pendingRefreshHosts.clear();
     delete m_itemsByPath[u""_s]; // deleting root folder
 
     qDebug() << "RSS Session deleted.";
@@ -440,7 +458,7 @@ void Session::addItem(Item *item, Folder *destFolder)
     {
         connect(feed, &Feed::titleChanged, this, &Session::handleFeedTitleChanged);
         connect(feed, &Feed::iconLoaded, this, &Session::feedIconLoaded);
-        connect(feed, &Feed::stateChanged, this, &Session::feedStateChanged);
+        connect(feed, &Feed::stateChanged, this, &Session::handleFeedStateChanged);
         connect(feed, &Feed::urlChanged, this, [this, feed](const QString &oldURL)
         {
             if (feed->name() == oldURL)
@@ -475,7 +493,7 @@ void Session::setProcessingEnabled(const bool enabled)
         if (enabled)
         {
             m_refreshTimer.start(std::chrono::minutes(refreshInterval()));
-            refresh();
+            refreshPeriodically();
         }
         else
         {
@@ -530,6 +548,14 @@ QThread *Session::workingThread() const
     return m_workingThread.get();
 }
 
+QThread *Session::parsingThread()
+{
+    // Each feed sticks to one thread so its own data is still parsed sequentially
+    QThread *thread = m_parsingThreads[m_nextParsingThreadIndex].get();
+    m_nextParsingThreadIndex = (m_nextParsingThreadIndex + 1) % m_parsingThreads.size();
+    return thread;
+}
+
 void Session::handleItemAboutToBeDestroyed(Item *item)
 {
     m_itemsByPath.remove(item->path());
@@ -538,9 +564,18 @@ void Session::handleItemAboutToBeDestroyed(Item *item)
     {
         m_feedsByUID.remove(feed->uid());
         m_feedsByURL.remove(feed->url());
+        finishFeedRefresh(feed);
     }
 }
 
+void Session::handleFeedStateChanged(Feed *feed)
+{
+    if (!feed->isLoading())
+        finishFeedRefresh(feed);
+
+    emit feedStateChanged(feed);
+}
+
 void Session::handleFeedTitleChanged(Feed *feed)
 {
     if (feed->name() == feed->url())
@@ -579,3 +614,88 @@ void Session::refresh()
     // NOTE: Should we allow manually refreshing for disabled session?
     rootFolder()->refresh();
 }
+
+void Session::refreshPeriodically()
+{
+    const auto maxJitter = std::min<std::chrono::milliseconds>(std::chrono::minutes(refreshInterval()) / 10, MAX_REFRESH_JITTER);
+    for (Feed *feed : asConst(feeds()))
+    {
+        const auto delay = std::chrono::milliseconds(Utils::Random::rand(0, static_cast<uint32_t>(maxJitter.count())));
+        QTimer::singleShot(delay, feed, [this, feed]
+        {
+            if (isProcessingEnabled())
+                feed->refresh();
+        });
+    }
+}
+
+void Session::enqueueFeedRefresh(Feed *feed)
+{
+    if (m_activeRefreshes.contains(feed))
+        return;
+
+    const auto serviceID = Net::ServiceID::fromURL(feed->url());
+    QList<QPointer<Feed>> &pendingFeeds = m_pendingRefreshes[serviceID];
+    if (pendingFeeds.contains(feed))
+        return;
+
+    pendingFeeds.append(feed);
+    if (!m_pendingRefreshHosts.contains(serviceID))
+        m_pendingRefreshHosts.append(serviceID);
+
+    processRefreshQueue();
+}
+
+void Session::finishFeedRefresh(Feed *feed)
+{
+    const auto iter = m_activeRefreshes.find(feed);
+    if (iter == m_activeRefreshes.end())
+        return;
+
+    m_busyRefreshHosts.remove(iter.value());
+    m_activeRefreshes.erase(iter);
+    processRefreshQueue();
+}
+
+void Session::processRefreshQueue()
+{
+    // Hosts are served in round-robin fashion, one feed at a time each,
+    // so a host with lots of feeds doesn't delay refreshing the others
+    QList<QPointer<Feed>> feedsToRefresh;
+    for (qsizetype i = 0; i < m_pendingRefreshHosts.size();)
+    {
+        if (m_activeRefreshes.size() >= MAX_ACTIVE_REFRESHES)
+            break;
+
+        const Net::ServiceID serviceID = m_pendingRefreshHosts[i];
+        if (m_busyRefreshHosts.contains(serviceID))
+        {
+            ++i;
+            continue;
+        }
+
+        QList<QPointer<Feed>> &pendingFeeds = m_pendingRefreshes[serviceID];
+        Feed *feed = nullptr;
+        while (!feed && !pendingFeeds.isEmpty())
+            feed = pendingFeeds.takeFirst();
+
+        m_pendingRefreshHosts.removeAt(i);
+        if (pendingFeeds.isEmpty())
+            m_pendingRefreshes.remove(serviceID);
+        else
+            m_pendingRefreshHosts.append(serviceID); // host is busy now so it will be skipped during this pass
+
+        if (feed)
+        {
+            m_activeRefreshes.insert(feed, serviceID);
+            m_busyRefreshHosts.insert(serviceID);
+            feedsToRefresh.append(feed);
+        }
+    }
+
+    for (const QPointer<Feed> &feed : asConst(feedsToRefresh))
+    {
+        if (feed)
+            feed->startRefresh();
+    }
+}
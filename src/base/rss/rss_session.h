@@ -68,12 +68,17 @@
  * 3.   Feed is JSON object (keys are property names, values are property values; 'uid' and 'url' are required)
  */
 
+#include <vector>
+
 #include <QHash>
+#include <QList>
 #include <QObject>
 #include <QPointer>
+#include <QSet>
 #include <QTimer>
 
 #include "base/3rdparty/expected.hpp"
+#include "base/net/downloadmanager.h"
 #include "base/settingvalue.h"
 #include "base/utils/thread.h"
 
@@ -94,6 +99,7 @@ namespace RSS
         Q_DISABLE_COPY_MOVE(Session)
 
         friend class ::Application;
+        friend class Feed;
 
         Session();
         ~Session() override;
@@ -105,6 +111,7 @@ namespace RSS
         void setProcessingEnabled(bool enabled);
 
         QThread *workingThread() const;
+        QThread *parsingThread();
         AsyncFileStorage *confFileStorage() const;
         AsyncFileStorage *dataFileStorage() const;
 
@@ -145,6 +152,8 @@ namespace RSS
     private slots:
         void handleItemAboutToBeDestroyed(Item *item);
         void handleFeedTitleChanged(Feed *feed);
+        void handleFeedStateChanged(Feed *feed);
+        void refreshPeriodically();
 
     private:
         QUuid generateUID() const;
@@ -156,6 +165,9 @@ namespace RSS
         Folder *addSubfolder(const QString &name, Folder *parentFolder);
         Feed *addFeedToFolder(const QUuid &uid, const QString &url, const QString &name, Folder *parentFolder);
         void addItem(Item *item, Folder *destFolder);
+        void enqueueFeedRefresh(Feed *feed);
+        void finishFeedRefresh(Feed *feed);
+        void processRefreshQueue();
 
         static QPointer<Session> m_instance;
 
@@ -163,11 +175,18 @@ namespace RSS
         CachedSettingValue<int> m_storeRefreshInterval;
         CachedSettingValue<int> m_storeMaxArticlesPerFeed;
         Utils::Thread::UniquePtr m_workingThread;
+        std::vector<Utils::Thread::UniquePtr> m_parsingThreads;
+        std::size_t m_nextParsingThreadIndex = 0;
         AsyncFileStorage *m_confFileStorage = nullptr;
         AsyncFileStorage *m_dataFileStorage = nullptr;
         QTimer m_refreshTimer;
         QHash<QString, Item *> m_itemsByPath;
         QHash<QUuid, Feed *> m_feedsByUID;
         QHash<QString, Feed *> m_feedsByURL;
+        // Feeds waiting for refresh grouped by host, and hosts in the order they should be served
+        QHash<Net::ServiceID, QList<QPointer<Feed>>> m_pendingRefreshes;
+        QList<Net::ServiceID> m_pendingRefreshHosts;
+        QHash<Feed *, Net::ServiceID> m_activeRefreshes;
+        QSet<Net::ServiceID> m_busyRefreshHosts;
     };
 }
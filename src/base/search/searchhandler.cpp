@@ -32,15 +32,15 @@
 #include <chrono>
 
 #include <QMetaObject>
-#include <QProcess>
 #include <QTimer>
 #include <QVector>
 
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/magneturi.h"
 #include "base/global.h"
-#include "base/path.h"
-#include "base/utils/foreignapps.h"
-#include "base/utils/fs.h"
+#include "base/utils/bytearray.h"
 #include "searchpluginmanager.h"
+#include "searchworker.h"
 
 using namespace std::chrono_literals;
 
@@ -57,6 +57,19 @@ namespace
         PL_DESC_LINK,
         NB_PLUGIN_COLUMNS
     };
+
+    // Different plugins (or different pages of the same site) often return the same torrent
+    QString resultKey(const SearchResult &result)
+    {
+        if (result.fileUrl.startsWith(u"magnet:", Qt::CaseInsensitive))
+        {
+            const BitTorrent::MagnetUri magnetUri {result.fileUrl};
+            if (magnetUri.isValid())
+                return magnetUri.infoHash().toTorrentID().toString();
+        }
+
+        return result.fileUrl;
+    }
 }
 
 SearchHandler::SearchHandler(const QString &pattern, const QString &category, const QStringList &usedPlugins, SearchPluginManager *manager)
@@ -65,122 +78,134 @@ SearchHandler::SearchHandler(const QString &pattern, const QString &category, co
     , m_category {category}
     , m_usedPlugins {usedPlugins}
     , m_manager {manager}
-    , m_searchProcess {new QProcess {this}}
     , m_searchTimeout {new QTimer {this}}
 {
-    // Load environment variables (proxy)
-    m_searchProcess->setEnvironment(QProcess::systemEnvironment());
-
-    const QStringList params
-    {
-        Utils::ForeignApps::PYTHON_ISOLATE_MODE_FLAG,
-        (SearchPluginManager::engineLocation() / Path(u"nova2.py"_s)).toString(),
-        m_usedPlugins.join(u','),
-        m_category
-    };
-
-    // Launch search
-    m_searchProcess->setProgram(Utils::ForeignApps::pythonInfo().executableName);
-    m_searchProcess->setArguments(params + m_pattern.split(u' '));
-
-    connect(m_searchProcess, &QProcess::errorOccurred, this, &SearchHandler::processFailed);
-    connect(m_searchProcess, &QProcess::readyReadStandardOutput, this, &SearchHandler::readSearchOutput);
-    connect(m_searchProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished)
-            , this, &SearchHandler::processFinished);
-
     m_searchTimeout->setSingleShot(true);
     connect(m_searchTimeout, &QTimer::timeout, this, &SearchHandler::cancelSearch);
-    m_searchTimeout->start(3min);
 
     // deferred start allows clients to handle starting-related signals
-    QMetaObject::invokeMethod(this, [this]() { m_searchProcess->start(QIODevice::ReadOnly); }
+    QMetaObject::invokeMethod(this, [this]() { m_manager->enqueueSearch(this); }
         , Qt::QueuedConnection);
 }
 
+SearchHandler::~SearchHandler()
+{
+    // worker remains busy until it confirms cancellation
+    if (m_worker)
+        m_worker->cancelSearch();
+}
+
 bool SearchHandler::isActive() const
 {
-    return (m_searchProcess->state() != QProcess::NotRunning);
+    return m_isActive;
 }
 
 void SearchHandler::cancelSearch()
 {
-    if ((m_searchProcess->state() == QProcess::NotRunning) || m_searchCancelled)
+    if (!m_isActive || m_searchCancelled)
         return;
 
-#ifdef Q_OS_WIN
-    m_searchProcess->kill();
-#else
-    m_searchProcess->terminate();
-#endif
     m_searchCancelled = true;
     m_searchTimeout->stop();
+
+    if (m_worker)
+    {
+        m_worker->cancelSearch();
+    }
+    else
+    {
+        // search is still waiting for free worker
+        m_isActive = false;
+        QMetaObject::invokeMethod(this, [this]() { emit searchFinished(true); }
+            , Qt::QueuedConnection);
+    }
 }
 
-// Slot called when QProcess is Finished
-// QProcess can be finished for 3 reasons:
-// Error | Stopped by user | Finished normally
-void SearchHandler::processFinished(const int exitcode)
+void SearchHandler::startSearch(SearchWorker *worker)
 {
+    m_worker = worker;
+    connect(worker, &SearchWorker::searchResultsReceived, this, &SearchHandler::processSearchResults);
+    connect(worker, &SearchWorker::searchFinished, this, &SearchHandler::handleSearchFinished);
+    connect(worker, &SearchWorker::searchFailed, this, &SearchHandler::handleSearchFailed);
+    worker->search(m_usedPlugins, m_category, m_pattern);
+    m_searchTimeout->start(3min);
+}
+
+void SearchHandler::failSearch()
+{
+    m_isActive = false;
+    emit searchFailed();
+}
+
+void SearchHandler::finishSearch()
+{
+    m_worker->disconnect(this);
+    m_worker = nullptr;
+    m_isActive = false;
     m_searchTimeout->stop();
+}
 
+void SearchHandler::handleSearchFinished(const bool cancelled)
+{
+    finishSearch();
+    emit searchFinished(m_searchCancelled || cancelled);
+}
+
+void SearchHandler::handleSearchFailed()
+{
+    finishSearch();
     if (m_searchCancelled)
         emit searchFinished(true);
-    else if ((m_searchProcess->exitStatus() == QProcess::NormalExit) && (exitcode == 0))
-        emit searchFinished(false);
     else
         emit searchFailed();
 }
 
-// search QProcess return output as soon as it gets new
-// stuff to read. We split it into lines and parse each
-// line to SearchResult calling parseSearchResult().
-void SearchHandler::readSearchOutput()
+// Search worker provides output as soon as it gets new stuff.
+// We parse each line to SearchResult calling parseSearchResult()
+// and drop the results which have already been received.
+void SearchHandler::processSearchResults(const QByteArray &data)
 {
-    QByteArray output = m_searchProcess->readAllStandardOutput();
-    output.replace('\r', "");
-
-    QList<QByteArray> lines = output.split('\n');
-    if (!m_searchResultLineTruncated.isEmpty())
-        lines.prepend(m_searchResultLineTruncated + lines.takeFirst());
-    m_searchResultLineTruncated = lines.takeLast().trimmed();
+    const QVector<QByteArray> lines = Utils::ByteArray::splitToViews(data, "\n", Qt::SkipEmptyParts);
 
     QVector<SearchResult> searchResultList;
     searchResultList.reserve(lines.size());
 
-    for (const QByteArray &line : asConst(lines))
+    for (const QByteArray &line : lines)
     {
         SearchResult searchResult;
-        if (parseSearchResult(QString::fromUtf8(line), searchResult))
-            searchResultList << searchResult;
+        if (!parseSearchResult(line, searchResult))
+            continue;
+
+        const QString key = resultKey(searchResult);
+        if (m_resultKeys.contains(key))
+            continue;
+
+        m_resultKeys.insert(key);
+        searchResultList << searchResult;
     }
 
     if (!searchResultList.isEmpty())
     {
-        for (const SearchResult &result : searchResultList)
+        m_results.reserve(m_results.size() + searchResultList.size());
+        for (const SearchResult &result : asConst(searchResultList))
             m_results.append(result);
         emit newSearchResults(searchResultList);
     }
 }
 
-void SearchHandler::processFailed()
-{
-    if (!m_searchCancelled)
-        emit searchFailed();
-}
-
 // Parse one line of search results list
 // Line is in the following form:
 // file url | file name | file size | nb seeds | nb leechers | Search engine url
-bool SearchHandler::parseSearchResult(const QStringView line, SearchResult &searchResult)
+bool SearchHandler::parseSearchResult(const QByteArray &line, SearchResult &searchResult)
 {
-    const QList<QStringView> parts = line.split(u'|');
+    const QVector<QByteArray> parts = Utils::ByteArray::splitToViews(line, "|");
     const int nbFields = parts.size();
 
     if (nbFields < (NB_PLUGIN_COLUMNS - 1)) return false; // -1 because desc_link is optional
 
     searchResult = SearchResult();
-    searchResult.fileUrl = parts.at(PL_DL_LINK).trimmed().toString(); // download URL
-    searchResult.fileName = parts.at(PL_NAME).trimmed().toString(); // Name
+    searchResult.fileUrl = QString::fromUtf8(parts.at(PL_DL_LINK).trimmed()); // download URL
+    searchResult.fileName = QString::fromUtf8(parts.at(PL_NAME).trimmed()); // Name
     searchResult.fileSize = parts.at(PL_SIZE).trimmed().toLongLong(); // Size
 
     bool ok = false;
@@ -193,9 +218,9 @@ bool SearchHandler::parseSearchResult(const QStringView line, SearchResult &sear
     if (!ok || (searchResult.nbLeechers < 0))
         searchResult.nbLeechers = -1;
 
-    searchResult.siteUrl = parts.at(PL_ENGINE_URL).trimmed().toString(); // Search site URL
+    searchResult.siteUrl = QString::fromUtf8(parts.at(PL_ENGINE_URL).trimmed()); // Search site URL
     if (nbFields == NB_PLUGIN_COLUMNS)
-        searchResult.descrLink = parts.at(PL_DESC_LINK).trimmed().toString(); // Description Link
+        searchResult.descrLink = QString::fromUtf8(parts.at(PL_DESC_LINK).trimmed()); // Description Link
 
     return true;
 }
@@ -29,13 +29,13 @@
 
 #pragma once
 
-#include <QByteArray>
 #include <QList>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
 #include <QString>
 #include <QtContainerFwd>
 
-class QProcess;
 class QTimer;
 
 struct SearchResult
@@ -50,6 +50,7 @@ struct SearchResult
 };
 
 class SearchPluginManager;
+class SearchWorker;
 
 class SearchHandler : public QObject
 {
@@ -62,6 +63,8 @@ class SearchHandler : public QObject
                   , const QStringList &usedPlugins, SearchPluginManager *manager);
 
 public:
+    ~SearchHandler() override;
+
     bool isActive() const;
     QString pattern() const;
     SearchPluginManager *manager() const;
@@ -75,18 +78,22 @@ signals:
     void newSearchResults(const QVector<SearchResult> &results);
 
 private:
-    void readSearchOutput();
-    void processFailed();
-    void processFinished(int exitcode);
-    bool parseSearchResult(QStringView line, SearchResult &searchResult);
+    void startSearch(SearchWorker *worker);
+    void failSearch();
+    void finishSearch();
+    void processSearchResults(const QByteArray &data);
+    void handleSearchFinished(bool cancelled);
+    void handleSearchFailed();
+    bool parseSearchResult(const QByteArray &line, SearchResult &searchResult);
 
     const QString m_pattern;
     const QString m_category;
     const QStringList m_usedPlugins;
     SearchPluginManager *m_manager = nullptr;
-    QProcess *m_searchProcess = nullptr;
+    QPointer<SearchWorker> m_worker;
     QTimer *m_searchTimeout = nullptr;
-    QByteArray m_searchResultLineTruncated;
+    bool m_isActive = true;
     bool m_searchCancelled = false;
     QList<SearchResult> m_results;
+    QSet<QString> m_resultKeys;
 };
@@ -38,7 +38,6 @@
 #include <QDomNode>
 #include <QFile>
 #include <QPointer>
-#include <QProcess>
 #include <QUrl>
 
 #include "base/global.h"
@@ -48,13 +47,15 @@
 #include "base/preferences.h"
 #include "base/profile.h"
 #include "base/utils/bytearray.h"
-#include "base/utils/foreignapps.h"
 #include "base/utils/fs.h"
 #include "searchdownloadhandler.h"
 #include "searchhandler.h"
+#include "searchworker.h"
 
 namespace
 {
+    const int MAX_SEARCH_WORKERS = 3;
+
     void clearPythonCache(const Path &path)
     {
         // remove python cache artifacts in `path` and subdirs
@@ -215,7 +216,7 @@ void SearchPluginManager::installPlugin(const QString &source)
     if (Net::DownloadManager::hasSupportedScheme(source))
     {
         using namespace Net;
-        DownloadManager::instance()->download(DownloadRequest(source).saveToFile(true)
+        DownloadManager::instance()->download(DownloadRequest(source).saveToFile(true).priority(DownloadPriority::High)
                 , Preferences::instance()->useProxyForGeneralPurposes()
                 , this, &SearchPluginManager::pluginDownloadFinished);
     }
@@ -261,36 +262,38 @@ void SearchPluginManager::installPlugin_impl(const QString &name, const Path &pa
     // Copy the plugin
     Utils::Fs::copyFile(path, destPath);
     // Update supported plugins
-    update();
-    // Check if this was correctly installed
-    if (!m_plugins.contains(name))
+    update([this, name, destPath, backupPath, updated]
     {
-        // Remove broken file
-        Utils::Fs::removeFile(destPath);
-        LogMsg(tr("Plugin %1 is not supported.").arg(name), Log::INFO);
-        if (updated)
+        // Check if this was correctly installed
+        if (!m_plugins.contains(name))
         {
-            // restore backup
-            Utils::Fs::copyFile(backupPath, destPath);
-            Utils::Fs::removeFile(backupPath);
-            // Update supported plugins
-            update();
-            emit pluginUpdateFailed(name, tr("Plugin is not supported."));
+            // Remove broken file
+            Utils::Fs::removeFile(destPath);
+            LogMsg(tr("Plugin %1 is not supported.").arg(name), Log::INFO);
+            if (updated)
+            {
+                // restore backup
+                Utils::Fs::copyFile(backupPath, destPath);
+                Utils::Fs::removeFile(backupPath);
+                // Update supported plugins
+                update();
+                emit pluginUpdateFailed(name, tr("Plugin is not supported."));
+            }
+            else
+            {
+                emit pluginInstallationFailed(name, tr("Plugin is not supported."));
+            }
         }
         else
         {
-            emit pluginInstallationFailed(name, tr("Plugin is not supported."));
-        }
-    }
-    else
-    {
-        // Install was successful, remove backup
-        if (updated)
-        {
-            LogMsg(tr("Plugin %1 has been successfully updated.").arg(name), Log::INFO);
-            Utils::Fs::removeFile(backupPath);
+            // Install was successful, remove backup
+            if (updated)
+            {
+                LogMsg(tr("Plugin %1 has been successfully updated.").arg(name), Log::INFO);
+                Utils::Fs::removeFile(backupPath);
+            }
         }
-    }
+    });
 }
 
 bool SearchPluginManager::uninstallPlugin(const QString &name)
@@ -305,6 +308,8 @@ bool SearchPluginManager::uninstallPlugin(const QString &name)
         Utils::Fs::removeFile(pluginsPath / Path(file));
     // Remove it from supported engines
     delete m_plugins.take(name);
+    // Running workers still have it imported
+    retireSearchWorkers();
 
     emit pluginUninstalled(name);
     return true;
@@ -332,7 +337,7 @@ void SearchPluginManager::checkForUpdates()
 {
     // Download version file from update server
     using namespace Net;
-    DownloadManager::instance()->download({m_updateUrl + u"versions.txt"}
+    DownloadManager::instance()->download(DownloadRequest(m_updateUrl + u"versions.txt").useCache(true)
             , Preferences::instance()->useProxyForGeneralPurposes()
             , this, &SearchPluginManager::versionInfoDownloadFinished);
 }
@@ -350,6 +355,95 @@ SearchHandler *SearchPluginManager::startSearch(const QString &pattern, const QS
     return new SearchHandler {pattern, category, usedPlugins, this};
 }
 
+SearchWorker *SearchPluginManager::createSearchWorker()
+{
+    auto *worker = new SearchWorker(this);
+    connect(worker, &SearchWorker::searchFinished, this, &SearchPluginManager::processSearchQueueDeferred);
+    connect(worker, &SearchWorker::searchFailed, this, &SearchPluginManager::processSearchQueueDeferred);
+    connect(worker, &SearchWorker::capabilitiesReceived, this, &SearchPluginManager::processSearchQueueDeferred);
+    connect(worker, &SearchWorker::stopped, this, [this, worker]
+    {
+        m_searchWorkers.removeOne(worker);
+        worker->deleteLater();
+        processSearchQueueDeferred();
+    });
+
+    m_searchWorkers.append(worker);
+    worker->start();
+    return worker;
+}
+
+SearchWorker *SearchPluginManager::idleSearchWorker()
+{
+    for (SearchWorker *worker : asConst(m_searchWorkers))
+    {
+        if (worker->isRunning() && !worker->isBusy())
+            return worker;
+    }
+
+    if (m_searchWorkers.size() < MAX_SEARCH_WORKERS)
+        return createSearchWorker();
+
+    return nullptr;
+}
+
+void SearchPluginManager::retireSearchWorkers()
+{
+    for (SearchWorker *worker : asConst(m_searchWorkers))
+    {
+        if (!worker->isBusy())
+        {
+            worker->stop();
+            continue;
+        }
+
+        // let it complete the current request
+        connect(worker, &SearchWorker::searchFinished, worker, &SearchWorker::stop);
+        connect(worker, &SearchWorker::searchFailed, worker, &SearchWorker::stop);
+        connect(worker, &SearchWorker::capabilitiesReceived, worker, &SearchWorker::stop);
+    }
+
+    m_searchWorkers.clear();
+}
+
+void SearchPluginManager::enqueueSearch(SearchHandler *searchHandler)
+{
+    m_searchQueue.append(searchHandler);
+    processSearchQueue();
+}
+
+void SearchPluginManager::processSearchQueue()
+{
+    if (m_capabilitiesRequestsCount > 0)
+        return;
+
+    while (!m_searchQueue.isEmpty())
+    {
+        SearchHandler *searchHandler = m_searchQueue.first();
+        if (!searchHandler || !searchHandler->isActive())
+        {
+            m_searchQueue.removeFirst();
+            continue;
+        }
+
+        SearchWorker *worker = idleSearchWorker();
+        if (!worker)
+            break;
+
+        m_searchQueue.removeFirst();
+        if (worker->isRunning())
+            searchHandler->startSearch(worker);
+        else
+            searchHandler->failSearch();
+    }
+}
+
+void SearchPluginManager::processSearchQueueDeferred()
+{
+    // workers become idle only after their signals are handled
+    QMetaObject::invokeMethod(this, &SearchPluginManager::processSearchQueue, Qt::QueuedConnection);
+}
+
 QString SearchPluginManager::categoryFullName(const QString &categoryName)
 {
     const QHash<QString, QString> categoryTable
@@ -432,9 +526,16 @@ void SearchPluginManager::applyProxySettings()
                , qUtf8Printable((proxyConfig.type == Net::ProxyType::SOCKS5) ? proxyStrSOCK : proxyStrHTTP));
     }
 
+    const bool isChanged = (qgetenv("http_proxy") != proxyStrHTTP.toLocal8Bit())
+            || (qgetenv("sock_proxy") != proxyStrSOCK.toLocal8Bit());
+
     qputenv("http_proxy", proxyStrHTTP.toLocal8Bit());
     qputenv("https_proxy", proxyStrHTTP.toLocal8Bit());
     qputenv("sock_proxy", proxyStrSOCK.toLocal8Bit());
+
+    // Running workers have got previous environment
+    if (isChanged)
+        retireSearchWorkers();
 }
 
 void SearchPluginManager::versionInfoDownloadFinished(const Net::DownloadResult &result)
@@ -504,33 +605,37 @@ void SearchPluginManager::updateNova()
     updateFile(Path(u"socks.py"_s), false);
 }
 
-void SearchPluginManager::update()
+void SearchPluginManager::update(const std::function<void ()> &callback)
 {
-    QProcess nova;
-    nova.setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+    // Running workers have outdated plugins imported
+    retireSearchWorkers();
 
-    const QStringList params
+    // Searches are held until the plugin list is up to date
+    ++m_capabilitiesRequestsCount;
+    SearchWorker *worker = createSearchWorker();
+    connect(worker, &SearchWorker::capabilitiesReceived, this, [this, callback](const QByteArray &capabilities)
     {
-        Utils::ForeignApps::PYTHON_ISOLATE_MODE_FLAG,
-        (engineLocation() / Path(u"/nova2.py"_s)).toString(),
-        u"--capabilities"_s
-    };
-    nova.start(Utils::ForeignApps::pythonInfo().executableName, params, QIODevice::ReadOnly);
-    nova.waitForFinished();
+        --m_capabilitiesRequestsCount;
+        parseCapabilities(capabilities);
+        if (callback)
+            callback();
+    });
+    worker->requestCapabilities();
+}
 
-    const auto capabilities = QString::fromUtf8(nova.readAllStandardOutput());
+void SearchPluginManager::parseCapabilities(const QByteArray &capabilities)
+{
     QDomDocument xmlDoc;
     if (!xmlDoc.setContent(capabilities))
     {
-        qWarning() << "Could not parse Nova search engine capabilities, msg: " << capabilities.toLocal8Bit().data();
-        qWarning() << "Error: " << nova.readAllStandardError().constData();
+        qWarning() << "Could not parse Nova search engine capabilities, msg: " << capabilities.constData();
         return;
     }
 
     const QDomElement root = xmlDoc.documentElement();
     if (root.tagName() != u"capabilities")
     {
-        qWarning() << "Invalid XML file for Nova search engine capabilities, msg: " << capabilities.toLocal8Bit().data();
+        qWarning() << "Invalid XML file for Nova search engine capabilities, msg: " << capabilities.constData();
         return;
     }
 
@@ -29,9 +29,13 @@
 
 #pragma once
 
+#include <functional>
+
 #include <QHash>
+#include <QList>
 #include <QMetaType>
 #include <QObject>
+#include <QPointer>
 
 #include "base/path.h"
 #include "base/utils/version.h"
@@ -57,12 +61,15 @@ struct PluginInfo
 
 class SearchDownloadHandler;
 class SearchHandler;
+class SearchWorker;
 
 class SearchPluginManager final : public QObject
 {
     Q_OBJECT
     Q_DISABLE_COPY_MOVE(SearchPluginManager)
 
+    friend class SearchHandler;
+
 public:
     SearchPluginManager();
     ~SearchPluginManager() override;
@@ -105,7 +112,8 @@ signals:
 
 private:
     void applyProxySettings();
-    void update();
+    void update(const std::function<void ()> &callback = {});
+    void parseCapabilities(const QByteArray &capabilities);
     void updateNova();
     void parseVersionInfo(const QByteArray &info);
     void installPlugin_impl(const QString &name, const Path &path);
@@ -114,6 +122,13 @@ private:
     void versionInfoDownloadFinished(const Net::DownloadResult &result);
     void pluginDownloadFinished(const Net::DownloadResult &result);
 
+    SearchWorker *createSearchWorker();
+    SearchWorker *idleSearchWorker();
+    void retireSearchWorkers();
+    void enqueueSearch(SearchHandler *searchHandler);
+    void processSearchQueue();
+    void processSearchQueueDeferred();
+
     static Path pluginPath(const QString &name);
 
     static QPointer<SearchPluginManager> m_instance;
@@ -121,4 +136,7 @@ private:
     const QString m_updateUrl;
 
     QHash<QString, PluginInfo*> m_plugins;
+    QList<SearchWorker *> m_searchWorkers;
+    QList<QPointer<SearchHandler>> m_searchQueue;
+    int m_capabilitiesRequestsCount = 0;
 };
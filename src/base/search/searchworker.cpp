@@ -0,0 +1,247 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include "searchworker.h"
+
+#include <chrono>
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTimer>
+
+#include "base/global.h"
+#include "base/path.h"
+#include "base/utils/bytearray.h"
+#include "base/utils/foreignapps.h"
+#include "searchpluginmanager.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    // Engines which don't finish in time are killed, the results they have already provided are kept
+    const auto PLUGIN_TIMEOUT = 2min;
+    // How long to wait for the worker to respond to cancellation/termination before it's killed
+    const auto KILL_TIMEOUT = 10s;
+}
+
+SearchWorker::SearchWorker(QObject *parent)
+    : QObject(parent)
+    , m_process {new QProcess(this)}
+    , m_killTimer {new QTimer(this)}
+{
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &SearchWorker::readOutput);
+    connect(m_process, &QProcess::readyReadStandardError, this, [this]
+    {
+        // keep only the most recent error output so the pipe never gets full
+        m_errorOutput = m_process->readAllStandardError();
+    });
+    connect(m_process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished)
+            , this, &SearchWorker::handleProcessFinished);
+    connect(m_process, &QProcess::errorOccurred, this, [this](const QProcess::ProcessError error)
+    {
+        // `finished` isn't emitted in this case
+        if (error == QProcess::FailedToStart)
+        {
+            qWarning() << "Could not start Nova search worker, error: " << m_process->errorString();
+            handleProcessFinished();
+        }
+    });
+
+    m_killTimer->setSingleShot(true);
+    connect(m_killTimer, &QTimer::timeout, m_process, &QProcess::kill);
+}
+
+bool SearchWorker::isRunning() const
+{
+    return (m_process->state() != QProcess::NotRunning);
+}
+
+bool SearchWorker::isBusy() const
+{
+    return (m_isSearching || m_isWaitingForCapabilities);
+}
+
+void SearchWorker::start()
+{
+    Q_ASSERT(!isRunning());
+
+    // Load environment variables (proxy)
+    m_process->setEnvironment(QProcess::systemEnvironment());
+    m_process->setProgram(Utils::ForeignApps::pythonInfo().executableName);
+    m_process->setArguments({Utils::ForeignApps::PYTHON_ISOLATE_MODE_FLAG
+            , (SearchPluginManager::engineLocation() / Path(u"nova2.py"_s)).toString()
+            , u"--worker"_s});
+    m_process->start(QIODevice::ReadWrite);
+}
+
+void SearchWorker::stop()
+{
+    if (!isRunning())
+        return;
+
+    // worker exits once its input is closed
+    m_process->closeWriteChannel();
+    m_killTimer->start(KILL_TIMEOUT);
+}
+
+void SearchWorker::requestCapabilities()
+{
+    Q_ASSERT(!isBusy());
+
+    if (!isRunning())
+    {
+        // process has failed to start so there is no one to respond
+        emit capabilitiesReceived({});
+        return;
+    }
+
+    m_isWaitingForCapabilities = true;
+    sendRequest({{u"type"_s, u"capabilities"_s}});
+}
+
+void SearchWorker::search(const QStringList &plugins, const QString &category, const QString &pattern)
+{
+    Q_ASSERT(!isBusy());
+
+    ++m_searchID;
+    m_isSearching = true;
+    m_isSearchCancelled = false;
+    m_outputLineTruncated.clear();
+    sendRequest({
+        {u"type"_s, u"search"_s},
+        {u"id"_s, m_searchID},
+        {u"engines"_s, plugins.join(u',')},
+        {u"category"_s, category},
+        {u"query"_s, pattern},
+        {u"timeout"_s, static_cast<qint64>(std::chrono::seconds(PLUGIN_TIMEOUT).count())}
+    });
+}
+
+void SearchWorker::cancelSearch()
+{
+    if (!m_isSearching || m_isSearchCancelled)
+        return;
+
+    m_isSearchCancelled = true;
+    sendRequest({{u"type"_s, u"cancel"_s}, {u"id"_s, m_searchID}});
+    m_killTimer->start(KILL_TIMEOUT);
+}
+
+void SearchWorker::sendRequest(const QJsonObject &request)
+{
+    m_process->write(QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+}
+
+// Worker output consists of search result lines (in the same format as the one of regular search)
+// and messages which are JSON objects on separate lines
+void SearchWorker::readOutput()
+{
+    QByteArray output = m_process->readAllStandardOutput();
+    if (!m_outputLineTruncated.isEmpty())
+        output.prepend(m_outputLineTruncated);
+
+    // Result lines are passed on in chunks, messages split them
+    // since results received so far belong to the request which is being concluded by the message
+    int resultsBegin = 0;
+    int lineBegin = 0;
+    for (int lineEnd = output.indexOf('\n'); lineEnd >= 0; lineEnd = output.indexOf('\n', lineBegin))
+    {
+        if (output.at(lineBegin) == '{')
+        {
+            if (m_isSearching && (lineBegin > resultsBegin))
+                emit searchResultsReceived(output.mid(resultsBegin, (lineBegin - resultsBegin)));
+
+            const QJsonDocument jsonDoc = QJsonDocument::fromJson(Utils::ByteArray::midView(output, lineBegin, (lineEnd - lineBegin)));
+            if (jsonDoc.isObject())
+                handleMessage(jsonDoc.object());
+
+            resultsBegin = lineEnd + 1;
+        }
+
+        lineBegin = lineEnd + 1;
+    }
+
+    if (m_isSearching && (lineBegin > resultsBegin))
+        emit searchResultsReceived(output.mid(resultsBegin, (lineBegin - resultsBegin)));
+
+    m_outputLineTruncated = output.mid(lineBegin);
+}
+
+void SearchWorker::handleMessage(const QJsonObject &message)
+{
+    const QString type = message.value(u"type"_s).toString();
+    if (type == u"capabilities")
+    {
+        if (!m_isWaitingForCapabilities)
+            return;
+
+        m_isWaitingForCapabilities = false;
+        emit capabilitiesReceived(message.value(u"xml"_s).toString().toUtf8());
+    }
+    else if (type == u"finished")
+    {
+        if (!m_isSearching || (message.value(u"id"_s).toInt() != m_searchID))
+            return;
+
+        m_isSearching = false;
+        m_killTimer->stop();
+
+        const QString status = message.value(u"status"_s).toString();
+        if (status == u"failed")
+            emit searchFailed();
+        else
+            emit searchFinished(status == u"cancelled");
+    }
+}
+
+void SearchWorker::handleProcessFinished()
+{
+    m_killTimer->stop();
+
+    if (m_isWaitingForCapabilities)
+    {
+        m_isWaitingForCapabilities = false;
+        qWarning() << "Nova search worker exited unexpectedly: " << (m_errorOutput + m_process->readAllStandardError()).constData();
+        emit capabilitiesReceived({});
+    }
+
+    if (m_isSearching)
+    {
+        m_isSearching = false;
+        if (m_isSearchCancelled)
+            emit searchFinished(true);
+        else
+            emit searchFailed();
+    }
+
+    emit stopped();
+}
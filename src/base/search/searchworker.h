@@ -0,0 +1,84 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QtContainerFwd>
+
+class QJsonObject;
+class QProcess;
+class QTimer;
+
+// Long-lived nova process which keeps search engines imported
+// and serves the requests one at a time
+class SearchWorker final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(SearchWorker)
+
+public:
+    explicit SearchWorker(QObject *parent = nullptr);
+
+    bool isRunning() const;
+    bool isBusy() const;
+
+    void start();
+    void stop();
+
+    void requestCapabilities();
+    void search(const QStringList &plugins, const QString &category, const QString &pattern);
+    void cancelSearch();
+
+signals:
+    void capabilitiesReceived(const QByteArray &capabilities);
+    // `data` consists of complete result lines
+    void searchResultsReceived(const QByteArray &data);
+    void searchFinished(bool cancelled);
+    void searchFailed();
+    void stopped();
+
+private:
+    void readOutput();
+    void handleMessage(const QJsonObject &message);
+    void handleProcessFinished();
+    void sendRequest(const QJsonObject &request);
+
+    QProcess *m_process = nullptr;
+    QTimer *m_killTimer = nullptr;
+    QByteArray m_outputLineTruncated;
+    QByteArray m_errorOutput;
+    int m_searchID = 0;
+    bool m_isSearching = false;
+    bool m_isSearchCancelled = false;
+    bool m_isWaitingForCapabilities = false;
+};
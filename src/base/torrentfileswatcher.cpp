@@ -29,7 +29,10 @@
 
 #include "torrentfileswatcher.h"
 
+#include <algorithm>
 #include <chrono>
+#include <utility>
+#include <vector>
 
 #include <QtGlobal>
 #include <QDir>
@@ -40,8 +43,20 @@
 #include <QJsonObject>
 #include <QSet>
 #include <QThread>
+#include <QThreadPool>
 #include <QTimer>
 #include <QVariant>
+#include <QVector>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <QSocketNotifier>
+#endif
 
 #include "base/algorithm.h"
 #include "base/bittorrent/magneturi.h"
@@ -62,7 +77,13 @@
 using namespace std::chrono_literals;
 
 const std::chrono::seconds WATCH_INTERVAL {10};
+// Changes are collected for a while so that bursts of them are processed at once
+const std::chrono::seconds FOLDER_PROCESSING_DELAY {2};
+const std::chrono::milliseconds FILE_PROCESSING_DELAY {500};
 const int MAX_FAILED_RETRIES = 5;
+const int MAX_DECODING_THREADS = 4;
+// Found torrents are passed to the session in batches of (at most) this size
+const int TORRENTS_BATCH_SIZE = 100;
 const QString CONF_FILE_NAME = u"watched_folders.json"_s;
 
 const QString OPTION_ADDTORRENTPARAMS = u"add_torrent_params"_s;
@@ -84,8 +105,44 @@ namespace
         return {{OPTION_ADDTORRENTPARAMS, BitTorrent::serializeAddTorrentParams(options.addTorrentParams)},
                 {OPTION_RECURSIVE, options.recursive}};
     }
+
+    BitTorrent::AddTorrentParams makeAddTorrentParams(const Path &folderPath, const Path &watchedFolderPath
+            , const TorrentFilesWatcher::WatchedFolderOptions &options)
+    {
+        BitTorrent::AddTorrentParams addTorrentParams = options.addTorrentParams;
+        if (folderPath != watchedFolderPath)
+        {
+            const Path subdirPath = watchedFolderPath.relativePathOf(folderPath);
+            const bool useAutoTMM = addTorrentParams.useAutoTMM.value_or(!BitTorrent::Session::instance()->isAutoTMMDisabledByDefault());
+            if (useAutoTMM)
+            {
+                addTorrentParams.category = addTorrentParams.category.isEmpty()
+                        ? subdirPath.data() : (addTorrentParams.category + u'/' + subdirPath.data());
+            }
+            else
+            {
+                addTorrentParams.savePath = addTorrentParams.savePath / subdirPath;
+            }
+        }
+
+        return addTorrentParams;
+    }
+
+    bool isWatchedFileName(const Path &path)
+    {
+        return path.hasExtension(u".torrent"_s) || path.hasExtension(u".magnet"_s);
+    }
+
+    struct FoundTorrent
+    {
+        BitTorrent::TorrentInfo torrentInfo;
+        BitTorrent::AddTorrentParams addTorrentParams;
+    };
 }
 
+Q_DECLARE_METATYPE(FoundTorrent)
+const int FOUNDTORRENTLIST_TYPEID = qRegisterMetaType<QVector<FoundTorrent>>();
+
 class TorrentFilesWatcher::Worker final : public QObject
 {
     Q_OBJECT
@@ -93,6 +150,7 @@ class TorrentFilesWatcher::Worker final : public QObject
 
 public:
     Worker(QFileSystemWatcher *watcher);
+    ~Worker() override;
 
 public slots:
     void setWatchedFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options);
@@ -100,21 +158,46 @@ public slots:
 
 signals:
     void magnetFound(const BitTorrent::MagnetUri &magnetURI, const BitTorrent::AddTorrentParams &addTorrentParams);
-    void torrentFound(const BitTorrent::TorrentInfo &torrentInfo, const BitTorrent::AddTorrentParams &addTorrentParams);
+    void torrentsFound(const QVector<FoundTorrent> &torrents);
 
 private:
     void onTimeout();
     void scheduleWatchedFolderProcessing(const Path &path);
+    void processPendingFolders();
     void processWatchedFolder(const Path &path);
-    void processFolder(const Path &path, const Path &watchedFolderPath, const TorrentFilesWatcher::WatchedFolderOptions &options);
+    void processFolder(const Path &path, const Path &watchedFolderPath, const TorrentFilesWatcher::WatchedFolderOptions &options
+            , PathList &torrentFiles);
+    void processMagnetFile(const Path &filePath, const BitTorrent::AddTorrentParams &addTorrentParams);
+    void loadTorrentFiles(const PathList &filePaths, const Path &watchedFolderPath);
     void processFailedTorrents();
     void addWatchedFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options);
     void updateWatchedFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options);
+    void startWatching(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options);
+    void stopWatching(const Path &path);
+    Path watchedFolderOf(const Path &folderPath) const;
+
+#ifdef Q_OS_LINUX
+    // inotify is used directly since unlike QFileSystemWatcher it reports which files
+    // have been added, so the folders don't need to be rescanned on every change
+    bool initInotify();
+    bool addInotifyWatches(const Path &folderPath, const Path &watchedFolderPath);
+    void removeInotifyWatches(const Path &path);
+    void readInotifyEvents();
+    void processPendingFiles();
+
+    int m_inotifyFD = -1;
+    bool m_inotifyFailed = false;
+    QHash<int, Path> m_inotifyWatches;
+    QSet<Path> m_pendingFiles;
+    QTimer *m_fileProcessingTimer = nullptr;
+#endif
 
     QFileSystemWatcher *m_watcher = nullptr;
     QTimer *m_watchTimer = nullptr;
     QHash<Path, TorrentFilesWatcher::WatchedFolderOptions> m_watchedFolders;
     QSet<Path> m_watchedByTimeoutFolders;
+    QSet<Path> m_pendingFolders;
+    QTimer *m_folderProcessingTimer = nullptr;
 
     // Failed torrents
     QTimer *m_retryTorrentTimer = nullptr;
@@ -146,7 +229,12 @@ TorrentFilesWatcher::TorrentFilesWatcher(QObject *parent)
     , m_asyncWorker {new TorrentFilesWatcher::Worker(new QFileSystemWatcher(this))}
 {
     connect(m_asyncWorker, &TorrentFilesWatcher::Worker::magnetFound, this, &TorrentFilesWatcher::onMagnetFound);
-    connect(m_asyncWorker, &TorrentFilesWatcher::Worker::torrentFound, this, &TorrentFilesWatcher::onTorrentFound);
+    connect(m_asyncWorker, &TorrentFilesWatcher::Worker::torrentsFound, this, [](const QVector<FoundTorrent> &torrents)
+    {
+        auto *session = BitTorrent::Session::instance();
+        for (const FoundTorrent &torrent : torrents)
+            session->addTorrent(torrent.torrentInfo, torrent.addTorrentParams);
+    });
 
     m_asyncWorker->moveToThread(m_ioThread.get());
     connect(m_ioThread.get(), &QThread::finished, m_asyncWorker, &QObject::deleteLater);
@@ -315,15 +403,10 @@ void TorrentFilesWatcher::onMagnetFound(const BitTorrent::MagnetUri &magnetURI
     BitTorrent::Session::instance()->addTorrent(magnetURI, addTorrentParams);
 }
 
-void TorrentFilesWatcher::onTorrentFound(const BitTorrent::TorrentInfo &torrentInfo
-                                         , const BitTorrent::AddTorrentParams &addTorrentParams)
-{
-    BitTorrent::Session::instance()->addTorrent(torrentInfo, addTorrentParams);
-}
-
 TorrentFilesWatcher::Worker::Worker(QFileSystemWatcher *watcher)
     : m_watcher {watcher}
     , m_watchTimer {new QTimer(this)}
+    , m_folderProcessingTimer {new QTimer(this)}
     , m_retryTorrentTimer {new QTimer(this)}
 {
     connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &path)
@@ -332,9 +415,27 @@ TorrentFilesWatcher::Worker::Worker(QFileSystemWatcher *watcher)
     });
     connect(m_watchTimer, &QTimer::timeout, this, &Worker::onTimeout);
 
+    m_folderProcessingTimer->setSingleShot(true);
+    m_folderProcessingTimer->setTimerType(Qt::CoarseTimer);
+    connect(m_folderProcessingTimer, &QTimer::timeout, this, &Worker::processPendingFolders);
+
+#ifdef Q_OS_LINUX
+    m_fileProcessingTimer = new QTimer(this);
+    m_fileProcessingTimer->setSingleShot(true);
+    connect(m_fileProcessingTimer, &QTimer::timeout, this, &Worker::processPendingFiles);
+#endif
+
     connect(m_retryTorrentTimer, &QTimer::timeout, this, &Worker::processFailedTorrents);
 }
 
+TorrentFilesWatcher::Worker::~Worker()
+{
+#ifdef Q_OS_LINUX
+    if (m_inotifyFD >= 0)
+        ::close(m_inotifyFD);
+#endif
+}
+
 void TorrentFilesWatcher::Worker::onTimeout()
 {
     for (const Path &path : asConst(m_watchedByTimeoutFolders))
@@ -352,11 +453,8 @@ void TorrentFilesWatcher::Worker::setWatchedFolder(const Path &path, const Torre
 void TorrentFilesWatcher::Worker::removeWatchedFolder(const Path &path)
 {
     m_watchedFolders.remove(path);
-
-    m_watcher->removePath(path.data());
-    m_watchedByTimeoutFolders.remove(path);
-    if (m_watchedByTimeoutFolders.isEmpty())
-        m_watchTimer->stop();
+    stopWatching(path);
+    m_pendingFolders.remove(path);
 
     m_failedTorrents.remove(path);
     if (m_failedTorrents.isEmpty())
@@ -365,110 +463,151 @@ void TorrentFilesWatcher::Worker::removeWatchedFolder(const Path &path)
 
 void TorrentFilesWatcher::Worker::scheduleWatchedFolderProcessing(const Path &path)
 {
-    QTimer::singleShot(2s, Qt::CoarseTimer, this, [this, path]
+    m_pendingFolders.insert(path);
+    if (!m_folderProcessingTimer->isActive())
+        m_folderProcessingTimer->start(FOLDER_PROCESSING_DELAY);
+}
+
+void TorrentFilesWatcher::Worker::processPendingFolders()
+{
+    const QSet<Path> pendingFolders = std::exchange(m_pendingFolders, {});
+    for (const Path &path : pendingFolders)
     {
-        processWatchedFolder(path);
-    });
+        if (m_watchedFolders.contains(path))
+            processWatchedFolder(path);
+    }
 }
 
 void TorrentFilesWatcher::Worker::processWatchedFolder(const Path &path)
 {
     const TorrentFilesWatcher::WatchedFolderOptions options = m_watchedFolders.value(path);
-    processFolder(path, path, options);
+
+    PathList torrentFiles;
+    processFolder(path, path, options, torrentFiles);
+    loadTorrentFiles(torrentFiles, path);
 
     if (!m_failedTorrents.empty() && !m_retryTorrentTimer->isActive())
         m_retryTorrentTimer->start(WATCH_INTERVAL);
 }
 
 void TorrentFilesWatcher::Worker::processFolder(const Path &path, const Path &watchedFolderPath
-                                              , const TorrentFilesWatcher::WatchedFolderOptions &options)
+        , const TorrentFilesWatcher::WatchedFolderOptions &options, PathList &torrentFiles)
 {
     QDirIterator dirIter {path.data(), {u"*.torrent"_s, u"*.magnet"_s}, QDir::Files};
     while (dirIter.hasNext())
     {
         const Path filePath {dirIter.next()};
-        BitTorrent::AddTorrentParams addTorrentParams = options.addTorrentParams;
-        if (path != watchedFolderPath)
+        if (filePath.hasExtension(u".magnet"_s))
+            processMagnetFile(filePath, makeAddTorrentParams(path, watchedFolderPath, options));
+        else if (!m_failedTorrents.value(watchedFolderPath).contains(filePath))
+            torrentFiles.append(filePath);
+    }
+
+    if (options.recursive)
+    {
+        QDirIterator dirIter {path.data(), (QDir::Dirs | QDir::NoDot | QDir::NoDotDot)};
+        while (dirIter.hasNext())
         {
-            const Path subdirPath = watchedFolderPath.relativePathOf(path);
-            const bool useAutoTMM = addTorrentParams.useAutoTMM.value_or(!BitTorrent::Session::instance()->isAutoTMMDisabledByDefault());
-            if (useAutoTMM)
-            {
-                addTorrentParams.category = addTorrentParams.category.isEmpty()
-                        ? subdirPath.data() : (addTorrentParams.category + u'/' + subdirPath.data());
-            }
-            else
+            const Path folderPath {dirIter.next()};
+            // Skip processing of subdirectory that is explicitly set as watched folder
+            if (!m_watchedFolders.contains(folderPath))
+                processFolder(folderPath, watchedFolderPath, options, torrentFiles);
+        }
+    }
+}
+
+void TorrentFilesWatcher::Worker::processMagnetFile(const Path &filePath, const BitTorrent::AddTorrentParams &addTorrentParams)
+{
+    const int fileMaxSize = 100 * 1024 * 1024;
+
+    QFile file {filePath.data()};
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        if (file.size() <= fileMaxSize)
+        {
+            while (!file.atEnd())
             {
-                addTorrentParams.savePath = addTorrentParams.savePath / subdirPath;
+                const auto line = QString::fromLatin1(file.readLine()).trimmed();
+                emit magnetFound(BitTorrent::MagnetUri(line), addTorrentParams);
             }
-        }
 
-        if (filePath.hasExtension(u".magnet"_s))
+            file.close();
+            Utils::Fs::removeFile(filePath);
+        }
+        else
         {
-            const int fileMaxSize = 100 * 1024 * 1024;
+            LogMsg(tr("Magnet file too big. File: %1").arg(file.errorString()));
+        }
+    }
+    else
+    {
+        LogMsg(tr("Failed to open magnet file: %1").arg(file.errorString()));
+    }
+}
 
-            QFile file {filePath.data()};
-            if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+// Torrent files are decoded in parallel and the successfully loaded ones are passed on in batches
+void TorrentFilesWatcher::Worker::loadTorrentFiles(const PathList &filePaths, const Path &watchedFolderPath)
+{
+    if (filePaths.isEmpty())
+        return;
+
+    const TorrentFilesWatcher::WatchedFolderOptions options = m_watchedFolders.value(watchedFolderPath);
+
+    QThreadPool decodingPool;
+    decodingPool.setMaxThreadCount(std::clamp(QThread::idealThreadCount(), 1, MAX_DECODING_THREADS));
+
+    const int filesCount = filePaths.size();
+    for (int batchStart = 0; batchStart < filesCount; batchStart += TORRENTS_BATCH_SIZE)
+    {
+        const int batchSize = std::min(TORRENTS_BATCH_SIZE, (filesCount - batchStart));
+
+        std::vector<nonstd::expected<BitTorrent::TorrentInfo, QString>> results(batchSize);
+        if (batchSize == 1)
+        {
+            results[0] = BitTorrent::TorrentInfo::loadFromFile(filePaths[batchStart]);
+        }
+        else
+        {
+            for (int i = 0; i < batchSize; ++i)
             {
-                if (file.size() <= fileMaxSize)
+                decodingPool.start([&results, &filePath = filePaths[batchStart + i], i]
                 {
-                    while (!file.atEnd())
-                    {
-                        const auto line = QString::fromLatin1(file.readLine()).trimmed();
-                        emit magnetFound(BitTorrent::MagnetUri(line), addTorrentParams);
-                    }
-
-                    file.close();
-                    Utils::Fs::removeFile(filePath);
-                }
-                else
-                {
-                    LogMsg(tr("Magnet file too big. File: %1").arg(file.errorString()));
-                }
-            }
-            else
-            {
-                LogMsg(tr("Failed to open magnet file: %1").arg(file.errorString()));
+                    results[i] = BitTorrent::TorrentInfo::loadFromFile(filePath);
+                });
             }
+            decodingPool.waitForDone();
         }
-        else
+
+        QVector<FoundTorrent> torrents;
+        torrents.reserve(batchSize);
+        for (int i = 0; i < batchSize; ++i)
         {
-            const nonstd::expected<BitTorrent::TorrentInfo, QString> result = BitTorrent::TorrentInfo::loadFromFile(filePath);
-            if (result)
+            const Path &filePath = filePaths[batchStart + i];
+            if (results[i])
             {
-                emit torrentFound(result.value(), addTorrentParams);
+                torrents.append({results[i].value(), makeAddTorrentParams(filePath.parentPath(), watchedFolderPath, options)});
                 Utils::Fs::removeFile(filePath);
             }
             else
             {
-                if (!m_failedTorrents.value(path).contains(filePath))
-                {
-                    m_failedTorrents[path][filePath] = 0;
-                }
+                m_failedTorrents[watchedFolderPath].insert(filePath, 0);
             }
         }
-    }
 
-    if (options.recursive)
-    {
-        QDirIterator dirIter {path.data(), (QDir::Dirs | QDir::NoDot | QDir::NoDotDot)};
-        while (dirIter.hasNext())
-        {
-            const Path folderPath {dirIter.next()};
-            // Skip processing of subdirectory that is explicitly set as watched folder
-            if (!m_watchedFolders.contains(folderPath))
-                processFolder(folderPath, watchedFolderPath, options);
-        }
+        if (!torrents.isEmpty())
+            emit torrentsFound(torrents);
     }
 }
 
 void TorrentFilesWatcher::Worker::processFailedTorrents()
 {
+    QVector<FoundTorrent> torrents;
+
     // Check which torrents are still partial
-    Algorithm::removeIf(m_failedTorrents, [this](const Path &watchedFolderPath, QHash<Path, int> &partialTorrents)
+    Algorithm::removeIf(m_failedTorrents, [this, &torrents](const Path &watchedFolderPath, QHash<Path, int> &partialTorrents)
     {
         const TorrentFilesWatcher::WatchedFolderOptions options = m_watchedFolders.value(watchedFolderPath);
-        Algorithm::removeIf(partialTorrents, [this, &watchedFolderPath, &options](const Path &torrentPath, int &value)
+        Algorithm::removeIf(partialTorrents, [&torrents, &watchedFolderPath, &options](const Path &torrentPath, int &value)
         {
             if (!torrentPath.exists())
                 return true;
@@ -476,23 +615,7 @@ void TorrentFilesWatcher::Worker::processFailedTorrents()
             const nonstd::expected<BitTorrent::TorrentInfo, QString> result = BitTorrent::TorrentInfo::loadFromFile(torrentPath);
             if (result)
             {
-                BitTorrent::AddTorrentParams addTorrentParams = options.addTorrentParams;
-                if (torrentPath != watchedFolderPath)
-                {
-                    const Path subdirPath = watchedFolderPath.relativePathOf(torrentPath);
-                    const bool useAutoTMM = addTorrentParams.useAutoTMM.value_or(!BitTorrent::Session::instance()->isAutoTMMDisabledByDefault());
-                    if (useAutoTMM)
-                    {
-                        addTorrentParams.category = addTorrentParams.category.isEmpty()
-                                ? subdirPath.data() : (addTorrentParams.category + u'/' + subdirPath.data());
-                    }
-                    else
-                    {
-                        addTorrentParams.savePath = addTorrentParams.savePath / subdirPath;
-                    }
-                }
-
-                emit torrentFound(result.value(), addTorrentParams);
+                torrents.append({result.value(), makeAddTorrentParams(torrentPath.parentPath(), watchedFolderPath, options)});
                 Utils::Fs::removeFile(torrentPath);
 
                 return true;
@@ -515,6 +638,9 @@ void TorrentFilesWatcher::Worker::processFailedTorrents()
         return false;
     });
 
+    if (!torrents.isEmpty())
+        emit torrentsFound(torrents);
+
     // Stop the partial timer if necessary
     if (m_failedTorrents.empty())
         m_retryTorrentTimer->stop();
@@ -523,50 +649,242 @@ void TorrentFilesWatcher::Worker::processFailedTorrents()
 }
 
 void TorrentFilesWatcher::Worker::addWatchedFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options)
+{
+    m_watchedFolders[path] = options;
+    startWatching(path, options);
+
+    LogMsg(tr("Watching folder: \"%1\"").arg(path.toString()));
+}
+
+void TorrentFilesWatcher::Worker::updateWatchedFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options)
+{
+    const bool recursiveModeChanged = (m_watchedFolders[path].recursive != options.recursive);
+    m_watchedFolders[path] = options;
+
+    if (recursiveModeChanged)
+    {
+        stopWatching(path);
+        startWatching(path, options);
+    }
+}
+
+void TorrentFilesWatcher::Worker::startWatching(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options)
 {
     // Check if the `path` points to a network file system or not
-    if (Utils::Fs::isNetworkFileSystem(path) || options.recursive)
+    if (!Utils::Fs::isNetworkFileSystem(path))
     {
-        m_watchedByTimeoutFolders.insert(path);
-        if (!m_watchTimer->isActive())
-            m_watchTimer->start(WATCH_INTERVAL);
+#ifdef Q_OS_LINUX
+        if (initInotify() && addInotifyWatches(path, path))
+        {
+            scheduleWatchedFolderProcessing(path);
+            return;
+        }
+#endif
+
+        if (!options.recursive)
+        {
+            m_watcher->addPath(path.data());
+            scheduleWatchedFolderProcessing(path);
+            return;
+        }
     }
-    else
+
+    m_watchedByTimeoutFolders.insert(path);
+    if (!m_watchTimer->isActive())
+        m_watchTimer->start(WATCH_INTERVAL);
+}
+
+void TorrentFilesWatcher::Worker::stopWatching(const Path &path)
+{
+#ifdef Q_OS_LINUX
+    removeInotifyWatches(path);
+#endif
+
+    m_watcher->removePath(path.data());
+    m_watchedByTimeoutFolders.remove(path);
+    if (m_watchedByTimeoutFolders.isEmpty())
+        m_watchTimer->stop();
+}
+
+// Returns the watched folder which the given folder is processed as part of
+Path TorrentFilesWatcher::Worker::watchedFolderOf(const Path &folderPath) const
+{
+    if (m_watchedFolders.contains(folderPath))
+        return folderPath;
+
+    for (Path path = folderPath.parentPath(); !path.isEmpty(); path = path.parentPath())
     {
-        m_watcher->addPath(path.data());
-        scheduleWatchedFolderProcessing(path);
+        const auto iter = m_watchedFolders.constFind(path);
+        if (iter != m_watchedFolders.cend())
+            return iter->recursive ? path : Path();
     }
 
-    m_watchedFolders[path] = options;
+    return {};
+}
 
-    LogMsg(tr("Watching folder: \"%1\"").arg(path.toString()));
+#ifdef Q_OS_LINUX
+bool TorrentFilesWatcher::Worker::initInotify()
+{
+    if (m_inotifyFD >= 0)
+        return true;
+    if (m_inotifyFailed)
+        return false;
+
+    m_inotifyFD = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFD < 0)
+    {
+        m_inotifyFailed = true;
+        LogMsg(tr("Failed to initialize inotify, watched folders will be polled. Reason: %1")
+                .arg(QString::fromLocal8Bit(std::strerror(errno))), Log::WARNING);
+        return false;
+    }
+
+    auto *notifier = new QSocketNotifier(m_inotifyFD, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &Worker::readInotifyEvents);
+    return true;
 }
 
-void TorrentFilesWatcher::Worker::updateWatchedFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options)
+bool TorrentFilesWatcher::Worker::addInotifyWatches(const Path &folderPath, const Path &watchedFolderPath)
 {
-    const bool recursiveModeChanged = (m_watchedFolders[path].recursive != options.recursive);
-    if (recursiveModeChanged && !Utils::Fs::isNetworkFileSystem(path))
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+    const int wd = ::inotify_add_watch(m_inotifyFD, QFile::encodeName(folderPath.data()).constData(), mask);
+    if (wd < 0)
+    {
+        LogMsg(tr("Failed to watch folder using inotify. Folder: \"%1\". Reason: %2")
+                .arg(folderPath.toString(), QString::fromLocal8Bit(std::strerror(errno))), Log::WARNING);
+        return false;
+    }
+
+    m_inotifyWatches[wd] = folderPath;
+
+    if (m_watchedFolders.value(watchedFolderPath).recursive)
     {
-        if (options.recursive)
+        QDirIterator dirIter {folderPath.data(), (QDir::Dirs | QDir::NoDotAndDotDot), QDirIterator::Subdirectories};
+        while (dirIter.hasNext())
         {
-            m_watcher->removePath(path.data());
+            const Path subfolderPath {dirIter.next()};
+            // Subfolders that are explicitly set as watched folders are watched on their own
+            if (watchedFolderOf(subfolderPath) != watchedFolderPath)
+                continue;
+
+            const int subfolderWD = ::inotify_add_watch(m_inotifyFD, QFile::encodeName(subfolderPath.data()).constData(), mask);
+            if (subfolderWD >= 0)
+                m_inotifyWatches[subfolderWD] = subfolderPath;
+        }
+    }
+
+    return true;
+}
 
-            m_watchedByTimeoutFolders.insert(path);
-            if (!m_watchTimer->isActive())
-                m_watchTimer->start(WATCH_INTERVAL);
+void TorrentFilesWatcher::Worker::removeInotifyWatches(const Path &path)
+{
+    // `path` can still be watched (e.g. with different options) or be a part of another watched folder,
+    // so only the watches of the folders which aren't covered by any watched folder anymore are removed
+    for (auto iter = m_inotifyWatches.begin(); iter != m_inotifyWatches.end();)
+    {
+        const Path &folderPath = iter.value();
+        const bool isAffected = (folderPath == path) || folderPath.hasAncestor(path);
+        if (isAffected && watchedFolderOf(folderPath).isEmpty())
+        {
+            ::inotify_rm_watch(m_inotifyFD, iter.key());
+            iter = m_inotifyWatches.erase(iter);
         }
         else
         {
-            m_watchedByTimeoutFolders.remove(path);
-            if (m_watchedByTimeoutFolders.isEmpty())
-                m_watchTimer->stop();
+            ++iter;
+        }
+    }
+}
 
-            m_watcher->addPath(path.data());
-            scheduleWatchedFolderProcessing(path);
+void TorrentFilesWatcher::Worker::readInotifyEvents()
+{
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    while (true)
+    {
+        const ssize_t length = ::read(m_inotifyFD, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        for (const char *ptr = buffer; ptr < (buffer + length);)
+        {
+            const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                // some events are lost so all the folders need to be rescanned
+                for (const Path &folderPath : asConst(m_inotifyWatches))
+                {
+                    if (m_watchedFolders.contains(folderPath))
+                        scheduleWatchedFolderProcessing(folderPath);
+                }
+                continue;
+            }
+
+            if (event->mask & IN_IGNORED)
+            {
+                // watched folder was removed
+                m_inotifyWatches.remove(event->wd);
+                continue;
+            }
+
+            const Path folderPath = m_inotifyWatches.value(event->wd);
+            if (folderPath.isEmpty() || (event->len == 0))
+                continue;
+
+            const Path entryPath = folderPath / Path(QFile::decodeName(event->name));
+            if (event->mask & IN_ISDIR)
+            {
+                // new subfolder of recursively watched folder, it could already have some files in it
+                const Path watchedFolderPath = watchedFolderOf(entryPath);
+                if (!watchedFolderPath.isEmpty() && (watchedFolderPath != entryPath))
+                {
+                    addInotifyWatches(entryPath, watchedFolderPath);
+                    scheduleWatchedFolderProcessing(watchedFolderPath);
+                }
+            }
+            else if (!(event->mask & IN_CREATE) && isWatchedFileName(entryPath))
+            {
+                m_pendingFiles.insert(entryPath);
+                if (!m_fileProcessingTimer->isActive())
+                    m_fileProcessingTimer->start(FILE_PROCESSING_DELAY);
+            }
         }
     }
+}
 
-    m_watchedFolders[path] = options;
+void TorrentFilesWatcher::Worker::processPendingFiles()
+{
+    QHash<Path, PathList> torrentFiles;
+
+    const QSet<Path> pendingFiles = std::exchange(m_pendingFiles, {});
+    for (const Path &filePath : pendingFiles)
+    {
+        if (!filePath.exists())
+            continue;
+
+        const Path folderPath = filePath.parentPath();
+        const Path watchedFolderPath = watchedFolderOf(folderPath);
+        if (watchedFolderPath.isEmpty())
+            continue;
+
+        if (filePath.hasExtension(u".magnet"_s))
+        {
+            processMagnetFile(filePath, makeAddTorrentParams(folderPath, watchedFolderPath, m_watchedFolders.value(watchedFolderPath)));
+        }
+        else if (!m_failedTorrents.value(watchedFolderPath).contains(filePath))
+        {
+            torrentFiles[watchedFolderPath].append(filePath);
+        }
+    }
+
+    for (auto iter = torrentFiles.cbegin(); iter != torrentFiles.cend(); ++iter)
+        loadTorrentFiles(iter.value(), iter.key());
+
+    if (!m_failedTorrents.empty() && !m_retryTorrentTimer->isActive())
+        m_retryTorrentTimer->start(WATCH_INTERVAL);
 }
+#endif
 
 #include "torrentfileswatcher.moc"
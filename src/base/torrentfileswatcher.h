@@ -73,7 +73,6 @@ signals:
 
 private slots:
     void onMagnetFound(const BitTorrent::MagnetUri &magnetURI, const BitTorrent::AddTorrentParams &addTorrentParams);
-    void onTorrentFound(const BitTorrent::TorrentInfo &torrentInfo, const BitTorrent::AddTorrentParams &addTorrentParams);
 
 private:
     explicit TorrentFilesWatcher(QObject *parent = nullptr);
@@ -139,3 +139,11 @@ QByteArray Utils::Gzip::decompress(const QByteArray &data, bool *ok)
     if (ok) *ok = true;
     return output;
 }
+
+bool Utils::Gzip::isCompressed(const QByteArray &data)
+{
+    // check gzip header magic bytes
+    return (data.size() >= 2)
+            && (static_cast<unsigned char>(data[0]) == 0x1f)
+            && (static_cast<unsigned char>(data[1]) == 0x8b);
+}
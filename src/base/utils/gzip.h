@@ -35,4 +35,5 @@ namespace Utils::Gzip
 {
     QByteArray compress(const QByteArray &data, int level = 6, bool *ok = nullptr);
     QByteArray decompress(const QByteArray &data, bool *ok = nullptr);
+    bool isCompressed(const QByteArray &data);
 }
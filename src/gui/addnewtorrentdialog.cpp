@@ -573,7 +573,7 @@ void AddNewTorrentDialog::show(const QString &source, const BitTorrent::AddTorre
     {
         // Launch downloader
         Net::DownloadManager::instance()->download(
-                Net::DownloadRequest(source).limit(pref->getTorrentFileSizeLimit())
+                Net::DownloadRequest(source).limit(pref->getTorrentFileSizeLimit()).priority(Net::DownloadPriority::High)
                 , pref->useProxyForGeneralPurposes()
                 , dlg, &AddNewTorrentDialog::handleDownloadFinished);
         return;
@@ -63,6 +63,11 @@ namespace
         // qBittorrent section
         QBITTORRENT_HEADER,
         RESUME_DATA_STORAGE,
+        RESUME_DATA_COMPRESSION,
+        RESUME_DATA_COMMIT_INTERVAL,
+        RESUME_DATA_COMMIT_JOBS_LIMIT,
+        RESUME_DATA_RELAXED_DURABILITY,
+        RESUME_DATA_WAL_AUTOCHECKPOINT,
 #if defined(QBT_USES_LIBTORRENT2) && !defined(Q_OS_MACOS)
         MEMORY_WORKING_SET_LIMIT,
 #endif
@@ -197,6 +202,11 @@ void AdvancedSettings::saveAdvancedSettings() const
     BitTorrent::Session *const session = BitTorrent::Session::instance();
 
     session->setResumeDataStorageType(m_comboBoxResumeDataStorage.currentData().value<BitTorrent::ResumeDataStorageType>());
+    pref->setResumeDataCompressionEnabled(m_checkBoxResumeDataCompression.isChecked());
+    pref->setResumeDataCommitInterval(m_spinBoxResumeDataCommitInterval.value());
+    pref->setResumeDataCommitJobsLimit(m_spinBoxResumeDataCommitJobsLimit.value());
+    pref->setResumeDataRelaxedDurabilityEnabled(m_checkBoxResumeDataRelaxedDurability.isChecked());
+    pref->setResumeDataWALAutoCheckpoint(m_spinBoxResumeDataWALAutoCheckpoint.value());
 #if defined(QBT_USES_LIBTORRENT2) && !defined(Q_OS_MACOS)
     // Physical memory (RAM) usage limit
     app()->setMemoryWorkingSetLimit(m_spinBoxMemoryWorkingSetLimit.value());
@@ -455,7 +465,38 @@ void AdvancedSettings::loadAdvancedSettings()
     m_comboBoxResumeDataStorage.addItem(tr("Fastresume files"), QVariant::fromValue(BitTorrent::ResumeDataStorageType::Legacy));
     m_comboBoxResumeDataStorage.addItem(tr("SQLite database (experimental)"), QVariant::fromValue(BitTorrent::ResumeDataStorageType::SQLite));
     m_comboBoxResumeDataStorage.setCurrentIndex(m_comboBoxResumeDataStorage.findData(QVariant::fromValue(session->resumeDataStorageType())));
-    addRow(RESUME_DATA_STORAGE, tr("Resume data storage type (requires restart)"), &m_comboBoxResumeDataStorage);
+    addRow(RESUME_DATA_STORAGE, tr("Resume data storage type"), &m_comboBoxResumeDataStorage);
+
+    m_checkBoxResumeDataCompression.setToolTip(tr("Existing resume data is converted in background after restart"));
+    m_checkBoxResumeDataCompression.setChecked(pref->isResumeDataCompressionEnabled());
+    addRow(RESUME_DATA_COMPRESSION, tr("Compress resume data"), &m_checkBoxResumeDataCompression);
+
+    m_spinBoxResumeDataCommitInterval.setMinimum(0);
+    m_spinBoxResumeDataCommitInterval.setMaximum(60000);
+    m_spinBoxResumeDataCommitInterval.setSuffix(tr(" ms", " milliseconds"));
+    m_spinBoxResumeDataCommitInterval.setSpecialValueText(tr("Disabled"));
+    m_spinBoxResumeDataCommitInterval.setToolTip(tr("Applies to SQLite database. Resume data changes are written together at most once per this interval."));
+    m_spinBoxResumeDataCommitInterval.setValue(pref->getResumeDataCommitInterval());
+    addRow(RESUME_DATA_COMMIT_INTERVAL, tr("Resume data commit interval (requires restart)"), &m_spinBoxResumeDataCommitInterval);
+
+    m_spinBoxResumeDataCommitJobsLimit.setMinimum(0);
+    m_spinBoxResumeDataCommitJobsLimit.setMaximum(100000);
+    m_spinBoxResumeDataCommitJobsLimit.setSpecialValueText(tr("Unlimited"));
+    m_spinBoxResumeDataCommitJobsLimit.setToolTip(tr("Applies to SQLite database. Resume data changes are written before the commit interval elapses once this number of them is pending."));
+    m_spinBoxResumeDataCommitJobsLimit.setValue(pref->getResumeDataCommitJobsLimit());
+    addRow(RESUME_DATA_COMMIT_JOBS_LIMIT, tr("Resume data commit jobs limit (requires restart)"), &m_spinBoxResumeDataCommitJobsLimit);
+
+    m_checkBoxResumeDataRelaxedDurability.setToolTip(tr("Applies to SQLite database. Reduces disk syncs. Database remains consistent, but the latest changes may be lost on power failure."));
+    m_checkBoxResumeDataRelaxedDurability.setChecked(pref->isResumeDataRelaxedDurabilityEnabled());
+    addRow(RESUME_DATA_RELAXED_DURABILITY, tr("Relaxed resume data durability (requires restart)"), &m_checkBoxResumeDataRelaxedDurability);
+
+    m_spinBoxResumeDataWALAutoCheckpoint.setMinimum(0);
+    m_spinBoxResumeDataWALAutoCheckpoint.setMaximum(1000000);
+    m_spinBoxResumeDataWALAutoCheckpoint.setSuffix(tr(" pages"));
+    m_spinBoxResumeDataWALAutoCheckpoint.setSpecialValueText(tr("Disabled"));
+    m_spinBoxResumeDataWALAutoCheckpoint.setToolTip(tr("Applies to SQLite database. Write-ahead log is also checkpointed in background, so automatic checkpoints can be disabled."));
+    m_spinBoxResumeDataWALAutoCheckpoint.setValue(pref->getResumeDataWALAutoCheckpoint());
+    addRow(RESUME_DATA_WAL_AUTOCHECKPOINT, tr("Resume data WAL auto checkpoint (requires restart)"), &m_spinBoxResumeDataWALAutoCheckpoint);
 
 #if defined(QBT_USES_LIBTORRENT2) && !defined(Q_OS_MACOS)
     // Physical memory (RAM) usage limit
@@ -32,6 +32,7 @@ HEADERS += \
     $$PWD/previewselectdialog.h \
     $$PWD/progressbarpainter.h \
     $$PWD/properties/downloadedpiecesbar.h \
+    $$PWD/properties/peerlistmodel.h \
     $$PWD/properties/peerlistsortmodel.h \
     $$PWD/properties/peerlistwidget.h \
     $$PWD/properties/peersadditiondialog.h \
@@ -125,6 +126,7 @@ SOURCES += \
     $$PWD/previewselectdialog.cpp \
     $$PWD/progressbarpainter.cpp \
     $$PWD/properties/downloadedpiecesbar.cpp \
+    $$PWD/properties/peerlistmodel.cpp \
     $$PWD/properties/peerlistsortmodel.cpp \
     $$PWD/properties/peerlistwidget.cpp \
     $$PWD/properties/peersadditiondialog.cpp \
@@ -870,6 +870,10 @@ void OptionsDialog::loadConnectionTabOptions()
 
     m_ui->IpFilterRefreshBtn->setIcon(UIThemeManager::instance()->getIcon(u"view-refresh"_s));
     m_ui->IpFilterRefreshBtn->setEnabled(m_ui->checkIPFilter->isChecked());
+    m_ui->textIPFilterSources->setPlainText(session->IPFilterSources().join(u'\n'));
+    m_ui->textIPFilterSources->setEnabled(m_ui->checkIPFilter->isChecked());
+    m_ui->spinIPFilterRefreshInterval->setValue(session->IPFilterRefreshInterval());
+    m_ui->spinIPFilterRefreshInterval->setEnabled(m_ui->checkIPFilter->isChecked());
     m_ui->checkIpFilterTrackers->setChecked(session->isTrackerFilteringEnabled());
 
     connect(m_ui->comboProtocol, qComboBoxCurrentIndexChanged, this, &ThisType::enableApplyButton);
@@ -916,6 +920,10 @@ void OptionsDialog::loadConnectionTabOptions()
     connect(m_ui->checkIPFilter, &QAbstractButton::toggled, m_ui->textFilterPath, &QWidget::setEnabled);
     connect(m_ui->checkIPFilter, &QAbstractButton::toggled, m_ui->IpFilterRefreshBtn, &QWidget::setEnabled);
     connect(m_ui->textFilterPath, &FileSystemPathEdit::selectedPathChanged, this, &ThisType::enableApplyButton);
+    connect(m_ui->checkIPFilter, &QAbstractButton::toggled, m_ui->textIPFilterSources, &QWidget::setEnabled);
+    connect(m_ui->checkIPFilter, &QAbstractButton::toggled, m_ui->spinIPFilterRefreshInterval, &QWidget::setEnabled);
+    connect(m_ui->textIPFilterSources, &QPlainTextEdit::textChanged, this, &ThisType::enableApplyButton);
+    connect(m_ui->spinIPFilterRefreshInterval, qSpinBoxValueChanged, this, &ThisType::enableApplyButton);
     connect(m_ui->checkIpFilterTrackers, &QAbstractButton::toggled, this, &ThisType::enableApplyButton);
 }
 
@@ -960,6 +968,8 @@ void OptionsDialog::saveConnectionTabOptions() const
     session->setIPFilteringEnabled(isIPFilteringEnabled());
     session->setTrackerFilteringEnabled(m_ui->checkIpFilterTrackers->isChecked());
     session->setIPFilterFile(m_ui->textFilterPath->selectedPath());
+    session->setIPFilterSources(m_ui->textIPFilterSources->toPlainText().split(u'\n', Qt::SkipEmptyParts));
+    session->setIPFilterRefreshInterval(m_ui->spinIPFilterRefreshInterval->value());
 }
 
 void OptionsDialog::loadSpeedTabOptions()
@@ -1944,6 +1954,7 @@ void OptionsDialog::on_IpFilterRefreshBtn_clicked()
     session->setIPFilteringEnabled(true);
     session->setIPFilterFile({}); // forcing Session reload filter file
     session->setIPFilterFile(getFilter());
+    session->setIPFilterSources(m_ui->textIPFilterSources->toPlainText().split(u'\n', Qt::SkipEmptyParts));
     connect(session, &BitTorrent::Session::IPFilterParsed, this, &OptionsDialog::handleIPFilterParsed);
     setCursor(QCursor(Qt::WaitCursor));
 }
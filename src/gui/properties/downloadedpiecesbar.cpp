@@ -29,10 +29,6 @@
 #include "downloadedpiecesbar.h"
 
 #include <algorithm>
-#include <cmath>
-
-#include <QDebug>
-#include <QVector>
 
 #include "base/global.h"
 
@@ -43,6 +39,27 @@ namespace
         const QColor green {Qt::green};
         return QColor::fromHsl(green.hslHue(), pieceColor.hslSaturation(), pieceColor.lightness());
     }
+
+    // Visits set bits only, the zero bytes are skipped at once
+    template <typename Func>
+    void forEachSetBit(const QBitArray &bitArray, Func func)
+    {
+        const int size = bitArray.size();
+        const auto *bytes = reinterpret_cast<const uchar *>(bitArray.bits());
+        for (int byteIndex = 0, bytesCount = ((size + 7) / 8); byteIndex < bytesCount; ++byteIndex)
+        {
+            const uchar byte = bytes[byteIndex];
+            if (byte == 0)
+                continue;
+
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                const int index = (byteIndex * 8) + bit;
+                if ((byte & (1 << bit)) && (index < size))
+                    func(index);
+            }
+        }
+    }
 }
 
 DownloadedPiecesBar::DownloadedPiecesBar(QWidget *parent)
@@ -51,139 +68,90 @@ DownloadedPiecesBar::DownloadedPiecesBar(QWidget *parent)
 {
 }
 
-QVector<float> DownloadedPiecesBar::bitfieldToFloatVector(const QBitArray &vecin, int reqSize)
+void DownloadedPiecesBar::rebuildPixelData(const int imageWidth)
 {
-    QVector<float> result(reqSize, 0.0);
-    if (vecin.isEmpty()) return result;
+    m_completeWeights.fill(0, imageWidth);
+    m_partialWeights.fill(0, imageWidth);
+    updateWeights(m_completeWeights, {}, m_pieces);
+    updateWeights(m_partialWeights, {}, m_downloadedPieces);
+}
 
-    const float ratio = vecin.size() / static_cast<float>(reqSize);
+DownloadedPiecesBar::PixelSpan DownloadedPiecesBar::updateWeights(QVector<qint64> &weights, const QBitArray &oldPieces, const QBitArray &newPieces)
+{
+    PixelSpan dirtySpan;
 
-    // simple linear transformation algorithm
-    // for example:
-    // image.x(0) = pieces.x(0.0 >= x < 1.7)
-    // image.x(1) = pieces.x(1.7 >= x < 3.4)
+    const int piecesCount = newPieces.size();
+    const int imageWidth = weights.size();
+    if ((piecesCount == 0) || (imageWidth == 0))
+        return dirtySpan;
 
-    for (int x = 0; x < reqSize; ++x)
+    // the pieces that have changed are found by comparing whole words of the bitfields
+    const QBitArray changedPieces = oldPieces.isEmpty() ? newPieces : (oldPieces ^ newPieces);
+    forEachSetBit(changedPieces, [&](const int pieceIndex)
     {
-        // R - real
-        const float fromR = x * ratio;
-        const float toR = (x + 1) * ratio;
-
-        // C - integer
-        int fromC = fromR; // std::floor not needed
-        int toC = std::ceil(toR);
-        if (toC > vecin.size())
-            --toC;
-
-        // position in pieces table
-        int x2 = fromC;
-
-        // little speed up for really big pieces table, 10K+ size
-        const int toCMinusOne = toC - 1;
-
-        // value in returned vector
-        float value = 0;
-
-        // case when calculated range is (15.2 >= x < 15.7)
-        if (x2 == toCMinusOne)
+        const qint64 sign = newPieces.testBit(pieceIndex) ? 1 : -1;
+        forEachPiecePixel(pieceIndex, piecesCount, imageWidth, [&](const int pixel, const qint64 overlap)
         {
-            if (vecin[x2])
-                value += ratio;
-            ++x2;
-        }
-        // case when (15.2 >= x < 17.8)
-        else
-        {
-            // subcase (15.2 >= x < 16)
-            if (x2 != fromR)
-            {
-                if (vecin[x2])
-                    value += 1.0 - (fromR - fromC);
-                ++x2;
-            }
-
-            // subcase (16 >= x < 17)
-            for (; x2 < toCMinusOne; ++x2)
-                if (vecin[x2])
-                    value += 1.0;
-
-            // subcase (17 >= x < 17.8)
-            if (x2 == toCMinusOne)
-            {
-                if (vecin[x2])
-                    value += 1.0 - (toC - toR);
-                ++x2;
-            }
-        }
+            weights[pixel] += sign * overlap;
+            dirtySpan.first = std::min(dirtySpan.first, pixel);
+            dirtySpan.last = std::max(dirtySpan.last, pixel);
+        });
+    });
 
-        // normalization <0, 1>
-        value /= ratio;
-
-        // float precision sometimes gives > 1, because it's not possible to store irrational numbers
-        value = std::min(value, 1.0f);
-
-        result[x] = value;
-    }
-
-    return result;
+    return dirtySpan;
 }
 
-bool DownloadedPiecesBar::updateImage(QImage &image)
+QRgb DownloadedPiecesBar::pixelColor(const int pixel) const
 {
-    //  qDebug() << "updateImage";
-    QImage image2(width() - 2 * borderWidth, 1, QImage::Format_RGB888);
-    if (image2.isNull())
-    {
-        qDebug() << "QImage image2() allocation failed, width():" << width();
-        return false;
-    }
-
-    if (m_pieces.isEmpty())
-    {
-        image2.fill(backgroundColor());
-        image = image2;
-        return true;
-    }
-
-    QVector<float> scaledPieces = bitfieldToFloatVector(m_pieces, image2.width());
-    QVector<float> scaledPiecesDl = bitfieldToFloatVector(m_downloadedPieces, image2.width());
+    const qint64 piecesCount = m_pieces.size();
+    if ((piecesCount == 0) || (pixel >= m_completeWeights.size()))
+        return backgroundColor().rgb();
 
-    // filling image
-    for (int x = 0; x < scaledPieces.size(); ++x)
-    {
-        float piecesToValue = scaledPieces.at(x);
-        float piecesToValueDl = scaledPiecesDl.at(x);
-        if (piecesToValueDl != 0)
-        {
-            float fillRatio = piecesToValue + piecesToValueDl;
-            float ratio = piecesToValueDl / fillRatio;
+    // the weights of a pixel sum up to the pieces count, so the values stay exact
+    const qint64 completeWeight = m_completeWeights[pixel];
+    const qint64 partialWeight = m_partialWeights[pixel];
+    if (partialWeight == 0)
+        return pieceColors()[(completeWeight * 255) / piecesCount];
 
-            QRgb mixedColor = mixTwoColors(pieceColor().rgb(), m_dlPieceColor.rgb(), ratio);
-            mixedColor = mixTwoColors(backgroundColor().rgb(), mixedColor, fillRatio);
+    const float fillRatio = static_cast<float>(completeWeight + partialWeight) / piecesCount;
+    const float ratio = static_cast<float>(partialWeight) / (completeWeight + partialWeight);
 
-            image2.setPixel(x, 0, mixedColor);
-        }
-        else
-        {
-            image2.setPixel(x, 0, pieceColors()[piecesToValue * 255]);
-        }
-    }
-    image = image2;
-    return true;
+    const QRgb mixedColor = mixTwoColors(pieceColor().rgb(), m_dlPieceColor.rgb(), ratio);
+    return mixTwoColors(backgroundColor().rgb(), mixedColor, std::min(fillRatio, 1.0f));
 }
 
 void DownloadedPiecesBar::setProgress(const QBitArray &pieces, const QBitArray &downloadedPieces)
 {
+    const bool canUpdateIncrementally = !m_pieces.isEmpty()
+        && (pieces.size() == m_pieces.size())
+        && (downloadedPieces.size() == m_downloadedPieces.size())
+        && (m_completeWeights.size() == imageWidth());
+    if (!canUpdateIncrementally)
+    {
+        m_pieces = pieces;
+        m_downloadedPieces = downloadedPieces;
+        requestImageUpdate();
+        return;
+    }
+
+    const PixelSpan completeSpan = updateWeights(m_completeWeights, m_pieces, pieces);
+    const PixelSpan partialSpan = updateWeights(m_partialWeights, m_downloadedPieces, downloadedPieces);
     m_pieces = pieces;
     m_downloadedPieces = downloadedPieces;
 
-    requestImageUpdate();
+    // only the pixels of the changed pieces are repainted
+    const int firstPixel = std::min(completeSpan.first, partialSpan.first);
+    const int lastPixel = std::max(completeSpan.last, partialSpan.last);
+    if (firstPixel <= lastPixel)
+        requestImageUpdate(firstPixel, lastPixel);
 }
 
 void DownloadedPiecesBar::clear()
 {
     m_pieces.clear();
     m_downloadedPieces.clear();
+    m_completeWeights.clear();
+    m_partialWeights.clear();
     base::clear();
 }
 
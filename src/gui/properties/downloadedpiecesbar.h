@@ -28,8 +28,10 @@
 
 #pragma once
 
+#include <limits>
+
 #include <QBitArray>
-#include <QtContainerFwd>
+#include <QVector>
 
 #include "piecesbar.h"
 
@@ -50,15 +52,25 @@ public:
     void clear() override;
 
 private:
-    // scale bitfield vector to float vector
-    QVector<float> bitfieldToFloatVector(const QBitArray &vecin, int reqSize);
-    bool updateImage(QImage &image) override;
+    struct PixelSpan
+    {
+        int first = std::numeric_limits<int>::max();
+        int last = -1;
+    };
+
+    // applies the pieces that differ between the bitfields to the per pixel weights
+    // returns the span of pixels that have changed
+    PixelSpan updateWeights(QVector<qint64> &weights, const QBitArray &oldPieces, const QBitArray &newPieces);
+    void rebuildPixelData(int imageWidth) override;
+    QRgb pixelColor(int pixel) const override;
     QString simpleToolTipText() const override;
 
     // incomplete piece color
     const QColor m_dlPieceColor;
-    // last used bitfields, uses to better resize redraw
-    // TODO: make a diff pieces to new pieces and update only changed pixels, speedup when update > 20x faster
+    // last used bitfields, the changed pieces are found by comparing with them
     QBitArray m_pieces;
     QBitArray m_downloadedPieces;
+    // per pixel sums of the overlaps with completed and partial pieces (see PiecesBar::forEachPiecePixel())
+    QVector<qint64> m_completeWeights;
+    QVector<qint64> m_partialWeights;
 };
@@ -0,0 +1,506 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "peerlistmodel.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <QHostAddress>
+
+#include "base/bittorrent/peerinfo.h"
+#include "base/bittorrent/torrent.h"
+#include "base/bittorrent/torrentinfo.h"
+#include "base/global.h"
+#include "base/net/geoipmanager.h"
+#include "base/path.h"
+#include "base/utils/misc.h"
+#include "base/utils/string.h"
+#include "gui/uithememanager.h"
+#include "peerlistwidget.h"
+
+bool operator==(const PeerEndpoint &left, const PeerEndpoint &right)
+{
+    return (left.address == right.address) && (left.connectionType == right.connectionType)
+        && (left.I2PAddress == right.I2PAddress);
+}
+
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+std::size_t qHash(const PeerEndpoint &peerEndpoint, const std::size_t seed)
+{
+    return qHashMulti(seed, peerEndpoint.address, peerEndpoint.connectionType, peerEndpoint.I2PAddress);
+}
+#else
+uint qHash(const PeerEndpoint &peerEndpoint, const uint seed)
+{
+    return (qHash(peerEndpoint.address, seed) ^ ::qHash(peerEndpoint.connectionType) ^ ::qHash(peerEndpoint.I2PAddress));
+}
+#endif
+
+namespace
+{
+    QStringList downloadingFiles(const BitTorrent::Torrent *torrent, const int pieceIndex)
+    {
+        const PathList filePaths = torrent->info().filesForPiece(pieceIndex);
+        QStringList files;
+        files.reserve(filePaths.size());
+        for (const Path &filePath : filePaths)
+            files.append(filePath.toString());
+        return files;
+    }
+}
+
+PeerListModel::PeerListModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+QList<QHostAddress> PeerListModel::updatePeers(const BitTorrent::Torrent *torrent, const QVector<BitTorrent::PeerInfo> &peers)
+{
+    Q_ASSERT(torrent);
+
+    std::vector<bool> stillConnected(m_peers.size(), false);
+    QVector<PeerItem> newPeers;
+    QHash<PeerEndpoint, int> newPeerRows;
+
+    for (const BitTorrent::PeerInfo &peer : peers)
+    {
+        const PeerEndpoint peerEndpoint {peer.address(), peer.connectionType(), peer.I2PAddress()};
+
+        const int row = m_rowsByEndpoint.value(peerEndpoint, -1);
+        if (row >= 0)
+        {
+            if (stillConnected[row])
+                continue;
+
+            stillConnected[row] = true;
+            updatePeerItem(row, torrent, peer);
+        }
+        else if (!newPeerRows.contains(peerEndpoint))
+        {
+            newPeerRows.insert(peerEndpoint, newPeers.size());
+            newPeers.append(createPeerItem(torrent, peer));
+        }
+    }
+
+    // Remove peers that are gone, each run of adjacent rows at once
+    bool isRemoved = false;
+    for (int row = (m_peers.size() - 1); row >= 0; --row)
+    {
+        if (stillConnected[row])
+            continue;
+
+        const int lastRow = row;
+        while ((row > 0) && !stillConnected[row - 1])
+            --row;
+
+        beginRemoveRows({}, row, lastRow);
+        m_peers.remove(row, (lastRow - row + 1));
+        endRemoveRows();
+        isRemoved = true;
+    }
+
+    if (isRemoved)
+        rebuildRowsIndex();
+
+    QList<QHostAddress> newPeerIPs;
+    if (!newPeers.isEmpty())
+    {
+        const int firstRow = m_peers.size();
+        beginInsertRows({}, firstRow, (firstRow + newPeers.size() - 1));
+        for (int i = 0; i < newPeers.size(); ++i)
+        {
+            const PeerItem &item = newPeers[i];
+            m_rowsByEndpoint.insert(item.endpoint, (firstRow + i));
+            if (!item.useI2PSocket)
+                newPeerIPs.append(item.endpoint.address.ip);
+        }
+        m_peers.append(newPeers);
+        endInsertRows();
+    }
+
+    return newPeerIPs;
+}
+
+PeerListModel::PeerItem PeerListModel::createPeerItem(const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer) const
+{
+    PeerItem item;
+    item.endpoint = {peer.address(), peer.connectionType(), peer.I2PAddress()};
+    item.useI2PSocket = peer.useI2PSocket();
+    item.client = peer.client();
+    item.peerIdClient = peer.peerIdClient();
+    item.flags = peer.flags();
+    item.flagsDescription = peer.flagsDescription();
+    item.progress = peer.progress();
+    item.relevance = peer.relevance();
+    item.downSpeed = peer.payloadDownSpeed();
+    item.upSpeed = peer.payloadUpSpeed();
+    item.totalDownload = peer.totalDownload();
+    item.totalUpload = peer.totalUpload();
+    item.downloadingPieceIndex = peer.downloadingPieceIndex();
+    item.downloadingFiles = downloadingFiles(torrent, item.downloadingPieceIndex);
+    if (m_resolveCountries && !item.useI2PSocket)
+        resolveCountry(item);
+
+    return item;
+}
+
+void PeerListModel::updatePeerItem(const int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer)
+{
+    PeerItem &item = m_peers[row];
+    int firstChangedColumn = PeerListWidget::COL_COUNT;
+    int lastChangedColumn = -1;
+
+    const auto update = [&firstChangedColumn, &lastChangedColumn](auto &field, const auto &value, const int column)
+    {
+        if (field == value)
+            return;
+
+        field = value;
+        firstChangedColumn = std::min(firstChangedColumn, column);
+        lastChangedColumn = std::max(lastChangedColumn, column);
+    };
+
+    update(item.client, peer.client(), PeerListWidget::CLIENT);
+    update(item.peerIdClient, peer.peerIdClient(), PeerListWidget::PEERID_CLIENT);
+    update(item.flags, peer.flags(), PeerListWidget::FLAGS);
+    update(item.flagsDescription, peer.flagsDescription(), PeerListWidget::FLAGS);
+    update(item.progress, peer.progress(), PeerListWidget::PROGRESS);
+    update(item.relevance, peer.relevance(), PeerListWidget::RELEVANCE);
+    update(item.downSpeed, peer.payloadDownSpeed(), PeerListWidget::DOWN_SPEED);
+    update(item.upSpeed, peer.payloadUpSpeed(), PeerListWidget::UP_SPEED);
+    update(item.totalDownload, peer.totalDownload(), PeerListWidget::TOT_DOWN);
+    update(item.totalUpload, peer.totalUpload(), PeerListWidget::TOT_UP);
+
+    // The list of files is only looked up when the peer switches to another piece
+    const int downloadingPieceIndex = peer.downloadingPieceIndex();
+    if (item.downloadingPieceIndex != downloadingPieceIndex)
+    {
+        item.downloadingPieceIndex = downloadingPieceIndex;
+        update(item.downloadingFiles, downloadingFiles(torrent, downloadingPieceIndex), PeerListWidget::DOWNLOADING_PIECE);
+    }
+
+    if (lastChangedColumn >= 0)
+        emit dataChanged(index(row, firstChangedColumn), index(row, lastChangedColumn));
+}
+
+void PeerListModel::resolveCountry(PeerItem &item) const
+{
+    // Flag icons are cached by UIThemeManager, so only the GeoIP lookup is done per peer
+    item.country = Net::GeoIPManager::instance()->lookup(item.endpoint.address.ip);
+    item.countryFlag = UIThemeManager::instance()->getFlagIcon(item.country);
+}
+
+void PeerListModel::setHostNames(const QHash<QHostAddress, QString> &hostNames)
+{
+    for (int row = 0; row < m_peers.size(); ++row)
+    {
+        PeerItem &item = m_peers[row];
+        if (item.useI2PSocket)
+            continue;
+
+        const QString hostName = hostNames.value(item.endpoint.address.ip);
+        if (hostName.isEmpty() || (hostName == item.hostName))
+            continue;
+
+        item.hostName = hostName;
+        const QModelIndex ipIndex = index(row, PeerListWidget::IP);
+        emit dataChanged(ipIndex, ipIndex);
+    }
+}
+
+void PeerListModel::setResolveCountries(const bool resolve)
+{
+    if (resolve == m_resolveCountries)
+        return;
+
+    m_resolveCountries = resolve;
+    if (!m_resolveCountries)
+        return;
+
+    for (PeerItem &item : m_peers)
+    {
+        if (!item.useI2PSocket && item.country.isEmpty())
+            resolveCountry(item);
+    }
+    notifyColumnsChanged(PeerListWidget::COUNTRY, PeerListWidget::COUNTRY);
+}
+
+void PeerListModel::setHideZeroValues(const bool hide)
+{
+    if (hide == m_hideZeroValues)
+        return;
+
+    m_hideZeroValues = hide;
+    notifyColumnsChanged(PeerListWidget::DOWN_SPEED, PeerListWidget::TOT_UP);
+}
+
+void PeerListModel::clear()
+{
+    if (m_peers.isEmpty())
+        return;
+
+    beginResetModel();
+    m_peers.clear();
+    m_rowsByEndpoint.clear();
+    endResetModel();
+}
+
+QList<QHostAddress> PeerListModel::peerIPs() const
+{
+    QList<QHostAddress> ips;
+    ips.reserve(m_peers.size());
+    for (const PeerItem &item : m_peers)
+    {
+        if (!item.useI2PSocket)
+            ips.append(item.endpoint.address.ip);
+    }
+    return ips;
+}
+
+void PeerListModel::rebuildRowsIndex()
+{
+    m_rowsByEndpoint.clear();
+    m_rowsByEndpoint.reserve(m_peers.size());
+    for (int row = 0; row < m_peers.size(); ++row)
+        m_rowsByEndpoint.insert(m_peers[row].endpoint, row);
+}
+
+void PeerListModel::notifyColumnsChanged(const int firstColumn, const int lastColumn)
+{
+    if (m_peers.isEmpty())
+        return;
+
+    emit dataChanged(index(0, firstColumn), index((m_peers.size() - 1), lastColumn));
+}
+
+int PeerListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_peers.size();
+}
+
+int PeerListModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : PeerListWidget::COL_COUNT;
+}
+
+QVariant PeerListModel::data(const QModelIndex &index, const int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid))
+        return {};
+
+    const PeerItem &item = m_peers[index.row()];
+    const int column = index.column();
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        return displayValue(item, column);
+
+    case UnderlyingDataRole:
+        return underlyingValue(item, column);
+
+    case Qt::ToolTipRole:
+        return toolTipValue(item, column);
+
+    case Qt::DecorationRole:
+        if ((column == PeerListWidget::COUNTRY) && m_resolveCountries && !item.countryFlag.isNull())
+            return item.countryFlag;
+        return {};
+
+    case Qt::TextAlignmentRole:
+        switch (column)
+        {
+        case PeerListWidget::PORT:
+        case PeerListWidget::PROGRESS:
+        case PeerListWidget::DOWN_SPEED:
+        case PeerListWidget::UP_SPEED:
+        case PeerListWidget::TOT_DOWN:
+        case PeerListWidget::TOT_UP:
+        case PeerListWidget::RELEVANCE:
+            return QVariant {Qt::AlignRight | Qt::AlignVCenter};
+        default:
+            return {};
+        }
+
+    default:
+        return {};
+    }
+}
+
+QString PeerListModel::displayValue(const PeerItem &item, const int column) const
+{
+    const auto unitString = [this](const qint64 value, const bool isSpeed = false) -> QString
+    {
+        return (m_hideZeroValues && (value <= 0))
+            ? QString() : Utils::Misc::friendlyUnit(value, isSpeed);
+    };
+
+    switch (column)
+    {
+    case PeerListWidget::IP:
+        if (!item.hostName.isEmpty())
+            return item.hostName;
+        return item.useI2PSocket ? item.endpoint.I2PAddress : item.endpoint.address.ip.toString();
+    case PeerListWidget::IP_HIDDEN:
+        return item.useI2PSocket ? QString() : item.endpoint.address.ip.toString();
+    case PeerListWidget::PORT:
+        return item.useI2PSocket ? tr("N/A") : QString::number(item.endpoint.address.port);
+    case PeerListWidget::CONNECTION:
+        return item.endpoint.connectionType;
+    case PeerListWidget::FLAGS:
+        return item.flags;
+    case PeerListWidget::CLIENT:
+        return item.client.toHtmlEscaped();
+    case PeerListWidget::PEERID_CLIENT:
+        return item.peerIdClient.toHtmlEscaped();
+    case PeerListWidget::PROGRESS:
+        return (Utils::String::fromDouble(item.progress * 100, 1) + u'%');
+    case PeerListWidget::DOWN_SPEED:
+        return unitString(item.downSpeed, true);
+    case PeerListWidget::UP_SPEED:
+        return unitString(item.upSpeed, true);
+    case PeerListWidget::TOT_DOWN:
+        return unitString(item.totalDownload);
+    case PeerListWidget::TOT_UP:
+        return unitString(item.totalUpload);
+    case PeerListWidget::RELEVANCE:
+        return (Utils::String::fromDouble(item.relevance * 100, 1) + u'%');
+    case PeerListWidget::DOWNLOADING_PIECE:
+        return item.downloadingFiles.join(u';');
+    default:
+        return {};
+    }
+}
+
+QVariant PeerListModel::underlyingValue(const PeerItem &item, const int column) const
+{
+    switch (column)
+    {
+    case PeerListWidget::IP:
+        return item.useI2PSocket ? item.endpoint.I2PAddress : item.endpoint.address.ip.toString();
+    case PeerListWidget::PORT:
+        return item.endpoint.address.port;
+    case PeerListWidget::PROGRESS:
+        return item.progress;
+    case PeerListWidget::DOWN_SPEED:
+        return item.downSpeed;
+    case PeerListWidget::UP_SPEED:
+        return item.upSpeed;
+    case PeerListWidget::TOT_DOWN:
+        return item.totalDownload;
+    case PeerListWidget::TOT_UP:
+        return item.totalUpload;
+    case PeerListWidget::RELEVANCE:
+        return item.relevance;
+    default:
+        return displayValue(item, column);
+    }
+}
+
+QString PeerListModel::toolTipValue(const PeerItem &item, const int column) const
+{
+    switch (column)
+    {
+    case PeerListWidget::COUNTRY:
+        return (m_resolveCountries && !item.countryFlag.isNull())
+            ? Net::GeoIPManager::CountryName(item.country) : QString();
+    case PeerListWidget::IP:
+        return item.useI2PSocket ? item.endpoint.I2PAddress : item.endpoint.address.ip.toString();
+    case PeerListWidget::CLIENT:
+        return item.client.toHtmlEscaped();
+    case PeerListWidget::FLAGS:
+        return item.flagsDescription;
+    case PeerListWidget::DOWNLOADING_PIECE:
+        return item.downloadingFiles.join(u'\n');
+    default:
+        return {};
+    }
+}
+
+QVariant PeerListModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
+{
+    if (orientation != Qt::Horizontal)
+        return {};
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        switch (section)
+        {
+        case PeerListWidget::COUNTRY:
+            return tr("Country/Region");
+        case PeerListWidget::IP:
+            return tr("IP/Address");
+        case PeerListWidget::PORT:
+            return tr("Port");
+        case PeerListWidget::FLAGS:
+            return tr("Flags");
+        case PeerListWidget::CONNECTION:
+            return tr("Connection");
+        case PeerListWidget::CLIENT:
+            return tr("Client", "i.e.: Client application");
+        case PeerListWidget::PEERID_CLIENT:
+            return tr("Peer ID Client", "i.e.: Client resolved from Peer ID");
+        case PeerListWidget::PROGRESS:
+            return tr("Progress", "i.e: % downloaded");
+        case PeerListWidget::DOWN_SPEED:
+            return tr("Down Speed", "i.e: Download speed");
+        case PeerListWidget::UP_SPEED:
+            return tr("Up Speed", "i.e: Upload speed");
+        case PeerListWidget::TOT_DOWN:
+            return tr("Downloaded", "i.e: total data downloaded");
+        case PeerListWidget::TOT_UP:
+            return tr("Uploaded", "i.e: total data uploaded");
+        case PeerListWidget::RELEVANCE:
+            return tr("Relevance", "i.e: How relevant this peer is to us. How many pieces it has that we don't.");
+        case PeerListWidget::DOWNLOADING_PIECE:
+            return tr("Files", "i.e. files that are being downloaded right now");
+        default:
+            return {};
+        }
+
+    case Qt::TextAlignmentRole:
+        switch (section)
+        {
+        case PeerListWidget::PORT:
+        case PeerListWidget::PROGRESS:
+        case PeerListWidget::DOWN_SPEED:
+        case PeerListWidget::UP_SPEED:
+        case PeerListWidget::TOT_DOWN:
+        case PeerListWidget::TOT_UP:
+        case PeerListWidget::RELEVANCE:
+            return QVariant {Qt::AlignRight | Qt::AlignVCenter};
+        default:
+            return {};
+        }
+
+    default:
+        return {};
+    }
+}
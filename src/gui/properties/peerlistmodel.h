@@ -0,0 +1,123 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QIcon>
+#include <QStringList>
+#include <QVector>
+
+#include "base/bittorrent/peeraddress.h"
+
+namespace BitTorrent
+{
+    class PeerInfo;
+    class Torrent;
+}
+
+struct PeerEndpoint
+{
+    BitTorrent::PeerAddress address;
+    QString connectionType; // matches return type of `PeerInfo::connectionType()`
+    QString I2PAddress;
+};
+
+bool operator==(const PeerEndpoint &left, const PeerEndpoint &right);
+
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+std::size_t qHash(const PeerEndpoint &peerEndpoint, std::size_t seed = 0);
+#else
+uint qHash(const PeerEndpoint &peerEndpoint, uint seed = 0);
+#endif
+
+class PeerListModel final : public QAbstractTableModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(PeerListModel)
+
+public:
+    enum Roles
+    {
+        UnderlyingDataRole = Qt::UserRole
+    };
+
+    explicit PeerListModel(QObject *parent = nullptr);
+
+    // Returns IPs of the peers that weren't in the list yet
+    QList<QHostAddress> updatePeers(const BitTorrent::Torrent *torrent, const QVector<BitTorrent::PeerInfo> &peers);
+    void setHostNames(const QHash<QHostAddress, QString> &hostNames);
+    void setResolveCountries(bool resolve);
+    void setHideZeroValues(bool hide);
+    void clear();
+
+    QList<QHostAddress> peerIPs() const;
+
+    int rowCount(const QModelIndex &parent = {}) const override;
+    int columnCount(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    struct PeerItem
+    {
+        PeerEndpoint endpoint;
+        bool useI2PSocket = false;
+        QString hostName;
+        QString client;
+        QString peerIdClient;
+        QString flags;
+        QString flagsDescription;
+        qreal progress = 0;
+        qreal relevance = 0;
+        int downSpeed = 0;
+        int upSpeed = 0;
+        qlonglong totalDownload = 0;
+        qlonglong totalUpload = 0;
+        int downloadingPieceIndex = -1;
+        QStringList downloadingFiles;
+        QString country;
+        QIcon countryFlag;
+    };
+
+    PeerItem createPeerItem(const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer) const;
+    void updatePeerItem(int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer);
+    void resolveCountry(PeerItem &item) const;
+    void rebuildRowsIndex();
+    void notifyColumnsChanged(int firstColumn, int lastColumn);
+
+    QString displayValue(const PeerItem &item, int column) const;
+    QVariant underlyingValue(const PeerItem &item, int column) const;
+    QString toolTipValue(const PeerItem &item, int column) const;
+
+    QVector<PeerItem> m_peers;
+    QHash<PeerEndpoint, int> m_rowsByEndpoint;  // must be kept in sync with `m_peers`
+    bool m_resolveCountries = false;
+    bool m_hideZeroValues = false;
+};
@@ -39,10 +39,8 @@
 #include <QMenu>
 #include <QMessageBox>
 #include <QPointer>
-#include <QSet>
 #include <QShortcut>
 #include <QSortFilterProxyModel>
-#include <QStandardItemModel>
 #include <QVector>
 #include <QWheelEvent>
 
@@ -50,57 +48,17 @@
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/torrent.h"
-#include "base/bittorrent/torrentinfo.h"
 #include "base/global.h"
 #include "base/logger.h"
 #include "base/net/geoipmanager.h"
 #include "base/net/reverseresolution.h"
 #include "base/preferences.h"
-#include "base/utils/misc.h"
-#include "base/utils/string.h"
 #include "gui/uithememanager.h"
+#include "peerlistmodel.h"
 #include "peerlistsortmodel.h"
 #include "peersadditiondialog.h"
 #include "propertieswidget.h"
 
-struct PeerEndpoint
-{
-    BitTorrent::PeerAddress address;
-    QString connectionType; // matches return type of `PeerInfo::connectionType()`
-};
-
-bool operator==(const PeerEndpoint &left, const PeerEndpoint &right)
-{
-    return (left.address == right.address) && (left.connectionType == right.connectionType);
-}
-
-#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
-std::size_t qHash(const PeerEndpoint &peerEndpoint, const std::size_t seed = 0)
-{
-    return qHashMulti(seed, peerEndpoint.address, peerEndpoint.connectionType);
-}
-#else
-uint qHash(const PeerEndpoint &peerEndpoint, const uint seed = 0)
-{
-    return (qHash(peerEndpoint.address, seed) ^ ::qHash(peerEndpoint.connectionType));
-}
-#endif
-
-namespace
-{
-    void setModelData(QStandardItemModel *model, const int row, const int column, const QString &displayData
-            , const QVariant &underlyingData, const Qt::Alignment textAlignmentData = {}, const QString &toolTip = {})
-    {
-        const QMap<int, QVariant> data = {
-            {Qt::DisplayRole, displayData},
-            {PeerListSortModel::UnderlyingDataRole, underlyingData},
-            {Qt::TextAlignmentRole, QVariant {textAlignmentData}},
-            {Qt::ToolTipRole, toolTip}};
-
-        model->setItemData(model->index(row, column), data);
-    }
-}
-
 PeerListWidget::PeerListWidget(PropertiesWidget *parent)
     : QTreeView(parent)
     , m_properties(parent)
@@ -119,29 +77,7 @@ PeerListWidget::PeerListWidget(PropertiesWidget *parent)
     header()->setTextElideMode(Qt::ElideRight);
 
     // List Model
-    m_listModel = new QStandardItemModel(0, PeerListColumns::COL_COUNT, this);
-    m_listModel->setHeaderData(PeerListColumns::COUNTRY, Qt::Horizontal, tr("Country/Region")); // Country flag column
-    m_listModel->setHeaderData(PeerListColumns::IP, Qt::Horizontal, tr("IP/Address"));
-    m_listModel->setHeaderData(PeerListColumns::PORT, Qt::Horizontal, tr("Port"));
-    m_listModel->setHeaderData(PeerListColumns::FLAGS, Qt::Horizontal, tr("Flags"));
-    m_listModel->setHeaderData(PeerListColumns::CONNECTION, Qt::Horizontal, tr("Connection"));
-    m_listModel->setHeaderData(PeerListColumns::CLIENT, Qt::Horizontal, tr("Client", "i.e.: Client application"));
-    m_listModel->setHeaderData(PeerListColumns::PEERID_CLIENT, Qt::Horizontal, tr("Peer ID Client", "i.e.: Client resolved from Peer ID"));
-    m_listModel->setHeaderData(PeerListColumns::PROGRESS, Qt::Horizontal, tr("Progress", "i.e: % downloaded"));
-    m_listModel->setHeaderData(PeerListColumns::DOWN_SPEED, Qt::Horizontal, tr("Down Speed", "i.e: Download speed"));
-    m_listModel->setHeaderData(PeerListColumns::UP_SPEED, Qt::Horizontal, tr("Up Speed", "i.e: Upload speed"));
-    m_listModel->setHeaderData(PeerListColumns::TOT_DOWN, Qt::Horizontal, tr("Downloaded", "i.e: total data downloaded"));
-    m_listModel->setHeaderData(PeerListColumns::TOT_UP, Qt::Horizontal, tr("Uploaded", "i.e: total data uploaded"));
-    m_listModel->setHeaderData(PeerListColumns::RELEVANCE, Qt::Horizontal, tr("Relevance", "i.e: How relevant this peer is to us. How many pieces it has that we don't."));
-    m_listModel->setHeaderData(PeerListColumns::DOWNLOADING_PIECE, Qt::Horizontal, tr("Files", "i.e. files that are being downloaded right now"));
-    // Set header text alignment
-    m_listModel->setHeaderData(PeerListColumns::PORT, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
-    m_listModel->setHeaderData(PeerListColumns::PROGRESS, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
-    m_listModel->setHeaderData(PeerListColumns::DOWN_SPEED, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
-    m_listModel->setHeaderData(PeerListColumns::UP_SPEED, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
-    m_listModel->setHeaderData(PeerListColumns::TOT_DOWN, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
-    m_listModel->setHeaderData(PeerListColumns::TOT_UP, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
-    m_listModel->setHeaderData(PeerListColumns::RELEVANCE, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
+    m_listModel = new PeerListModel(this);
     // Proxy model to support sorting without actually altering the underlying model
     m_proxyModel = new PeerListSortModel(this);
     m_proxyModel->setDynamicSortFilter(true);
@@ -159,6 +95,7 @@ PeerListWidget::PeerListWidget(PropertiesWidget *parent)
     }
 
     m_resolveCountries = Preferences::instance()->resolvePeerCountries();
+    m_listModel->setResolveCountries(m_resolveCountries);
     if (!m_resolveCountries)
         hideColumn(PeerListColumns::COUNTRY);
     // Ensure that at least one column is visible at all times
@@ -258,7 +195,8 @@ void PeerListWidget::updatePeerHostNameResolutionState()
         if (!m_resolver)
         {
             m_resolver = new Net::ReverseResolution(this);
-            connect(m_resolver, &Net::ReverseResolution::ipResolved, this, &PeerListWidget::handleResolved);
+            connect(m_resolver, &Net::ReverseResolution::ipsResolved, this, &PeerListWidget::handleResolved);
+            m_resolver->resolve(m_listModel->peerIPs());
             loadPeers(m_properties->getCurrentTorrent());
         }
     }
@@ -276,6 +214,7 @@ void PeerListWidget::updatePeerCountryResolutionState()
         return;
 
     m_resolveCountries = resolveCountries;
+    m_listModel->setResolveCountries(m_resolveCountries);
     if (m_resolveCountries)
     {
         loadPeers(m_properties->getCurrentTorrent());
@@ -359,9 +298,9 @@ void PeerListWidget::banSelectedPeers()
     for (const QModelIndex &index : selectedIndexes)
     {
         const int row = m_proxyModel->mapToSource(index).row();
-        const QString ip = m_listModel->item(row, PeerListColumns::IP_HIDDEN)->text();
-        const QString client = m_listModel->item(row, PeerListColumns::CLIENT)->text();
-        const QString peerId = m_listModel->item(row, PeerListColumns::PEERID_CLIENT)->text();
+        const QString ip = m_listModel->index(row, PeerListColumns::IP_HIDDEN).data().toString();
+        const QString client = m_listModel->index(row, PeerListColumns::CLIENT).data().toString();
+        const QString peerId = m_listModel->index(row, PeerListColumns::PEERID_CLIENT).data().toString();
 
         QHostAddress host(ip);
         const QString country = Net::GeoIPManager::CountryName(Net::GeoIPManager::instance()->lookup(host));
@@ -392,8 +331,8 @@ void PeerListWidget::copySelectedPeers()
     for (const QModelIndex &index : selectedIndexes)
     {
         const int row = m_proxyModel->mapToSource(index).row();
-        const QString ip = m_listModel->item(row, PeerListColumns::IP_HIDDEN)->text();
-        const QString port = m_listModel->item(row, PeerListColumns::PORT)->text();
+        const QString ip = m_listModel->index(row, PeerListColumns::IP_HIDDEN).data().toString();
+        const QString port = m_listModel->index(row, PeerListColumns::PORT).data().toString();
 
         if (!ip.contains(u'.'))  // IPv6
             selectedPeers << (u'[' + ip + u"]:" + port);
@@ -406,12 +345,10 @@ void PeerListWidget::copySelectedPeers()
 
 void PeerListWidget::clear()
 {
-    m_peerItems.clear();
-    m_I2PPeerItems.clear();
-    m_itemsByIP.clear();
-    const int nbrows = m_listModel->rowCount();
-    if (nbrows > 0)
-        m_listModel->removeRows(0, nbrows);
+    m_listModel->clear();
+    // host names of the peers that are gone aren't needed anymore
+    if (m_resolver)
+        m_resolver->clear();
 }
 
 bool PeerListWidget::loadSettings()
@@ -435,130 +372,16 @@ void PeerListWidget::loadPeers(const BitTorrent::Torrent *torrent)
         if (torrent != m_properties->getCurrentTorrent())
             return;
 
-        // Remove I2P peers since they will be completely reloaded.
-        for (QStandardItem *item : asConst(m_I2PPeerItems))
-            m_listModel->removeRow(item->row());
-        m_I2PPeerItems.clear();
-
-        QSet<PeerEndpoint> existingPeers;
-        existingPeers.reserve(m_peerItems.size());
-        for (auto i = m_peerItems.cbegin(); i != m_peerItems.cend(); ++i)
-            existingPeers.insert(i.key());
-
-        const bool hideZeroValues = Preferences::instance()->getHideZeroValues();
-        for (const BitTorrent::PeerInfo &peer : peers)
-        {
-            const PeerEndpoint peerEndpoint {peer.address(), peer.connectionType()};
-
-            auto itemIter = m_peerItems.find(peerEndpoint);
-            const bool isNewPeer = (itemIter == m_peerItems.end());
-            const int row = isNewPeer ? m_listModel->rowCount() : (*itemIter)->row();
-            if (isNewPeer)
-            {
-                m_listModel->insertRow(row);
-
-                const bool useI2PSocket = peer.useI2PSocket();
-
-                const QString peerIPString = useI2PSocket ? peer.I2PAddress() : peerEndpoint.address.ip.toString();
-                setModelData(m_listModel, row, PeerListColumns::IP, peerIPString, peerIPString, {}, peerIPString);
-
-                const QString peerIPHiddenString = useI2PSocket ? QString() : peerEndpoint.address.ip.toString();
-                setModelData(m_listModel, row, PeerListColumns::IP_HIDDEN, peerIPHiddenString, peerIPHiddenString);
-
-                const QString peerPortString = useI2PSocket ? tr("N/A") : QString::number(peer.address().port);
-                setModelData(m_listModel, row, PeerListColumns::PORT, peerPortString, peer.address().port, (Qt::AlignRight | Qt::AlignVCenter));
-
-                if (useI2PSocket)
-                {
-                    m_I2PPeerItems.append(m_listModel->item(row, PeerListColumns::IP));
-                }
-                else
-                {
-                    itemIter = m_peerItems.insert(peerEndpoint, m_listModel->item(row, PeerListColumns::IP));
-                    m_itemsByIP[peerEndpoint.address.ip].insert(itemIter.value());
-                }
-            }
-            else
-            {
-                existingPeers.remove(peerEndpoint);
-            }
-
-            updatePeer(row, torrent, peer, hideZeroValues);
-        }
-
-        // Remove peers that are gone
-        for (const PeerEndpoint &peerEndpoint : asConst(existingPeers))
-        {
-            QStandardItem *item = m_peerItems.take(peerEndpoint);
-
-            QSet<QStandardItem *> &items = m_itemsByIP[peerEndpoint.address.ip];
-            items.remove(item);
-            if (items.isEmpty())
-                m_itemsByIP.remove(peerEndpoint.address.ip);
+        // Only the changed values of the known peers are updated
+        m_listModel->setHideZeroValues(Preferences::instance()->getHideZeroValues());
+        const QList<QHostAddress> newPeerIPs = m_listModel->updatePeers(torrent, peers);
 
-            m_listModel->removeRow(item->row());
-        }
+        // Host names of new peers are resolved at once
+        if (m_resolver && !newPeerIPs.isEmpty())
+            m_resolver->resolve(newPeerIPs);
     });
 }
 
-void PeerListWidget::updatePeer(const int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer, const bool hideZeroValues)
-{
-    const Qt::Alignment intDataTextAlignment = Qt::AlignRight | Qt::AlignVCenter;
-
-    const QString client = peer.client().toHtmlEscaped();
-    setModelData(m_listModel, row, PeerListColumns::CLIENT, client, client, {}, client);
-
-    const QString peerIdClient = peer.peerIdClient().toHtmlEscaped();
-    setModelData(m_listModel, row, PeerListColumns::PEERID_CLIENT, peerIdClient, peerIdClient);
-
-    const QString downSpeed = (hideZeroValues && (peer.payloadDownSpeed() <= 0))
-            ? QString() : Utils::Misc::friendlyUnit(peer.payloadDownSpeed(), true);
-    setModelData(m_listModel, row, PeerListColumns::DOWN_SPEED, downSpeed, peer.payloadDownSpeed(), intDataTextAlignment);
-
-    const QString upSpeed = (hideZeroValues && (peer.payloadUpSpeed() <= 0))
-            ? QString() : Utils::Misc::friendlyUnit(peer.payloadUpSpeed(), true);
-    setModelData(m_listModel, row, PeerListColumns::UP_SPEED, upSpeed, peer.payloadUpSpeed(), intDataTextAlignment);
-
-    const QString totalDown = (hideZeroValues && (peer.totalDownload() <= 0))
-            ? QString() : Utils::Misc::friendlyUnit(peer.totalDownload());
-    setModelData(m_listModel, row, PeerListColumns::TOT_DOWN, totalDown, peer.totalDownload(), intDataTextAlignment);
-
-    const QString totalUp = (hideZeroValues && (peer.totalUpload() <= 0))
-            ? QString() : Utils::Misc::friendlyUnit(peer.totalUpload());
-    setModelData(m_listModel, row, PeerListColumns::TOT_UP, totalUp, peer.totalUpload(), intDataTextAlignment);
-
-    setModelData(m_listModel, row, PeerListColumns::CONNECTION, peer.connectionType(), peer.connectionType());
-    setModelData(m_listModel, row, PeerListColumns::FLAGS, peer.flags(), peer.flags(), {}, peer.flagsDescription());
-    setModelData(m_listModel, row, PeerListColumns::PROGRESS, (Utils::String::fromDouble(peer.progress() * 100, 1) + u'%')
-            , peer.progress(), intDataTextAlignment);
-    setModelData(m_listModel, row, PeerListColumns::RELEVANCE, (Utils::String::fromDouble(peer.relevance() * 100, 1) + u'%')
-            , peer.relevance(), intDataTextAlignment);
-
-    const PathList filePaths = torrent->info().filesForPiece(peer.downloadingPieceIndex());
-    QStringList downloadingFiles;
-    downloadingFiles.reserve(filePaths.size());
-    for (const Path &filePath : filePaths)
-        downloadingFiles.append(filePath.toString());
-
-    const QString downloadingFilesDisplayValue = downloadingFiles.join(u';');
-    setModelData(m_listModel, row, PeerListColumns::DOWNLOADING_PIECE, downloadingFilesDisplayValue
-            , downloadingFilesDisplayValue, {}, downloadingFiles.join(u'\n'));
-
-    if (!peer.useI2PSocket() && m_resolver)
-        m_resolver->resolve(peer.address().ip);
-
-    if (m_resolveCountries)
-    {
-        const QIcon icon = UIThemeManager::instance()->getFlagIcon(peer.country());
-        if (!icon.isNull())
-        {
-            m_listModel->setData(m_listModel->index(row, PeerListColumns::COUNTRY), icon, Qt::DecorationRole);
-            const QString countryName = Net::GeoIPManager::CountryName(peer.country());
-            m_listModel->setData(m_listModel->index(row, PeerListColumns::COUNTRY), countryName, Qt::ToolTipRole);
-        }
-    }
-}
-
 int PeerListWidget::visibleColumnsCount() const
 {
     int count = 0;
@@ -571,14 +394,9 @@ int PeerListWidget::visibleColumnsCount() const
     return count;
 }
 
-void PeerListWidget::handleResolved(const QHostAddress &ip, const QString &hostname) const
+void PeerListWidget::handleResolved(const QHash<QHostAddress, QString> &hostnames) const
 {
-    if (hostname.isEmpty())
-        return;
-
-    const QSet<QStandardItem *> items = m_itemsByIP.value(ip);
-    for (QStandardItem *item : items)
-        item->setData(hostname, Qt::DisplayRole);
+    m_listModel->setHostNames(hostnames);
 }
 
 void PeerListWidget::handleSortColumnChanged(const int col)
@@ -29,22 +29,17 @@
 #pragma once
 
 #include <QHash>
-#include <QSet>
 #include <QTreeView>
 
 class QHostAddress;
-class QStandardItem;
-class QStandardItemModel;
 
+class PeerListModel;
 class PeerListSortModel;
 class PropertiesWidget;
 
-struct PeerEndpoint;
-
 namespace BitTorrent
 {
     class Torrent;
-    class PeerInfo;
 }
 
 namespace Net
@@ -95,20 +90,16 @@ private slots:
     void banSelectedPeers();
     void copySelectedPeers();
     void handleSortColumnChanged(int col);
-    void handleResolved(const QHostAddress &ip, const QString &hostname) const;
+    void handleResolved(const QHash<QHostAddress, QString> &hostnames) const;
 
 private:
-    void updatePeer(int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer, bool hideZeroValues);
     int visibleColumnsCount() const;
 
     void wheelEvent(QWheelEvent *event) override;
 
-    QStandardItemModel *m_listModel = nullptr;
+    PeerListModel *m_listModel = nullptr;
     PeerListSortModel *m_proxyModel = nullptr;
     PropertiesWidget *m_properties = nullptr;
     Net::ReverseResolution *m_resolver = nullptr;
-    QHash<PeerEndpoint, QStandardItem *> m_peerItems;
-    QList<QStandardItem *> m_I2PPeerItems;
-    QHash<QHostAddress, QSet<QStandardItem *>> m_itemsByIP;  // must be kept in sync with `m_peerItems`
     bool m_resolveCountries;
 };
@@ -29,9 +29,7 @@
 #include "pieceavailabilitybar.h"
 
 #include <algorithm>
-#include <cmath>
-
-#include <QDebug>
+#include <limits>
 
 #include "base/global.h"
 
@@ -40,130 +38,90 @@ PieceAvailabilityBar::PieceAvailabilityBar(QWidget *parent)
 {
 }
 
-QVector<float> PieceAvailabilityBar::intToFloatVector(const QVector<int> &vecin, int reqSize)
+void PieceAvailabilityBar::rebuildPixelData(const int imageWidth)
 {
-    QVector<float> result(reqSize, 0.0);
-    if (vecin.isEmpty()) return result;
-
-    const float ratio = static_cast<float>(vecin.size()) / reqSize;
-
-    const int maxElement = *std::max_element(vecin.begin(), vecin.end());
+    m_weights.fill(0, imageWidth);
 
-    // std::max because in normalization we don't want divide by 0
-    // if maxElement == 0 check will be disabled please enable this line:
-    // const int maxElement = std::max(*std::max_element(avail.begin(), avail.end()), 1);
+    const int piecesCount = m_pieces.size();
+    if ((piecesCount == 0) || (imageWidth == 0))
+        return;
 
-    if (maxElement == 0)
-        return result;
-
-    // simple linear transformation algorithm
-    // for example:
-    // image.x(0) = pieces.x(0.0 >= x < 1.7)
-    // image.x(1) = pieces.x(1.7 >= x < 3.4)
-
-    for (int x = 0; x < reqSize; ++x)
+    for (int pieceIndex = 0; pieceIndex < piecesCount; ++pieceIndex)
     {
-        // R - real
-        const float fromR = x * ratio;
-        const float toR = (x + 1) * ratio;
-
-        // C - integer
-        int fromC = fromR;// std::floor not needed
-        int toC = std::ceil(toR);
-        if (toC > vecin.size())
-            --toC;
+        const int availability = m_pieces[pieceIndex];
+        if (availability == 0)
+            continue;
 
-        // position in pieces table
-        int x2 = fromC;
-
-        // little speed up for really big pieces table, 10K+ size
-        const int toCMinusOne = toC - 1;
-
-        // value in returned vector
-        float value = 0;
-
-        // case when calculated range is (15.2 >= x < 15.7)
-        if (x2 == toCMinusOne)
+        forEachPiecePixel(pieceIndex, piecesCount, imageWidth, [this, availability](const int pixel, const qint64 overlap)
         {
-            if (vecin[x2])
-                value += ratio * vecin[x2];
-            ++x2;
-        }
-        // case when (15.2 >= x < 17.8)
-        else
-        {
-            // subcase (15.2 >= x < 16)
-            if (x2 != fromR)
-            {
-                if (vecin[x2])
-                    value += (1.0 - (fromR - fromC)) * vecin[x2];
-                ++x2;
-            }
-
-            // subcase (16 >= x < 17)
-            for (; x2 < toCMinusOne; ++x2)
-                if (vecin[x2])
-                    value += vecin[x2];
-
-            // subcase (17 >= x < 17.8)
-            if (x2 == toCMinusOne)
-            {
-                if (vecin[x2])
-                    value += (1.0 - (toC - toR)) * vecin[x2];
-                ++x2;
-            }
-        }
-
-        // normalization <0, 1>
-        value /= ratio * maxElement;
-
-        // float precision sometimes gives > 1, because it's not possible to store irrational numbers
-        value = std::min(value, 1.0f);
-
-        result[x] = value;
+            m_weights[pixel] += availability * overlap;
+        });
     }
+}
 
-    return result;
+QRgb PieceAvailabilityBar::pixelColor(const int pixel) const
+{
+    const qint64 piecesCount = m_pieces.size();
+    if ((piecesCount == 0) || (m_maxAvailability == 0) || (pixel >= m_weights.size()))
+        return pieceColors()[0];
+
+    // normalization <0, 255>, the weights of a pixel sum up to the pieces count at most availability
+    const qint64 value = (m_weights[pixel] * 255) / (piecesCount * m_maxAvailability);
+    return pieceColors()[std::clamp<qint64>(value, 0, 255)];
 }
 
-bool PieceAvailabilityBar::updateImage(QImage &image)
+void PieceAvailabilityBar::setAvailability(const QVector<int> &avail)
 {
-    QImage image2(width() - 2 * borderWidth, 1, QImage::Format_RGB888);
-    if (image2.isNull())
+    const int maxAvailability = avail.isEmpty() ? 0 : *std::max_element(avail.cbegin(), avail.cend());
+
+    const int piecesCount = avail.size();
+    const int imageWidth = this->imageWidth();
+    const bool canUpdateIncrementally = !m_pieces.isEmpty()
+        && (piecesCount == m_pieces.size())
+        && (m_weights.size() == imageWidth);
+    if (!canUpdateIncrementally)
     {
-        qDebug() << "QImage image2() allocation failed, width():" << width();
-        return false;
+        m_pieces = avail;
+        m_maxAvailability = maxAvailability;
+        requestImageUpdate();
+        return;
     }
 
-    if (m_pieces.empty())
+    int firstPixel = std::numeric_limits<int>::max();
+    int lastPixel = -1;
+    for (int pieceIndex = 0; pieceIndex < piecesCount; ++pieceIndex)
     {
-        image2.fill(backgroundColor());
-        image = image2;
-        return true;
-    }
+        const int delta = avail[pieceIndex] - m_pieces[pieceIndex];
+        if (delta == 0)
+            continue;
 
-    QVector<float> scaledPieces = intToFloatVector(m_pieces, image2.width());
+        forEachPiecePixel(pieceIndex, piecesCount, imageWidth, [this, delta, &firstPixel, &lastPixel](const int pixel, const qint64 overlap)
+        {
+            m_weights[pixel] += delta * overlap;
+            firstPixel = std::min(firstPixel, pixel);
+            lastPixel = std::max(lastPixel, pixel);
+        });
+    }
+    m_pieces = avail;
 
-    // filling image
-    for (int x = 0; x < scaledPieces.size(); ++x)
+    // the whole bar is normalized by the maximum availability
+    if (maxAvailability != m_maxAvailability)
     {
-        float piecesToValue = scaledPieces.at(x);
-        image2.setPixel(x, 0, pieceColors()[piecesToValue * 255]);
+        m_maxAvailability = maxAvailability;
+        firstPixel = 0;
+        lastPixel = imageWidth - 1;
     }
-    image = image2;
-    return true;
-}
-
-void PieceAvailabilityBar::setAvailability(const QVector<int> &avail)
-{
-    m_pieces = avail;
 
-    requestImageUpdate();
+    // only the pixels of the changed pieces are repainted
+    if (firstPixel <= lastPixel)
+        requestImageUpdate(firstPixel, lastPixel);
 }
 
 void PieceAvailabilityBar::clear()
 {
     m_pieces.clear();
+    m_maxAvailability = 0;
+    m_weights.clear();
     base::clear();
 }
 
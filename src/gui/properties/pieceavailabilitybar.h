@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <QVector>
+
 #include "piecesbar.h"
 
 class PieceAvailabilityBar final : public PiecesBar
@@ -46,13 +48,13 @@ public:
     void clear() override;
 
 private:
-    bool updateImage(QImage &image) override;
+    void rebuildPixelData(int imageWidth) override;
+    QRgb pixelColor(int pixel) const override;
     QString simpleToolTipText() const override;
 
-    // last used int vector, uses to better resize redraw
-    // TODO: make a diff pieces to new pieces and update only changed pixels, speedup when update > 20x faster
+    // last used int vector, the changed pieces are found by comparing with it
     QVector<int> m_pieces;
-
-    // scale int vector to float vector
-    QVector<float> intToFloatVector(const QVector<int> &vecin, int reqSize);
+    int m_maxAvailability = 0;
+    // per pixel sums of the piece availabilities weighted by their overlaps (see PiecesBar::forEachPiecePixel())
+    QVector<qint64> m_weights;
 };
@@ -29,6 +29,8 @@
 
 #include "piecesbar.h"
 
+#include <algorithm>
+
 #include <QApplication>
 #include <QDebug>
 #include <QHelpEvent>
@@ -206,6 +208,45 @@ void PiecesBar::requestImageUpdate()
         update();
 }
 
+void PiecesBar::requestImageUpdate(const int firstPixel, const int lastPixel)
+{
+    if (m_image.isNull() || (m_image.width() != imageWidth()))
+    {
+        requestImageUpdate();
+        return;
+    }
+
+    fillImage(m_image, firstPixel, lastPixel);
+    update(QRect((firstPixel + borderWidth), borderWidth, (lastPixel - firstPixel + 1), (height() - 2 * borderWidth)));
+}
+
+int PiecesBar::imageWidth() const
+{
+    return std::max((width() - 2 * borderWidth), 0);
+}
+
+bool PiecesBar::updateImage(QImage &image)
+{
+    QImage image2(imageWidth(), 1, QImage::Format_RGB32);
+    if (image2.isNull())
+    {
+        qDebug() << "QImage image2() allocation failed, width():" << width();
+        return false;
+    }
+
+    rebuildPixelData(image2.width());
+    fillImage(image2, 0, (image2.width() - 1));
+    image = image2;
+    return true;
+}
+
+void PiecesBar::fillImage(QImage &image, const int firstPixel, const int lastPixel) const
+{
+    auto *pixels = reinterpret_cast<QRgb *>(image.scanLine(0));
+    for (int pixel = std::max(firstPixel, 0), end = std::min(lastPixel, (image.width() - 1)); pixel <= end; ++pixel)
+        pixels[pixel] = pixelColor(pixel);
+}
+
 QColor PiecesBar::backgroundColor() const
 {
     return palette().color(QPalette::Base);
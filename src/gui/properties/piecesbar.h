@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include <QColor>
 #include <QImage>
 #include <QWidget>
@@ -69,6 +71,9 @@ protected:
 
     void paintEvent(QPaintEvent *e) override;
     void requestImageUpdate();
+    // repaints only the given span of pixels if the image is up to date otherwise
+    void requestImageUpdate(int firstPixel, int lastPixel);
+    int imageWidth() const;
 
     QColor backgroundColor() const;
     QColor borderColor() const;
@@ -79,6 +84,22 @@ protected:
     // mix two colors by light model, ratio <0, 1>
     static QRgb mixTwoColors(QRgb rgb1, QRgb rgb2, float ratio);
 
+    // Calls `func(pixel, overlap)` for each image pixel covered by the piece.
+    // Pieces and pixels are measured in integer units where a piece is `imageWidth` long
+    // and a pixel is `piecesCount` long, so the overlaps of a pixel sum up to `piecesCount`.
+    template <typename Func>
+    static void forEachPiecePixel(int pieceIndex, int piecesCount, int imageWidth, Func func)
+    {
+        const qint64 pieceBegin = static_cast<qint64>(pieceIndex) * imageWidth;
+        const qint64 pieceEnd = pieceBegin + imageWidth;
+        for (qint64 pixel = (pieceBegin / piecesCount); (pixel * piecesCount) < pieceEnd; ++pixel)
+        {
+            const qint64 pixelBegin = pixel * piecesCount;
+            const qint64 overlap = std::min(pieceEnd, (pixelBegin + piecesCount)) - std::max(pieceBegin, pixelBegin);
+            func(static_cast<int>(pixel), overlap);
+        }
+    }
+
     static constexpr int borderWidth = 1;
 
 private:
@@ -87,9 +108,14 @@ private:
 
     virtual QString simpleToolTipText() const = 0;
 
+    // recalculate the per pixel data for the given image width
+    virtual void rebuildPixelData(int imageWidth) = 0;
+    virtual QRgb pixelColor(int pixel) const = 0;
+
     // draw new image to replace the actual image
     // returns true if image was successfully updated
-    virtual bool updateImage(QImage &image) = 0;
+    bool updateImage(QImage &image);
+    void fillImage(QImage &image, int firstPixel, int lastPixel) const;
     void updatePieceColors();
 
     const BitTorrent::Torrent *m_torrent = nullptr;
@@ -517,20 +517,20 @@ void SearchJobWidget::appendSearchResults(const QVector<SearchResult> &results)
 {
     for (const SearchResult &result : results)
     {
-        // Add item to search result list
-        int row = m_searchListModel->rowCount();
-        m_searchListModel->insertRow(row);
-
-        const auto setModelData = [this, row] (const int column, const QString &displayData
-                                               , const QVariant &underlyingData, const Qt::Alignment textAlignmentData = {})
+        // Each row is inserted with its data already set, so the sort model
+        // places it once instead of re-sorting on every cell change
+        QList<QStandardItem *> row;
+        row.reserve(SearchSortModel::NB_SEARCH_COLUMNS);
+        for (int i = 0; i < SearchSortModel::NB_SEARCH_COLUMNS; ++i)
+            row.append(new QStandardItem);
+
+        const auto setModelData = [&row] (const int column, const QString &displayData
+                                          , const QVariant &underlyingData, const Qt::Alignment textAlignmentData = {})
         {
-            const QMap<int, QVariant> data =
-            {
-                {Qt::DisplayRole, displayData},
-                {SearchSortModel::UnderlyingDataRole, underlyingData},
-                {Qt::TextAlignmentRole, QVariant {textAlignmentData}}
-            };
-            m_searchListModel->setItemData(m_searchListModel->index(row, column), data);
+            QStandardItem *item = row[column];
+            item->setData(displayData, Qt::DisplayRole);
+            item->setData(underlyingData, SearchSortModel::UnderlyingDataRole);
+            item->setData(QVariant {textAlignmentData}, Qt::TextAlignmentRole);
         };
 
         setModelData(SearchSortModel::NAME, result.fileName, result.fileName);
@@ -540,6 +540,8 @@ void SearchJobWidget::appendSearchResults(const QVector<SearchResult> &results)
         setModelData(SearchSortModel::SIZE, Utils::Misc::friendlyUnit(result.fileSize), result.fileSize, (Qt::AlignRight | Qt::AlignVCenter));
         setModelData(SearchSortModel::SEEDS, QString::number(result.nbSeeders), result.nbSeeders, (Qt::AlignRight | Qt::AlignVCenter));
         setModelData(SearchSortModel::LEECHES, QString::number(result.nbLeechers), result.nbLeechers, (Qt::AlignRight | Qt::AlignVCenter));
+
+        m_searchListModel->appendRow(row);
     }
 
     updateResultsCount();
@@ -96,6 +96,11 @@ void StatsDialog::update()
 #endif
     // Buffers size
     m_ui->labelTotalBuf->setText(Utils::Misc::friendlyUnit(cs.totalUsedBuffers * 16 * 1024));
+    // Torrents metadata
+    m_ui->labelHotMetadata->setText(tr("%1 (%2 torrents)").arg(Utils::Misc::friendlyUnit(ss.hotMetadataMemoryUsage)
+            , QString::number(ss.hotTorrentsCount)));
+    m_ui->labelColdMetadata->setText(tr("%1 (%2 torrents)").arg(Utils::Misc::friendlyUnit(ss.coldMetadataMemoryUsage)
+            , QString::number(ss.coldTorrentsCount)));
     // Disk overload (100%) equivalent
     // From lt manual: disk_write_queue and disk_read_queue are the number of peers currently waiting on a disk write or disk read
     // to complete before it receives or sends any more data on the socket. It's a metric of how disk bound you are.
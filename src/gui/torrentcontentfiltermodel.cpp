@@ -113,26 +113,7 @@ bool TorrentContentFilterModel::lessThan(const QModelIndex &left, const QModelIn
 bool TorrentContentFilterModel::hasFiltered(const QModelIndex &folder) const
 {
     // this should be called only with folders
-    // check if the folder name itself matches the filter string
-    QString name = folder.data().toString();
-    if (name.contains(filterRegularExpression()))
-        return true;
-
-    for (int child = 0; child < m_model->rowCount(folder); ++child)
-    {
-        QModelIndex childIndex = m_model->index(child, 0, folder);
-        if (m_model->hasChildren(childIndex))
-        {
-            if (hasFiltered(childIndex))
-                return true;
-
-            continue;
-        }
-
-        name = childIndex.data().toString();
-        if (name.contains(filterRegularExpression()))
-            return true;
-    }
-
-    return false;
+    // the model checks the folder name itself as well as the names of its descendants,
+    // including the ones that weren't fetched yet
+    return m_model->folderContainsMatch(folder, filterRegularExpression());
 }
@@ -35,6 +35,7 @@
 #include <QFileInfo>
 #include <QIcon>
 #include <QPointer>
+#include <QRegularExpression>
 #include <QScopeGuard>
 
 #if defined(Q_OS_WIN)
@@ -70,6 +71,12 @@
 
 namespace
 {
+    // The same as file item displays, so that folders get exactly the sum of their files
+    qulonglong remainingSize(const qulonglong size, const qreal progress)
+    {
+        return static_cast<qulonglong>(size * (1.0 - progress));
+    }
+
     class UnifiedFileIconProvider : public QFileIconProvider
     {
     public:
@@ -212,21 +219,53 @@ TorrentContentModel::~TorrentContentModel()
     delete m_rootItem;
 }
 
+TorrentContentModelFolder *TorrentContentModel::folderItem(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return m_rootItem;
+
+    auto *item = static_cast<TorrentContentModelItem *>(index.internalPointer());
+    return (item->itemType() == TorrentContentModelItem::FolderType)
+        ? static_cast<TorrentContentModelFolder *>(item)
+        : nullptr;
+}
+
+void TorrentContentModel::updateFileData(const int fileIndex, const TorrentContentModelFolder::FileData &fileData)
+{
+    TorrentContentModelFolder *parentFolder = m_fileParents[fileIndex];
+    parentFolder->removeFile(m_filesData[fileIndex]);
+    m_filesData[fileIndex] = fileData;
+    parentFolder->addFile(fileData);
+
+    if (TorrentContentModelFile *fileItem = m_filesIndex[fileIndex])
+    {
+        fileItem->setProgress(fileData.progress);
+        fileItem->setAvailability(fileData.availability);
+        fileItem->setPriority(fileData.priority);
+    }
+}
+
 void TorrentContentModel::updateFilesProgress()
 {
     Q_ASSERT(m_contentHandler && m_contentHandler->hasMetadata());
 
     const QVector<qreal> &filesProgress = m_contentHandler->filesProgress();
-    Q_ASSERT(m_filesIndex.size() == filesProgress.size());
+    Q_ASSERT(m_filesData.size() == filesProgress.size());
     // XXX: Why is this necessary?
-    if (Q_UNLIKELY(m_filesIndex.size() != filesProgress.size()))
+    if (Q_UNLIKELY(m_filesData.size() != filesProgress.size()))
         return;
 
+    // Only the folders containing changed files need to be updated
     for (int i = 0; i < filesProgress.size(); ++i)
-        m_filesIndex[i]->setProgress(filesProgress[i]);
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    m_rootItem->recalculateAvailability();
+    {
+        if (m_filesData[i].progress == filesProgress[i])
+            continue;
+
+        TorrentContentModelFolder::FileData fileData = m_filesData[i];
+        fileData.progress = filesProgress[i];
+        fileData.remaining = remainingSize(fileData.size, fileData.progress);
+        updateFileData(i, fileData);
+    }
 }
 
 void TorrentContentModel::updateFilesPriorities()
@@ -234,13 +273,20 @@ void TorrentContentModel::updateFilesPriorities()
     Q_ASSERT(m_contentHandler && m_contentHandler->hasMetadata());
 
     const QVector<BitTorrent::DownloadPriority> fprio = m_contentHandler->filePriorities();
-    Q_ASSERT(m_filesIndex.size() == fprio.size());
+    Q_ASSERT(m_filesData.size() == fprio.size());
     // XXX: Why is this necessary?
-    if (m_filesIndex.size() != fprio.size())
+    if (m_filesData.size() != fprio.size())
         return;
 
     for (int i = 0; i < fprio.size(); ++i)
-        m_filesIndex[i]->setPriority(static_cast<BitTorrent::DownloadPriority>(fprio[i]));
+    {
+        if (m_filesData[i].priority == fprio[i])
+            continue;
+
+        TorrentContentModelFolder::FileData fileData = m_filesData[i];
+        fileData.priority = fprio[i];
+        updateFileData(i, fileData);
+    }
 }
 
 void TorrentContentModel::updateFilesAvailability()
@@ -253,15 +299,20 @@ void TorrentContentModel::updateFilesAvailability()
         if (handler != m_contentHandler)
             return;
 
-        Q_ASSERT(m_filesIndex.size() == availableFileFractions.size());
+        Q_ASSERT(m_filesData.size() == availableFileFractions.size());
         // XXX: Why is this necessary?
-        if (Q_UNLIKELY(m_filesIndex.size() != availableFileFractions.size()))
+        if (Q_UNLIKELY(m_filesData.size() != availableFileFractions.size()))
             return;
 
-        for (int i = 0; i < m_filesIndex.size(); ++i)
-            m_filesIndex[i]->setAvailability(availableFileFractions[i]);
-        // Update folders progress in the tree
-        m_rootItem->recalculateProgress();
+        for (int i = 0; i < m_filesData.size(); ++i)
+        {
+            if (m_filesData[i].availability == availableFileFractions[i])
+                continue;
+
+            TorrentContentModelFolder::FileData fileData = m_filesData[i];
+            fileData.availability = availableFileFractions[i];
+            updateFileData(i, fileData);
+        }
     });
 }
 
@@ -269,22 +320,49 @@ bool TorrentContentModel::setItemPriority(const QModelIndex &index, BitTorrent::
 {
     Q_ASSERT(index.isValid());
 
+    // "Mixed" can only be the result of the files having different priorities
+    if (priority == BitTorrent::DownloadPriority::Mixed)
+        return false;
+
     auto *item = static_cast<TorrentContentModelItem *>(index.internalPointer());
     const BitTorrent::DownloadPriority currentPriority = item->priority();
     if (currentPriority == priority)
         return false;
 
-    item->setPriority(priority);
-    m_contentHandler->prioritizeFiles(getFilePriorities());
+    const auto setFilePriority = [this, priority](const int fileIndex)
+    {
+        if (m_filesData[fileIndex].priority == priority)
+            return;
+
+        TorrentContentModelFolder::FileData fileData = m_filesData[fileIndex];
+        fileData.priority = priority;
+        updateFileData(fileIndex, fileData);
+    };
 
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    m_rootItem->recalculateAvailability();
+    if (item->itemType() == TorrentContentModelItem::FileType)
+    {
+        setFilePriority(static_cast<TorrentContentModelFile *>(item)->fileIndex());
+    }
+    else
+    {
+        QVector<const TorrentContentModelFolder *> folders {static_cast<TorrentContentModelFolder *>(item)};
+        while (!folders.isEmpty())
+        {
+            const TorrentContentModelFolder *folder = folders.takeLast();
+            for (const int fileIndex : folder->fileIndexes())
+                setFilePriority(fileIndex);
+            for (const TorrentContentModelFolder *subfolder : folder->subfolders())
+                folders.append(subfolder);
+        }
+    }
+
+    m_contentHandler->prioritizeFiles(getFilePriorities());
 
     const QVector<ColumnInterval> columns =
     {
         {TorrentContentModelItem::COL_NAME, TorrentContentModelItem::COL_NAME},
-        {TorrentContentModelItem::COL_PRIO, TorrentContentModelItem::COL_PRIO}
+        {TorrentContentModelItem::COL_PROGRESS, TorrentContentModelItem::COL_REMAINING},
+        {TorrentContentModelItem::COL_AVAILABILITY, TorrentContentModelItem::COL_AVAILABILITY}
     };
     notifySubtreeUpdated(index, columns);
 
@@ -294,9 +372,9 @@ bool TorrentContentModel::setItemPriority(const QModelIndex &index, BitTorrent::
 QVector<BitTorrent::DownloadPriority> TorrentContentModel::getFilePriorities() const
 {
     QVector<BitTorrent::DownloadPriority> prio;
-    prio.reserve(m_filesIndex.size());
-    for (const TorrentContentModelFile *file : asConst(m_filesIndex))
-        prio.push_back(file->priority());
+    prio.reserve(m_filesData.size());
+    for (const TorrentContentModelFolder::FileData &fileData : asConst(m_filesData))
+        prio.push_back(fileData.priority);
     return prio;
 }
 
@@ -353,6 +431,8 @@ bool TorrentContentModel::setData(const QModelIndex &index, const QVariant &valu
                     }
 
                     item->setName(newName);
+                    if (item->itemType() == TorrentContentModelItem::FileType)
+                        m_fileNames[static_cast<TorrentContentModelFile *>(item)->fileIndex()] = newName;
                     emit dataChanged(index, index);
                     return true;
                 }
@@ -426,14 +506,7 @@ QVariant TorrentContentModel::data(const QModelIndex &index, const int role) con
             Q_ASSERT(item->itemType() == TorrentContentModelItem::FolderType);
 
             const auto *folder = static_cast<TorrentContentModelFolder *>(item);
-            const auto childItems = folder->children();
-            const bool hasIgnored = std::any_of(childItems.cbegin(), childItems.cend()
-                         , [](const TorrentContentModelItem *childItem)
-            {
-                return (childItem->priority() == BitTorrent::DownloadPriority::Ignored);
-            });
-
-            return hasIgnored ? Qt::PartiallyChecked : Qt::Checked;
+            return folder->hasIgnoredFiles() ? Qt::PartiallyChecked : Qt::Checked;
         }
 
         return Qt::Checked;
@@ -541,19 +614,106 @@ QModelIndex TorrentContentModel::parent(const QModelIndex &index) const
 
 int TorrentContentModel::rowCount(const QModelIndex &parent) const
 {
-    const TorrentContentModelFolder *parentItem = parent.isValid()
-        ? dynamic_cast<TorrentContentModelFolder *>(static_cast<TorrentContentModelItem *>(parent.internalPointer()))
-        : m_rootItem;
+    const TorrentContentModelFolder *parentItem = folderItem(parent);
     return parentItem ? parentItem->childCount() : 0;
 }
 
+bool TorrentContentModel::hasChildren(const QModelIndex &parent) const
+{
+    const TorrentContentModelFolder *parentItem = folderItem(parent);
+    if (!parentItem)
+        return false;
+
+    return parentItem->isPopulated()
+        ? (parentItem->childCount() > 0)
+        : (!parentItem->subfolders().isEmpty() || !parentItem->fileIndexes().isEmpty());
+}
+
+bool TorrentContentModel::canFetchMore(const QModelIndex &parent) const
+{
+    const TorrentContentModelFolder *parentItem = folderItem(parent);
+    return parentItem && !parentItem->isPopulated();
+}
+
+void TorrentContentModel::fetchMore(const QModelIndex &parent)
+{
+    TorrentContentModelFolder *parentItem = folderItem(parent);
+    if (!parentItem || parentItem->isPopulated())
+        return;
+
+    const int childCount = parentItem->subfolders().size() + parentItem->fileIndexes().size();
+    if (childCount == 0)
+    {
+        populateFolder(parentItem);
+        return;
+    }
+
+    beginInsertRows(parent, 0, (childCount - 1));
+    populateFolder(parentItem);
+    endInsertRows();
+}
+
+bool TorrentContentModel::folderContainsMatch(const QModelIndex &folderIndex, const QRegularExpression &regex) const
+{
+    const TorrentContentModelFolder *folder = folderItem(folderIndex);
+    if (!folder || folder->isRootItem())
+        return false;
+
+    QVector<const TorrentContentModelFolder *> folders {folder};
+    while (!folders.isEmpty())
+    {
+        const TorrentContentModelFolder *currentFolder = folders.takeLast();
+        if (currentFolder->name().contains(regex))
+            return true;
+
+        for (const int fileIndex : currentFolder->fileIndexes())
+        {
+            if (m_fileNames[fileIndex].contains(regex))
+                return true;
+        }
+
+        for (const TorrentContentModelFolder *subfolder : currentFolder->subfolders())
+            folders.append(subfolder);
+    }
+
+    return false;
+}
+
+void TorrentContentModel::populateFolder(TorrentContentModelFolder *folder)
+{
+    QVector<TorrentContentModelFile *> fileItems;
+    fileItems.reserve(folder->fileIndexes().size());
+    for (const int fileIndex : folder->fileIndexes())
+    {
+        const TorrentContentModelFolder::FileData &fileData = m_filesData[fileIndex];
+        auto *fileItem = new TorrentContentModelFile(m_fileNames[fileIndex], fileData.size, folder, fileIndex);
+        fileItem->setProgress(fileData.progress);
+        fileItem->setAvailability(fileData.availability);
+        fileItem->setPriority(fileData.priority);
+        fileItems.append(fileItem);
+        m_filesIndex[fileIndex] = fileItem;
+    }
+
+    folder->populate(fileItems);
+}
+
 void TorrentContentModel::populate()
 {
     Q_ASSERT(m_contentHandler && m_contentHandler->hasMetadata());
 
     const int filesCount = m_contentHandler->filesCount();
-    m_filesIndex.reserve(filesCount);
-
+    const QVector<qreal> filesProgress = m_contentHandler->filesProgress();
+    const QVector<BitTorrent::DownloadPriority> filePriorities = m_contentHandler->filePriorities();
+    Q_ASSERT(filesProgress.size() == filesCount);
+    Q_ASSERT(filePriorities.size() == filesCount);
+
+    m_filesData.reserve(filesCount);
+    m_fileNames.reserve(filesCount);
+    m_fileParents.reserve(filesCount);
+    m_filesIndex.fill(nullptr, filesCount);
+
+    // Only the folder structure is built here, the file items
+    // are created when their folders are fetched by the view
     QHash<TorrentContentModelFolder *, QHash<QString, TorrentContentModelFolder *>> folderMap;
     QVector<QString> lastParentPath;
     TorrentContentModelFolder *lastParent = m_rootItem;
@@ -583,21 +743,27 @@ void TorrentContentModel::populate()
                 if (!newParent)
                 {
                     newParent = new TorrentContentModelFolder(folderName, lastParent);
-                    lastParent->appendChild(newParent);
+                    lastParent->addSubfolder(newParent);
                 }
 
                 lastParent = newParent;
             }
         }
 
-        // Actually create the file
-        auto *fileItem = new TorrentContentModelFile(fileName, m_contentHandler->fileSize(i), lastParent, i);
-        lastParent->appendChild(fileItem);
-        m_filesIndex.push_back(fileItem);
+        TorrentContentModelFolder::FileData fileData;
+        fileData.size = m_contentHandler->fileSize(i);
+        fileData.progress = filesProgress.value(i);
+        fileData.remaining = remainingSize(fileData.size, fileData.progress);
+        fileData.priority = filePriorities.value(i, BitTorrent::DownloadPriority::Normal);
+
+        lastParent->addFileIndex(i);
+        lastParent->addFile(fileData);
+        m_filesData.push_back(fileData);
+        m_fileNames.push_back(fileName);
+        m_fileParents.push_back(lastParent);
     }
 
-    updateFilesProgress();
-    updateFilesPriorities();
+    populateFolder(m_rootItem);
     updateFilesAvailability();
 }
 
@@ -608,6 +774,9 @@ void TorrentContentModel::setContentHandler(BitTorrent::TorrentContentHandler *c
 
     if (m_contentHandler)
     {
+        m_filesData.clear();
+        m_fileNames.clear();
+        m_fileParents.clear();
         m_filesIndex.clear();
         m_rootItem->deleteAllChildren();
     }
@@ -628,20 +797,22 @@ void TorrentContentModel::refresh()
     if (!m_contentHandler || !m_contentHandler->hasMetadata())
         return;
 
-    if (!m_filesIndex.isEmpty())
+    if (!m_filesData.isEmpty())
     {
         updateFilesProgress();
         updateFilesPriorities();
         updateFilesAvailability();
 
+        // Only the fetched items are notified, the others will get
+        // the up-to-date values when they are created
         const QVector<ColumnInterval> columns =
         {
             {TorrentContentModelItem::COL_NAME, TorrentContentModelItem::COL_NAME},
-            {TorrentContentModelItem::COL_PROGRESS, TorrentContentModelItem::COL_PROGRESS},
-            {TorrentContentModelItem::COL_PRIO, TorrentContentModelItem::COL_PRIO},
+            {TorrentContentModelItem::COL_PROGRESS, TorrentContentModelItem::COL_REMAINING},
             {TorrentContentModelItem::COL_AVAILABILITY, TorrentContentModelItem::COL_AVAILABILITY}
         };
-        notifySubtreeUpdated(index(0, 0), columns);
+        for (int row = 0; row < m_rootItem->childCount(); ++row)
+            notifySubtreeUpdated(index(row, 0), columns);
     }
     else
     {
@@ -673,7 +844,8 @@ void TorrentContentModel::notifySubtreeUpdated(const QModelIndex &index, const Q
     // propagate down the model
     QVector<QModelIndex> parentIndexes;
 
-    if (hasChildren(index))
+    // only the fetched children are notified
+    if (rowCount(index) > 0)
         parentIndexes.push_back(index);
 
     while (!parentIndexes.isEmpty())
@@ -696,7 +868,7 @@ void TorrentContentModel::notifySubtreeUpdated(const QModelIndex &index, const Q
         for (int i = 0; i < childCount; ++i)
         {
             const QModelIndex sibling = child.siblingAtRow(i);
-            if (hasChildren(sibling))
+            if (rowCount(sibling) > 0)
                 parentIndexes.push_back(sibling);
         }
     }
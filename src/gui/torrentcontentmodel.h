@@ -34,10 +34,12 @@
 
 #include "base/indexrange.h"
 #include "base/pathfwd.h"
+#include "torrentcontentmodelfolder.h"
 #include "torrentcontentmodelitem.h"
 
 class QFileIconProvider;
 class QModelIndex;
+class QRegularExpression;
 class QVariant;
 
 class TorrentContentModelFile;
@@ -79,6 +81,12 @@ public:
     QModelIndex index(int row, int column, const QModelIndex &parent = {}) const override;
     QModelIndex parent(const QModelIndex &index) const override;
     int rowCount(const QModelIndex &parent = {}) const override;
+    bool hasChildren(const QModelIndex &parent = {}) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    // Checks the names of the folder and all its descendants, including the ones not fetched yet
+    bool folderContainsMatch(const QModelIndex &folderIndex, const QRegularExpression &regex) const;
 
 signals:
     void renameFailed(const QString &errorMessage);
@@ -87,6 +95,9 @@ private:
     using ColumnInterval = IndexInterval<int>;
 
     void populate();
+    void populateFolder(TorrentContentModelFolder *folder);
+    TorrentContentModelFolder *folderItem(const QModelIndex &index) const;
+    void updateFileData(int fileIndex, const TorrentContentModelFolder::FileData &fileData);
     void updateFilesProgress();
     void updateFilesPriorities();
     void updateFilesAvailability();
@@ -95,6 +106,11 @@ private:
 
     BitTorrent::TorrentContentHandler *m_contentHandler = nullptr;
     TorrentContentModelFolder *m_rootItem = nullptr;
+    // Per file data is kept apart from the items, which are created
+    // only when their folder gets fetched (nullptr until then)
+    QVector<TorrentContentModelFolder::FileData> m_filesData;
+    QVector<QString> m_fileNames;
+    QVector<TorrentContentModelFolder *> m_fileParents;
     QVector<TorrentContentModelFile *> m_filesIndex;
     QFileIconProvider *m_fileIconProvider = nullptr;
 };
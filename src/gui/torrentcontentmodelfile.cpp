@@ -28,8 +28,6 @@
 
 #include "torrentcontentmodelfile.h"
 
-#include "torrentcontentmodelfolder.h"
-
 TorrentContentModelFile::TorrentContentModelFile(const QString &fileName, qulonglong fileSize,
                                                  TorrentContentModelFolder *parent, int fileIndex)
     : TorrentContentModelItem(parent)
@@ -46,18 +44,10 @@ int TorrentContentModelFile::fileIndex() const
     return m_fileIndex;
 }
 
-void TorrentContentModelFile::setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent)
+void TorrentContentModelFile::setPriority(const BitTorrent::DownloadPriority newPriority)
 {
     Q_ASSERT(newPriority != BitTorrent::DownloadPriority::Mixed);
-
-    if (m_priority == newPriority)
-        return;
-
     m_priority = newPriority;
-
-    // Update parent
-    if (updateParent)
-        m_parentItem->updatePriority();
 }
 
 void TorrentContentModelFile::setProgress(qreal progress)
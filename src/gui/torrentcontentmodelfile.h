@@ -42,7 +42,7 @@ public:
                             TorrentContentModelFolder *parent, int fileIndex);
 
     int fileIndex() const;
-    void setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent = true) override;
+    void setPriority(BitTorrent::DownloadPriority newPriority);
     void setProgress(qreal progress);
     void setAvailability(qreal availability);
     ItemType itemType() const override;
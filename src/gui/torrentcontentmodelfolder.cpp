@@ -26,11 +26,15 @@
  * exception statement from your version.
  */
 
+
 #include "torrentcontentmodelfolder.h"
 
+#include <algorithm>
+
 #include <QVariant>
 
 #include "base/global.h"
+#include "torrentcontentmodelfile.h"
 
 TorrentContentModelFolder::TorrentContentModelFolder(const QString &name, TorrentContentModelFolder *parent)
     : TorrentContentModelItem(parent)
@@ -48,7 +52,14 @@ TorrentContentModelFolder::TorrentContentModelFolder(const QVector<QString> &dat
 
 TorrentContentModelFolder::~TorrentContentModelFolder()
 {
-    qDeleteAll(m_childItems);
+    // Subfolders are owned regardless of whether the folder is populated,
+    // while file items exist only in populated folders
+    qDeleteAll(m_subfolders);
+    for (TorrentContentModelItem *child : asConst(m_childItems))
+    {
+        if (child->itemType() == FileType)
+            delete child;
+    }
 }
 
 TorrentContentModelItem::ItemType TorrentContentModelFolder::itemType() const
@@ -59,8 +70,16 @@ TorrentContentModelItem::ItemType TorrentContentModelFolder::itemType() const
 void TorrentContentModelFolder::deleteAllChildren()
 {
     Q_ASSERT(isRootItem());
-    qDeleteAll(m_childItems);
+    qDeleteAll(m_subfolders);
+    for (TorrentContentModelItem *child : asConst(m_childItems))
+    {
+        if (child->itemType() == FileType)
+            delete child;
+    }
     m_childItems.clear();
+    m_subfolders.clear();
+    m_fileIndexes.clear();
+    m_isPopulated = false;
 }
 
 const QVector<TorrentContentModelItem *> &TorrentContentModelFolder::children() const
@@ -71,127 +90,140 @@ const QVector<TorrentContentModelItem *> &TorrentContentModelFolder::children()
 void TorrentContentModelFolder::appendChild(TorrentContentModelItem *item)
 {
     Q_ASSERT(item);
+    item->m_row = m_childItems.size();
     m_childItems.append(item);
-    // Update own size
-    if (item->itemType() == FileType)
-        increaseSize(item->size());
 }
 
 TorrentContentModelItem *TorrentContentModelFolder::child(int row) const
 {
     return m_childItems.value(row, nullptr);
 }
+
 int TorrentContentModelFolder::childCount() const
 {
     return m_childItems.count();
 }
 
-// Only non-root folders use this function
-void TorrentContentModelFolder::updatePriority()
+void TorrentContentModelFolder::addSubfolder(TorrentContentModelFolder *subfolder)
 {
-    if (isRootItem())
-        return;
+    Q_ASSERT(subfolder);
+    Q_ASSERT(!m_isPopulated);
+    m_subfolders.append(subfolder);
+}
 
-    Q_ASSERT(!m_childItems.isEmpty());
+const QVector<TorrentContentModelFolder *> &TorrentContentModelFolder::subfolders() const
+{
+    return m_subfolders;
+}
 
-    // If all children have the same priority
-    // then the folder should have the same
-    // priority
-    const BitTorrent::DownloadPriority prio = m_childItems.first()->priority();
-    for (int i = 1; i < m_childItems.size(); ++i)
-    {
-        if (m_childItems.at(i)->priority() != prio)
-        {
-            setPriority(BitTorrent::DownloadPriority::Mixed);
-            return;
-        }
-    }
-    // All child items have the same priority
-    // Update own if necessary
-    setPriority(prio);
+void TorrentContentModelFolder::addFileIndex(const int fileIndex)
+{
+    Q_ASSERT(!m_isPopulated);
+    m_fileIndexes.append(fileIndex);
 }
 
-void TorrentContentModelFolder::setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent)
+const QVector<int> &TorrentContentModelFolder::fileIndexes() const
 {
-    if (m_priority == newPriority)
-        return;
+    return m_fileIndexes;
+}
+
+bool TorrentContentModelFolder::isPopulated() const
+{
+    return m_isPopulated;
+}
 
-    m_priority = newPriority;
+void TorrentContentModelFolder::populate(const QVector<TorrentContentModelFile *> &fileItems)
+{
+    Q_ASSERT(!m_isPopulated);
+    Q_ASSERT(fileItems.size() == m_fileIndexes.size());
 
-    // Update parent priority
-    if (updateParent)
-        m_parentItem->updatePriority();
+    m_childItems.reserve(m_subfolders.size() + fileItems.size());
+    for (TorrentContentModelFolder *subfolder : asConst(m_subfolders))
+        appendChild(subfolder);
+    for (TorrentContentModelFile *fileItem : fileItems)
+        appendChild(fileItem);
 
-    // Update children
-    if (m_priority != BitTorrent::DownloadPriority::Mixed)
-    {
-        for (TorrentContentModelItem *child : asConst(m_childItems))
-            child->setPriority(m_priority, false);
-    }
+    m_isPopulated = true;
 }
 
-void TorrentContentModelFolder::recalculateProgress()
+void TorrentContentModelFolder::addFile(const FileData &fileData)
 {
-    qreal tProgress = 0;
-    qulonglong tSize = 0;
-    qulonglong tRemaining = 0;
-    for (TorrentContentModelItem *child : asConst(m_childItems))
-    {
-        if (child->priority() == BitTorrent::DownloadPriority::Ignored)
-            continue;
+    if (isRootItem())
+        return;
 
-        if (child->itemType() == FolderType)
-            static_cast<TorrentContentModelFolder *>(child)->recalculateProgress();
-        tProgress += child->progress() * child->size();
-        tSize += child->size();
-        tRemaining += child->remaining();
-    }
+    updateAggregates(fileData, 1);
+    m_parentItem->addFile(fileData);
+}
 
-    if (!isRootItem() && (tSize > 0))
-    {
-        m_progress = tProgress / tSize;
-        m_remaining = tRemaining;
-        Q_ASSERT(m_progress <= 1.);
-    }
+void TorrentContentModelFolder::removeFile(const FileData &fileData)
+{
+    if (isRootItem())
+        return;
+
+    updateAggregates(fileData, -1);
+    m_parentItem->removeFile(fileData);
 }
 
-void TorrentContentModelFolder::recalculateAvailability()
+bool TorrentContentModelFolder::hasIgnoredFiles() const
 {
-    qreal tAvailability = 0;
-    qulonglong tSize = 0;
-    bool foundAnyData = false;
-    for (TorrentContentModelItem *child : asConst(m_childItems))
-    {
-        if (child->priority() == BitTorrent::DownloadPriority::Ignored)
-            continue;
+    return (m_priorityCounts[static_cast<int>(BitTorrent::DownloadPriority::Ignored)] > 0);
+}
 
-        if (child->itemType() == FolderType)
-            static_cast<TorrentContentModelFolder*>(child)->recalculateAvailability();
-        const qreal childAvailability = child->availability();
-        if (childAvailability >= 0)
+void TorrentContentModelFolder::updateAggregates(const FileData &fileData, const int sign)
+{
+    Q_ASSERT(fileData.priority != BitTorrent::DownloadPriority::Mixed);
+
+    const auto size = static_cast<qint64>(fileData.size);
+    m_size = static_cast<qulonglong>(static_cast<qint64>(m_size) + (sign * size));
+    m_filesCount += sign;
+    m_priorityCounts[static_cast<int>(fileData.priority)] += sign;
+
+    if (fileData.priority != BitTorrent::DownloadPriority::Ignored)
+    {
+        m_wantedSize += sign * size;
+        m_completedSize += sign * fileData.progress * size;
+        m_remainingSize += sign * static_cast<qint64>(fileData.remaining);
+        if (fileData.availability >= 0)
         { // -1 means "no data"
-            tAvailability += childAvailability * child->size();
-            foundAnyData = true;
+            m_availableSize += sign * fileData.availability * size;
+            m_availableFilesCount += sign;
         }
-        tSize += child->size();
     }
 
-    if (!isRootItem() && (tSize > 0) && foundAnyData)
+    updateValues();
+}
+
+void TorrentContentModelFolder::updateValues()
+{
+    // Accumulated floating point sums can slightly drift so the values are clamped
+    if (m_wantedSize > 0)
     {
-        m_availability = tAvailability / tSize;
-        Q_ASSERT(m_availability <= 1.);
+        m_progress = std::clamp<qreal>((m_completedSize / m_wantedSize), 0, 1);
+        m_remaining = static_cast<qulonglong>(m_remainingSize);
+        m_availability = (m_availableFilesCount > 0)
+            ? std::clamp<qreal>((m_availableSize / m_wantedSize), 0, 1)
+            : -1;
     }
     else
     {
-        m_availability = -1.;
+        m_progress = 0;
+        m_remaining = 0;
+        m_remainingSize = 0;
+        m_completedSize = 0;
+        m_availableSize = 0;
+        m_availability = -1;
     }
-}
 
-void TorrentContentModelFolder::increaseSize(qulonglong delta)
-{
-    if (isRootItem())
-        return;
+    // If all files have the same priority
+    // then the folder should have the same priority
+    m_priority = BitTorrent::DownloadPriority::Mixed;
+    for (int i = 0; i < static_cast<int>(m_priorityCounts.size()); ++i)
+    {
+        if (m_priorityCounts[i] == 0)
+            continue;
 
-    m_size += delta;
-    m_parentItem->increaseSize(delta);
+        if (m_priorityCounts[i] == m_filesCount)
+            m_priority = static_cast<BitTorrent::DownloadPriority>(i);
+        break;
+    }
 }
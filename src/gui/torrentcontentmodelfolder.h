@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <array>
+
 #include "torrentcontentmodelitem.h"
 
 namespace BitTorrent
@@ -35,9 +37,20 @@ namespace BitTorrent
     enum class DownloadPriority;
 }
 
+class TorrentContentModelFile;
+
 class TorrentContentModelFolder final : public TorrentContentModelItem
 {
 public:
+    struct FileData
+    {
+        qulonglong size = 0;
+        qreal progress = 0;
+        qulonglong remaining = 0;
+        qreal availability = -1;
+        BitTorrent::DownloadPriority priority = BitTorrent::DownloadPriority::Normal;
+    };
+
     // Folder constructor
     TorrentContentModelFolder(const QString &name, TorrentContentModelFolder *parent);
 
@@ -48,19 +61,41 @@ public:
 
     ItemType itemType() const override;
 
-    void increaseSize(qulonglong delta);
-    void recalculateProgress();
-    void recalculateAvailability();
-    void updatePriority();
+    // Folder values are aggregated from the data of the contained files,
+    // so only the changed files need to be accounted when updating them
+    void addFile(const FileData &fileData);
+    void removeFile(const FileData &fileData);
+    bool hasIgnoredFiles() const;
 
-    void setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent = true) override;
+    // Subfolders and file indexes are known from the start while
+    // the child items are created only when the folder gets populated
+    void addSubfolder(TorrentContentModelFolder *subfolder);
+    const QVector<TorrentContentModelFolder *> &subfolders() const;
+    void addFileIndex(int fileIndex);
+    const QVector<int> &fileIndexes() const;
+    bool isPopulated() const;
+    void populate(const QVector<TorrentContentModelFile *> &fileItems);
 
     void deleteAllChildren();
     const QVector<TorrentContentModelItem*> &children() const;
-    void appendChild(TorrentContentModelItem *item);
     TorrentContentModelItem *child(int row) const;
     int childCount() const;
 
 private:
+    void appendChild(TorrentContentModelItem *item);
+    void updateAggregates(const FileData &fileData, int sign);
+    void updateValues();
+
     QVector<TorrentContentModelItem *> m_childItems;
+    QVector<TorrentContentModelFolder *> m_subfolders;
+    QVector<int> m_fileIndexes;
+    bool m_isPopulated = false;
+
+    int m_filesCount = 0;
+    std::array<int, 8> m_priorityCounts {};
+    qint64 m_wantedSize = 0;
+    qint64 m_remainingSize = 0;
+    qreal m_completedSize = 0;
+    qreal m_availableSize = 0;
+    int m_availableFilesCount = 0;
 };
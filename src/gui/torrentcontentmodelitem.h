@@ -40,6 +40,7 @@ class TorrentContentModelFolder;
 class TorrentContentModelItem
 {
     Q_DECLARE_TR_FUNCTIONS(TorrentContentModelItem)
+    friend class TorrentContentModelFolder;
 
 public:
     enum TreeItemColumns
@@ -76,7 +77,6 @@ public:
     qreal availability() const;
 
     BitTorrent::DownloadPriority priority() const;
-    virtual void setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent = true) = 0;
 
     int columnCount() const;
     QString displayData(int column) const;
@@ -85,6 +85,7 @@ public:
 
 protected:
     TorrentContentModelFolder *m_parentItem = nullptr;
+    int m_row = 0;
     // Root item members
     QVector<QString> m_itemData;
     // Non-root item members
@@ -487,8 +487,16 @@ void TorrentContentWidget::onItemDoubleClicked(const QModelIndex &index)
 
 void TorrentContentWidget::expandRecursively()
 {
+    const auto childCount = [this](const QModelIndex &index)
+    {
+        // folder children are created only once the folder is fetched
+        if (model()->canFetchMore(index))
+            model()->fetchMore(index);
+        return model()->rowCount(index);
+    };
+
     QModelIndex currentIndex;
-    while (model()->rowCount(currentIndex) == 1)
+    while (childCount(currentIndex) == 1)
     {
         currentIndex = model()->index(0, 0, currentIndex);
         setExpanded(currentIndex, true);
@@ -29,9 +29,13 @@
 
 #include "transferlistmodel.h"
 
+#include <chrono>
+#include <utility>
+
 #include <QApplication>
 #include <QDateTime>
 #include <QDebug>
+#include <QTimer>
 
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/session.h"
@@ -45,8 +49,42 @@
 #include "base/utils/string.h"
 #include "uithememanager.h"
 
+using namespace std::chrono_literals;
+
 namespace
 {
+    // The view can't show the changes more frequently anyway
+    const std::chrono::milliseconds MIN_UPDATE_INTERVAL = 500ms;
+
+    // Some columns are displayed using additional value
+    const int ALT_VALUES_COUNT = 3;
+
+    // Transfer list is filtered by the values of these columns,
+    // so their changes are notified even if they are hidden
+    const int FILTERED_COLUMNS[] =
+    {
+        TransferListModel::TR_NAME,
+        TransferListModel::TR_STATUS,
+        TransferListModel::TR_CATEGORY,
+        TransferListModel::TR_TAGS,
+        TransferListModel::TR_TRACKER
+    };
+
+    int altValueIndex(const int column)
+    {
+        switch (column)
+        {
+        case TransferListModel::TR_SEEDS:
+            return TransferListModel::NB_COLUMNS;
+        case TransferListModel::TR_PEERS:
+            return TransferListModel::NB_COLUMNS + 1;
+        case TransferListModel::TR_TIME_ELAPSED:
+            return TransferListModel::NB_COLUMNS + 2;
+        default:
+            return -1;
+        }
+    }
+
     QHash<BitTorrent::TorrentState, QColor> torrentStateColorsFromUITheme()
     {
         struct TorrentStateColorDescriptor
@@ -124,6 +162,11 @@ TransferListModel::TransferListModel(QObject *parent)
     , m_stalledUPIcon {UIThemeManager::instance()->getIcon(u"stalledUP"_s)}
     , m_uploadingIcon {UIThemeManager::instance()->getIcon(u"upload"_s, u"uploading"_s)}
 {
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setSingleShot(true);
+    connect(m_updateTimer, &QTimer::timeout, this, &TransferListModel::processPendingUpdates);
+    m_lastUpdateTimer.start();
+
     configure();
     connect(Preferences::instance(), &Preferences::changed, this, &TransferListModel::configure);
 
@@ -501,19 +544,31 @@ QVariant TransferListModel::data(const QModelIndex &index, const int role) const
     const BitTorrent::Torrent *torrent = m_torrentList.value(index.row());
     if (!torrent) return {};
 
+    const CachedRow &cachedRow = m_cachedRows[index.row()];
+
     switch (role)
     {
     case Qt::ForegroundRole:
-        return m_stateThemeColors.value(torrent->state());
+        return m_stateThemeColors.value(cachedRow.state);
     case Qt::DisplayRole:
-        return displayValue(torrent, index.column());
+        {
+            std::optional<QString> &value = cachedRow.displayValues[index.column()];
+            if (!value)
+                value = displayValue(torrent, index.column());
+            return *value;
+        }
     case UnderlyingDataRole:
-        return internalValue(torrent, index.column(), false);
+        updateOutdatedValue(index.row(), index.column());
+        return cachedRow.values[index.column()];
     case AdditionalUnderlyingDataRole:
-        return internalValue(torrent, index.column(), true);
+        {
+            updateOutdatedValue(index.row(), index.column());
+            const int altIndex = altValueIndex(index.column());
+            return cachedRow.values[(altIndex >= 0) ? altIndex : index.column()];
+        }
     case Qt::DecorationRole:
         if (index.column() == TR_NAME)
-            return getIconByState(torrent->state());
+            return getIconByState(cachedRow.state);
         break;
     case Qt::ToolTipRole:
         switch (index.column())
@@ -527,7 +582,7 @@ QVariant TransferListModel::data(const QModelIndex &index, const int role) const
         case TR_DOWNLOAD_PATH:
         case TR_INFOHASH_V1:
         case TR_INFOHASH_V2:
-            return displayValue(torrent, index.column());
+            return data(index, Qt::DisplayRole);
         }
         break;
     case Qt::TextAlignmentRole:
@@ -594,12 +649,15 @@ void TransferListModel::addTorrents(const QVector<BitTorrent::Torrent *> &torren
     beginInsertRows({}, row, total);
 
     m_torrentList.reserve(total);
+    m_cachedRows.reserve(total);
     for (BitTorrent::Torrent *torrent : torrents)
     {
         Q_ASSERT(!m_torrentMap.contains(torrent));
 
         m_torrentList.append(torrent);
-        m_torrentMap[torrent] = row++;
+        m_cachedRows.append({});
+        m_torrentMap[torrent] = row;
+        updateCachedRow(row++);
     }
 
     endInsertRows();
@@ -620,6 +678,17 @@ BitTorrent::Torrent *TransferListModel::torrentHandle(const QModelIndex &index)
     return m_torrentList.value(index.row());
 }
 
+void TransferListModel::setVisibleColumns(const QBitArray &columns)
+{
+    Q_ASSERT(columns.size() == NB_COLUMNS);
+
+    // Outdated values of the columns being shown are updated when they are requested
+    // or on the next update of the torrent, so nothing needs to be done here
+    m_visibleColumns = columns;
+    for (const int column : FILTERED_COLUMNS)
+        m_visibleColumns.setBit(column);
+}
+
 void TransferListModel::handleTorrentAboutToBeRemoved(BitTorrent::Torrent *const torrent)
 {
     const int row = m_torrentMap.value(torrent, -1);
@@ -627,7 +696,9 @@ void TransferListModel::handleTorrentAboutToBeRemoved(BitTorrent::Torrent *const
 
     beginRemoveRows({}, row, row);
     m_torrentList.removeAt(row);
+    m_cachedRows.removeAt(row);
     m_torrentMap.remove(torrent);
+    m_pendingUpdates.remove(torrent);
     for (int &value : m_torrentMap)
     {
         if (value > row)
@@ -641,27 +712,167 @@ void TransferListModel::handleTorrentStatusUpdated(BitTorrent::Torrent *const to
     const int row = m_torrentMap.value(torrent, -1);
     Q_ASSERT(row >= 0);
 
-    emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    m_pendingUpdates.remove(torrent);
+    notifyDataChanged({{row, updateCachedRow(row)}});
 }
 
 void TransferListModel::handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents)
 {
-    const int columns = (columnCount() - 1);
+    for (BitTorrent::Torrent *const torrent : torrents)
+        m_pendingUpdates.insert(torrent);
+
+    if (m_updateTimer->isActive())
+        return;
+
+    const std::chrono::milliseconds elapsed {m_lastUpdateTimer.elapsed()};
+    if (elapsed >= MIN_UPDATE_INTERVAL)
+        processPendingUpdates();
+    else
+        m_updateTimer->start(MIN_UPDATE_INTERVAL - elapsed);
+}
+
+void TransferListModel::processPendingUpdates()
+{
+    m_lastUpdateTimer.start();
+
+    QHash<int, QBitArray> changedColumnsByRow;
+    changedColumnsByRow.reserve(m_pendingUpdates.size());
+    for (BitTorrent::Torrent *const torrent : asConst(std::exchange(m_pendingUpdates, {})))
+    {
+        const int row = m_torrentMap.value(torrent, -1);
+        Q_ASSERT(row >= 0);
+
+        const QBitArray changedColumns = updateCachedRow(row);
+        if (changedColumns.count(true) > 0)
+            changedColumnsByRow.insert(row, changedColumns);
+    }
+
+    notifyDataChanged(changedColumnsByRow);
+}
+
+// Returns the columns whose values have changed
+QBitArray TransferListModel::updateCachedRow(const int row)
+{
+    const BitTorrent::Torrent *torrent = m_torrentList[row];
+    CachedRow &cachedRow = m_cachedRows[row];
+    if (cachedRow.values.isEmpty())
+    {
+        cachedRow.values.resize(NB_COLUMNS + ALT_VALUES_COUNT);
+        cachedRow.displayValues.resize(NB_COLUMNS);
+        cachedRow.outdatedColumns.resize(NB_COLUMNS);
+    }
+
+    // State affects colors, icons and the values that are hidden when they are zero
+    const BitTorrent::TorrentState state = torrent->state();
+    const bool stateChanged = (state != cachedRow.state);
+    cachedRow.state = state;
+
+    QBitArray changedColumns {NB_COLUMNS, stateChanged};
+    for (int column = 0; column < NB_COLUMNS; ++column)
+    {
+        // Nobody is notified about changes of invisible columns
+        // so their values aren't calculated until they are requested
+        if (!m_visibleColumns.testBit(column))
+        {
+            cachedRow.outdatedColumns.setBit(column);
+            cachedRow.displayValues[column].reset();
+            continue;
+        }
+
+        if (cachedRow.outdatedColumns.testBit(column))
+        {
+            cachedRow.outdatedColumns.clearBit(column);
+            changedColumns.setBit(column);
+        }
+
+        QVariant value = internalValue(torrent, column, false);
+        if (value != cachedRow.values[column])
+        {
+            cachedRow.values[column] = std::move(value);
+            changedColumns.setBit(column);
+        }
+
+        if (const int altIndex = altValueIndex(column); altIndex >= 0)
+        {
+            QVariant altValue = internalValue(torrent, column, true);
+            if (altValue != cachedRow.values[altIndex])
+            {
+                cachedRow.values[altIndex] = std::move(altValue);
+                changedColumns.setBit(column);
+            }
+        }
+
+        if (changedColumns.testBit(column))
+            cachedRow.displayValues[column].reset();
+    }
+
+    return changedColumns;
+}
+
+void TransferListModel::updateOutdatedValue(const int row, const int column) const
+{
+    const CachedRow &cachedRow = m_cachedRows[row];
+    if (!cachedRow.outdatedColumns.testBit(column))
+        return;
+
+    const BitTorrent::Torrent *torrent = m_torrentList[row];
+    cachedRow.values[column] = internalValue(torrent, column, false);
+    if (const int altIndex = altValueIndex(column); altIndex >= 0)
+        cachedRow.values[altIndex] = internalValue(torrent, column, true);
+    cachedRow.outdatedColumns.clearBit(column);
+}
 
-    if (torrents.size() <= (m_torrentList.size() * 0.5))
+void TransferListModel::notifyDataChanged(const QHash<int, QBitArray> &changedColumnsByRow)
+{
+    if (changedColumnsByRow.isEmpty())
+        return;
+
+    // Save the overhead of notifying about each row separately when the column
+    // has changed in more than half of the torrents (e.g. speeds of active torrents)
+    QBitArray wholeColumns {NB_COLUMNS};
+    if (changedColumnsByRow.size() > 1)
     {
-        for (BitTorrent::Torrent *const torrent : torrents)
+        QVector<int> changedRowsCount(NB_COLUMNS, 0);
+        for (const QBitArray &changedColumns : changedColumnsByRow)
         {
-            const int row = m_torrentMap.value(torrent, -1);
-            Q_ASSERT(row >= 0);
+            for (int column = 0; column < NB_COLUMNS; ++column)
+            {
+                if (changedColumns.testBit(column))
+                    ++changedRowsCount[column];
+            }
+        }
 
-            emit dataChanged(index(row, 0), index(row, columns));
+        for (int column = 0; column < NB_COLUMNS; ++column)
+        {
+            if (changedRowsCount[column] > (m_torrentList.size() * 0.5))
+            {
+                wholeColumns.setBit(column);
+                emit dataChanged(index(0, column), index((rowCount() - 1), column));
+            }
         }
     }
-    else
+
+    // Notify about runs of adjacent changed columns in each row,
+    // so the columns that haven't changed aren't requested again
+    for (auto iter = changedColumnsByRow.cbegin(); iter != changedColumnsByRow.cend(); ++iter)
     {
-        // save the overhead when more than half of the torrent list needs update
-        emit dataChanged(index(0, 0), index((rowCount() - 1), columns));
+        const int row = iter.key();
+        const QBitArray changedColumns = iter.value() & ~wholeColumns;
+
+        int firstColumn = -1;
+        for (int column = 0; column <= NB_COLUMNS; ++column)
+        {
+            const bool isChanged = (column < NB_COLUMNS) && changedColumns.testBit(column);
+            if (isChanged && (firstColumn < 0))
+            {
+                firstColumn = column;
+            }
+            else if (!isChanged && (firstColumn >= 0))
+            {
+                emit dataChanged(index(row, firstColumn), index(row, (column - 1)));
+                firstColumn = -1;
+            }
+        }
     }
 }
 
@@ -681,6 +892,8 @@ void TransferListModel::configure()
     if (m_hideZeroValuesMode != hideZeroValuesMode)
     {
         m_hideZeroValuesMode = hideZeroValuesMode;
+        for (CachedRow &cachedRow : m_cachedRows)
+            cachedRow.displayValues.fill(std::nullopt);
         emit dataChanged(index(0, 0), index((rowCount() - 1), (columnCount() - 1)));
     }
 }
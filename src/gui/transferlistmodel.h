@@ -29,14 +29,22 @@
 
 #pragma once
 
+#include <optional>
+
 #include <QAbstractListModel>
+#include <QBitArray>
 #include <QColor>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QIcon>
 #include <QList>
+#include <QSet>
+#include <QVector>
 
 #include "base/bittorrent/torrent.h"
 
+class QTimer;
+
 namespace BitTorrent
 {
     class InfoHash;
@@ -105,6 +113,10 @@ public:
 
     BitTorrent::Torrent *torrentHandle(const QModelIndex &index) const;
 
+    // Only values of these columns (and the ones used for filtering) are compared on update
+    // so their changes are notified, values of the other ones are recalculated when requested
+    void setVisibleColumns(const QBitArray &columns);
+
 private slots:
     void addTorrents(const QVector<BitTorrent::Torrent *> &torrents);
     void handleTorrentAboutToBeRemoved(BitTorrent::Torrent *torrent);
@@ -112,13 +124,33 @@ private slots:
     void handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents);
 
 private:
+    // Values of torrent at the time of the last model update
+    struct CachedRow
+    {
+        BitTorrent::TorrentState state = BitTorrent::TorrentState::Unknown;
+        mutable QVector<QVariant> values;
+        // formatted when requested for the first time
+        mutable QVector<std::optional<QString>> displayValues;
+        // values of invisible columns that weren't updated
+        mutable QBitArray outdatedColumns;
+    };
+
     void configure();
     QString displayValue(const BitTorrent::Torrent *torrent, int column) const;
     QVariant internalValue(const BitTorrent::Torrent *torrent, int column, bool alt) const;
     QIcon getIconByState(BitTorrent::TorrentState state) const;
+    QBitArray updateCachedRow(int row);
+    void updateOutdatedValue(int row, int column) const;
+    void processPendingUpdates();
+    void notifyDataChanged(const QHash<int, QBitArray> &changedColumnsByRow);
 
     QList<BitTorrent::Torrent *> m_torrentList;  // maps row number to torrent handle
     QHash<BitTorrent::Torrent *, int> m_torrentMap;  // maps torrent handle to row number
+    QList<CachedRow> m_cachedRows;  // must be kept in sync with `m_torrentList`
+    QSet<BitTorrent::Torrent *> m_pendingUpdates;
+    QBitArray m_visibleColumns {NB_COLUMNS, true};
+    QTimer *m_updateTimer = nullptr;
+    QElapsedTimer m_lastUpdateTimer;
     const QHash<BitTorrent::TorrentState, QString> m_statusStrings;
     // row text colors
     const QHash<BitTorrent::TorrentState, QColor> m_stateThemeColors;
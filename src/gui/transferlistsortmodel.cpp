@@ -30,9 +30,6 @@
 
 #include <type_traits>
 
-#include <QDateTime>
-
-#include "base/bittorrent/infohash.h"
 #include "base/bittorrent/torrent.h"
 #include "transferlistmodel.h"
 
@@ -109,9 +106,15 @@ void TransferListSortModel::sort(const int column, const Qt::SortOrder order)
     m_lastSortColumn = column;
     m_lastSortOrder = ((order == Qt::AscendingOrder) ? 0 : 1);
 
+    invalidateSortKeys();
     QSortFilterProxyModel::sort(column, order);
 }
 
+int TransferListSortModel::subSortColumn() const
+{
+    return m_subSortColumn;
+}
+
 void TransferListSortModel::setStatusFilter(TorrentFilter::Type filter)
 {
     if (m_filter.setType(filter))
@@ -154,29 +157,28 @@ void TransferListSortModel::disableTrackerFilter()
         invalidateFilter();
 }
 
-int TransferListSortModel::compare(const QModelIndex &left, const QModelIndex &right) const
+TransferListSortModel::SortKey TransferListSortModel::sortKey(const int sourceRow, const int column) const
 {
-    const int compareColumn = left.column();
-    const QVariant leftValue = left.data(TransferListModel::UnderlyingDataRole);
-    const QVariant rightValue = right.data(TransferListModel::UnderlyingDataRole);
+    const QModelIndex index = sourceModel()->index(sourceRow, column);
+    const QVariant value = index.data(TransferListModel::UnderlyingDataRole);
 
-    switch (compareColumn)
+    switch (column)
     {
     case TransferListModel::TR_CATEGORY:
     case TransferListModel::TR_DOWNLOAD_PATH:
     case TransferListModel::TR_NAME:
     case TransferListModel::TR_SAVE_PATH:
     case TransferListModel::TR_TRACKER:
-        return m_naturalCompare(leftValue.toString(), rightValue.toString());
+        return value.toString();
 
     case TransferListModel::TR_INFOHASH_V1:
-        return threeWayCompare(leftValue.value<SHA1Hash>(), rightValue.value<SHA1Hash>());
+        return value.value<SHA1Hash>();
 
     case TransferListModel::TR_INFOHASH_V2:
-        return threeWayCompare(leftValue.value<SHA256Hash>(), rightValue.value<SHA256Hash>());
+        return value.value<SHA256Hash>();
 
     case TransferListModel::TR_TAGS:
-        return customCompare(leftValue.value<TagSet>(), rightValue.value<TagSet>(), m_naturalCompare);
+        return value.value<TagSet>();
 
     case TransferListModel::TR_AMOUNT_DOWNLOADED:
     case TransferListModel::TR_AMOUNT_DOWNLOADED_SESSION:
@@ -189,42 +191,162 @@ int TransferListSortModel::compare(const QModelIndex &left, const QModelIndex &r
     case TransferListModel::TR_SIZE:
     case TransferListModel::TR_TIME_ELAPSED:
     case TransferListModel::TR_TOTAL_SIZE:
-        return customCompare(leftValue.toLongLong(), rightValue.toLongLong());
+        return value.toLongLong();
 
     case TransferListModel::TR_AVAILABILITY:
     case TransferListModel::TR_PROGRESS:
     case TransferListModel::TR_RATIO:
     case TransferListModel::TR_RATIO_LIMIT:
-        return customCompare(leftValue.toReal(), rightValue.toReal());
-
-    case TransferListModel::TR_STATUS:
-        return threeWayCompare(leftValue.toInt(), rightValue.toInt());
+        return value.toReal();
 
     case TransferListModel::TR_ADD_DATE:
     case TransferListModel::TR_SEED_DATE:
     case TransferListModel::TR_SEEN_COMPLETE_DATE:
-        return customCompare(leftValue.toDateTime(), rightValue.toDateTime());
+        return value.toDateTime();
 
+    case TransferListModel::TR_STATUS:
     case TransferListModel::TR_DLLIMIT:
     case TransferListModel::TR_DLSPEED:
     case TransferListModel::TR_QUEUE_POSITION:
     case TransferListModel::TR_UPLIMIT:
     case TransferListModel::TR_UPSPEED:
-        return customCompare(leftValue.toInt(), rightValue.toInt());
+        return static_cast<qint64>(value.toInt());
 
     case TransferListModel::TR_PEERS:
     case TransferListModel::TR_SEEDS:
-        {
-            // Active peers/seeds take precedence over total peers/seeds
-            const auto activeL = leftValue.toInt();
-            const auto activeR = rightValue.toInt();
-            if (activeL != activeR)
-                return threeWayCompare(activeL, activeR);
-
-            const auto totalL = left.data(TransferListModel::AdditionalUnderlyingDataRole).toInt();
-            const auto totalR = right.data(TransferListModel::AdditionalUnderlyingDataRole).toInt();
-            return threeWayCompare(totalL, totalR);
-        }
+        return std::make_pair(value.toInt(), index.data(TransferListModel::AdditionalUnderlyingDataRole).toInt());
+
+    default:
+        Q_ASSERT_X(false, Q_FUNC_INFO, "Missing sort key case");
+        break;
+    }
+
+    return {};
+}
+
+void TransferListSortModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (this->sourceModel())
+        this->sourceModel()->disconnect(this);
+
+    invalidateSortKeys();
+
+    // Sort keys must be updated before the base class handles the changes, so these
+    // connections have to be made before the ones made by QSortFilterProxyModel
+    if (sourceModel)
+    {
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this, &TransferListSortModel::handleSourceDataChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &TransferListSortModel::invalidateSortKeys);
+        connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &TransferListSortModel::invalidateSortKeys);
+        connect(sourceModel, &QAbstractItemModel::rowsMoved, this, &TransferListSortModel::invalidateSortKeys);
+        connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &TransferListSortModel::invalidateSortKeys);
+        connect(sourceModel, &QAbstractItemModel::modelReset, this, &TransferListSortModel::invalidateSortKeys);
+    }
+
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
+void TransferListSortModel::invalidateSortKeys()
+{
+    m_sortKeysValid = false;
+    m_sortKeys.clear();
+    m_subSortKeys.clear();
+}
+
+void TransferListSortModel::ensureSortKeys() const
+{
+    if (m_sortKeysValid)
+        return;
+
+    const int rowCount = sourceModel() ? sourceModel()->rowCount() : 0;
+    m_sortKeys.resize(rowCount);
+    m_subSortKeys.resize(rowCount);
+    m_sortKeysValid = true;
+
+    const_cast<TransferListSortModel *>(this)->updateSortKeys(0, (rowCount - 1));
+}
+
+void TransferListSortModel::updateSortKeys(const int firstSourceRow, const int lastSourceRow)
+{
+    const int column = sortColumn();
+    if (column < 0)
+        return;
+
+    for (int row = firstSourceRow; row <= lastSourceRow; ++row)
+    {
+        m_sortKeys[row] = sortKey(row, column);
+        m_subSortKeys[row] = sortKey(row, m_subSortColumn);
+    }
+}
+
+void TransferListSortModel::handleSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (!m_sortKeysValid)
+        return;
+
+    const int column = sortColumn();
+    const bool isSortColumnChanged = (column >= topLeft.column()) && (column <= bottomRight.column());
+    const bool isSubSortColumnChanged = (m_subSortColumn >= topLeft.column()) && (m_subSortColumn <= bottomRight.column());
+    if (isSortColumnChanged || isSubSortColumnChanged)
+        updateSortKeys(topLeft.row(), bottomRight.row());
+}
+
+int TransferListSortModel::compare(const int column, const SortKey &left, const SortKey &right) const
+{
+    switch (column)
+    {
+    case TransferListModel::TR_CATEGORY:
+    case TransferListModel::TR_DOWNLOAD_PATH:
+    case TransferListModel::TR_NAME:
+    case TransferListModel::TR_SAVE_PATH:
+    case TransferListModel::TR_TRACKER:
+        return m_naturalCompare(std::get<QString>(left), std::get<QString>(right));
+
+    case TransferListModel::TR_INFOHASH_V1:
+        return threeWayCompare(std::get<SHA1Hash>(left), std::get<SHA1Hash>(right));
+
+    case TransferListModel::TR_INFOHASH_V2:
+        return threeWayCompare(std::get<SHA256Hash>(left), std::get<SHA256Hash>(right));
+
+    case TransferListModel::TR_TAGS:
+        return customCompare(std::get<TagSet>(left), std::get<TagSet>(right), m_naturalCompare);
+
+    case TransferListModel::TR_AMOUNT_DOWNLOADED:
+    case TransferListModel::TR_AMOUNT_DOWNLOADED_SESSION:
+    case TransferListModel::TR_AMOUNT_LEFT:
+    case TransferListModel::TR_AMOUNT_UPLOADED:
+    case TransferListModel::TR_AMOUNT_UPLOADED_SESSION:
+    case TransferListModel::TR_COMPLETED:
+    case TransferListModel::TR_ETA:
+    case TransferListModel::TR_LAST_ACTIVITY:
+    case TransferListModel::TR_SIZE:
+    case TransferListModel::TR_TIME_ELAPSED:
+    case TransferListModel::TR_TOTAL_SIZE:
+    case TransferListModel::TR_DLLIMIT:
+    case TransferListModel::TR_DLSPEED:
+    case TransferListModel::TR_QUEUE_POSITION:
+    case TransferListModel::TR_UPLIMIT:
+    case TransferListModel::TR_UPSPEED:
+        return customCompare(std::get<qint64>(left), std::get<qint64>(right));
+
+    case TransferListModel::TR_AVAILABILITY:
+    case TransferListModel::TR_PROGRESS:
+    case TransferListModel::TR_RATIO:
+    case TransferListModel::TR_RATIO_LIMIT:
+        return customCompare(std::get<qreal>(left), std::get<qreal>(right));
+
+    case TransferListModel::TR_STATUS:
+        return threeWayCompare(std::get<qint64>(left), std::get<qint64>(right));
+
+    case TransferListModel::TR_ADD_DATE:
+    case TransferListModel::TR_SEED_DATE:
+    case TransferListModel::TR_SEEN_COMPLETE_DATE:
+        return customCompare(std::get<QDateTime>(left), std::get<QDateTime>(right));
+
+    case TransferListModel::TR_PEERS:
+    case TransferListModel::TR_SEEDS:
+        // Active peers/seeds take precedence over total peers/seeds
+        return threeWayCompare(std::get<std::pair<int, int>>(left), std::get<std::pair<int, int>>(right));
 
     default:
         Q_ASSERT_X(false, Q_FUNC_INFO, "Missing comparison case");
@@ -238,10 +360,15 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
 {
     Q_ASSERT(left.column() == right.column());
 
-    const int result = compare(left, right);
+    ensureSortKeys();
+
+    // Keys are maintained for the current sort column only
+    const int result = (left.column() == sortColumn())
+            ? compare(left.column(), m_sortKeys[left.row()], m_sortKeys[right.row()])
+            : compare(left.column(), sortKey(left.row(), left.column()), sortKey(right.row(), right.column()));
     if (result == 0)
     {
-        const int subResult = compare(left.sibling(left.row(), m_subSortColumn), right.sibling(right.row(), m_subSortColumn));
+        const int subResult = compare(m_subSortColumn, m_subSortKeys[left.row()], m_subSortKeys[right.row()]);
         // Qt inverses lessThan() result when ordered descending.
         // For sub-sorting we have to do it manually.
         // When both are ordered descending subResult must be double-inversed, which is the same as no inversion.
@@ -28,17 +28,20 @@
 
 #pragma once
 
+#include <utility>
+#include <variant>
+
+#include <QDateTime>
 #include <QSortFilterProxyModel>
+#include <QString>
+#include <QVector>
 
+#include "base/bittorrent/infohash.h"
 #include "base/settingvalue.h"
+#include "base/tagset.h"
 #include "base/torrentfilter.h"
 #include "base/utils/compare.h"
 
-namespace BitTorrent
-{
-    class InfoHash;
-}
-
 class TransferListSortModel final : public QSortFilterProxyModel
 {
     Q_OBJECT
@@ -47,7 +50,9 @@ class TransferListSortModel final : public QSortFilterProxyModel
 public:
     explicit TransferListSortModel(QObject *parent = nullptr);
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
     void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    int subSortColumn() const;
 
     void setStatusFilter(TorrentFilter::Type filter);
     void setCategoryFilter(const QString &category);
@@ -58,7 +63,17 @@ public:
     void disableTrackerFilter();
 
 private:
-    int compare(const QModelIndex &left, const QModelIndex &right) const;
+    // Typed values of sorted columns, so the comparisons don't need to go through QVariant.
+    // Peers and seeds are sorted by (active, total) pair.
+    using SortKey = std::variant<std::monostate, qint64, qreal, QString, QDateTime, TagSet, SHA1Hash, SHA256Hash, std::pair<int, int>>;
+
+    SortKey sortKey(int sourceRow, int column) const;
+    void updateSortKeys(int firstSourceRow, int lastSourceRow);
+    void invalidateSortKeys();
+    void ensureSortKeys() const;
+    void handleSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+    int compare(int column, const SortKey &left, const SortKey &right) const;
 
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
@@ -71,4 +86,9 @@ private:
     int m_lastSortOrder = 0;
 
     Utils::Compare::NaturalCompare<Qt::CaseInsensitive> m_naturalCompare;
+
+    // indexed by source row
+    mutable QVector<SortKey> m_sortKeys;
+    mutable QVector<SortKey> m_subSortKeys;
+    mutable bool m_sortKeysValid = false;
 };
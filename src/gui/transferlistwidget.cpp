@@ -30,6 +30,7 @@
 
 #include <algorithm>
 
+#include <QBitArray>
 #include <QClipboard>
 #include <QDebug>
 #include <QFileDialog>
@@ -214,6 +215,10 @@ TransferListWidget::TransferListWidget(QWidget *parent, MainWindow *mainWindow)
     connect(header(), &QHeaderView::sectionMoved, this, &TransferListWidget::saveSettings);
     connect(header(), &QHeaderView::sectionResized, this, &TransferListWidget::saveSettings);
     connect(header(), &QHeaderView::sortIndicatorChanged, this, &TransferListWidget::saveSettings);
+    // Section is resized when it is hidden or shown
+    connect(header(), &QHeaderView::sectionResized, this, &TransferListWidget::updateVisibleColumns);
+    connect(header(), &QHeaderView::sortIndicatorChanged, this, &TransferListWidget::updateVisibleColumns);
+    updateVisibleColumns();
 
     const auto *editHotkey = new QShortcut(Qt::Key_F2, this, nullptr, nullptr, Qt::WidgetShortcut);
     connect(editHotkey, &QShortcut::activated, this, &TransferListWidget::renameSelectedTorrent);
@@ -1346,6 +1351,22 @@ void TransferListWidget::saveSettings()
     Preferences::instance()->setTransHeaderState(header()->saveState());
 }
 
+void TransferListWidget::updateVisibleColumns()
+{
+    // Sorting requires the values of sort columns to be up to date even if they are hidden
+    QBitArray columns {TransferListModel::NB_COLUMNS};
+    for (int i = 0; i < TransferListModel::NB_COLUMNS; ++i)
+        columns.setBit(i, !isColumnHidden(i));
+
+    for (const int column : {header()->sortIndicatorSection(), m_sortFilterModel->subSortColumn()})
+    {
+        if ((column >= 0) && (column < TransferListModel::NB_COLUMNS))
+            columns.setBit(column);
+    }
+
+    m_listModel->setVisibleColumns(columns);
+}
+
 bool TransferListWidget::loadSettings()
 {
     return header()->restoreState(Preferences::instance()->getTransHeaderState());
@@ -1,4 +1,4 @@
-#VERSION: 1.44
+#VERSION: 1.45
 
 # Author:
 #  Fabien Devaux <fab AT gnux DOT info>
@@ -34,11 +34,15 @@
 # POSSIBILITY OF SUCH DAMAGE.
 
 import importlib
+import json
 import pathlib
+import queue
 import sys
+import threading
+import time
 import urllib.parse
 from glob import glob
-from multiprocessing import Pool, cpu_count
+from multiprocessing import Pool, Process, cpu_count
 from os import path
 
 THREADED = True
@@ -113,10 +117,13 @@ def displayCapabilities(supported_engines):
       </engine_short_name>
     </capabilities>
     """
-    xml = "".join(("<capabilities>\n",
-                   "".join(engines_to_xml(supported_engines)),
-                   "</capabilities>"))
-    print(xml)
+    print(capabilities_xml(supported_engines))
+
+
+def capabilities_xml(supported_engines):
+    return "".join(("<capabilities>\n",
+                    "".join(engines_to_xml(supported_engines)),
+                    "</capabilities>"))
 
 
 def run_search(engine_list):
@@ -142,6 +149,146 @@ def run_search(engine_list):
         return False
 
 
+def select_engines(engines, supported_engines):
+    """ Return the list of engines to search in """
+
+    # get only unique engines with set
+    engines_list = set(e.lower() for e in engines.strip().split(','))
+
+    if 'all' in engines_list:
+        return supported_engines
+
+    # discard un-supported engines
+    return [engine for engine in engines_list
+            if engine in supported_engines]
+
+
+def send_message(message):
+    """ Print a worker message on a separate line """
+
+    # fd 1 is stdout
+    # leading newline terminates a result line which could be left incomplete by a killed engine
+    with open(1, 'w', encoding='utf-8', closefd=False) as utf8stdout:
+        print("\n" + json.dumps(message), file=utf8stdout, flush=True)
+
+
+def read_requests(requests):
+    """ Put requests read from stdin into the queue, `None` marks the end of input """
+
+    # don't use `sys.stdin` since it's closed by the child processes which could deadlock on its lock
+    # fd 0 is stdin
+    with open(0, 'rb', closefd=False) as stdin:
+        for line in stdin:
+            try:
+                request = json.loads(line.decode('utf-8'))
+            except ValueError:
+                continue
+            if isinstance(request, dict):
+                requests.put(request)
+    requests.put(None)
+
+
+class Worker:
+    """ Serve requests read from stdin until it is closed
+
+        Every request is a JSON object on a single line:
+          {"type": "capabilities"}
+          {"type": "search", "id": 1, "engines": "all", "category": "all", "query": "foo bar", "timeout": 120}
+          {"type": "cancel", "id": 1}
+
+        Search results are printed in the same format as in the regular mode.
+        Every request (except cancellation) is answered by a JSON object on a separate line:
+          {"type": "capabilities", "xml": "<capabilities>...</capabilities>"}
+          {"type": "finished", "id": 1, "status": "ok" | "cancelled" | "failed"}
+
+        Engines stay imported between the requests. Every engine searches in its own child process
+        so the one exceeding the timeout can be killed without affecting the others.
+    """
+
+    def __init__(self, supported_engines):
+        self.supported_engines = supported_engines
+        self.requests = queue.Queue()
+        self.pending_requests = []
+        self.finished = False
+
+    def run(self):
+        threading.Thread(target=read_requests, args=(self.requests,), daemon=True).start()
+
+        while not self.finished:
+            if self.pending_requests:
+                request = self.pending_requests.pop(0)
+            else:
+                request = self.requests.get()
+
+            if request is None:
+                self.finished = True
+            elif request.get('type') == 'capabilities':
+                send_message({'type': 'capabilities', 'xml': capabilities_xml(self.supported_engines)})
+            elif request.get('type') == 'search':
+                self.search(request)
+
+    @staticmethod
+    def stop_engine(process):
+        process.terminate()
+        process.join()
+
+    def search(self, request):
+        search_id = request.get('id')
+        cat = str(request.get('category', 'all')).lower()
+        engines_list = select_engines(str(request.get('engines', '')), self.supported_engines)
+        if (cat not in CATEGORIES) or not request.get('query'):
+            send_message({'type': 'finished', 'id': search_id, 'status': 'failed'})
+            return
+
+        what = urllib.parse.quote(str(request['query']))
+        timeout = float(request.get('timeout', 0)) or None
+        max_running = MAX_THREADS if THREADED else 1
+
+        queued = list(engines_list)
+        running = []  # (process, deadline) pairs
+        status = 'ok'
+        while queued or running:
+            # the timeout of an engine is counted from the moment it starts searching
+            while queued and (len(running) < max_running):
+                process = Process(target=run_search, args=([globals()[queued.pop(0)], what, cat],), daemon=True)
+                process.start()
+                running.append((process, (time.monotonic() + timeout) if timeout else None))
+
+            still_running = []
+            for process, deadline in running:
+                if not process.is_alive():
+                    process.join()
+                elif (deadline is not None) and (time.monotonic() >= deadline):
+                    # the engine is stuck, only its own process is killed
+                    self.stop_engine(process)
+                else:
+                    still_running.append((process, deadline))
+            running = still_running
+
+            if not (queued or running):
+                break
+
+            try:
+                request = self.requests.get(timeout=0.1)
+            except queue.Empty:
+                continue
+
+            if request is None:
+                self.finished = True
+            elif request.get('type') != 'cancel':
+                self.pending_requests.append(request)
+                continue
+            elif request.get('id') != search_id:
+                continue
+
+            for process, _ in running:
+                self.stop_engine(process)
+            status = 'cancelled'
+            break
+
+        send_message({'type': 'finished', 'id': search_id, 'status': status})
+
+
 def main(args):
     # qbt tend to run this script in 'isolate mode' so append the current path manually
     current_path = str(pathlib.Path(__file__).parent.resolve())
@@ -158,19 +305,15 @@ def main(args):
         displayCapabilities(supported_engines)
         return
 
+    elif args[0] == "--worker":
+        Worker(supported_engines).run()
+        return
+
     elif len(args) < 3:
         raise SystemExit("./nova2.py [all|engine1[,engine2]*] <category> <keywords>\n"
                          "available engines: %s" % (','.join(supported_engines)))
 
-    # get only unique engines with set
-    engines_list = set(e.lower() for e in args[0].strip().split(','))
-
-    if 'all' in engines_list:
-        engines_list = supported_engines
-    else:
-        # discard un-supported engines
-        engines_list = [engine for engine in engines_list
-                        if engine in supported_engines]
+    engines_list = select_engines(args[0], supported_engines)
 
     if not engines_list:
         # engine list is empty. Nothing to do here
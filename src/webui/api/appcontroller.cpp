@@ -47,6 +47,7 @@
 #include "base/bittorrent/session.h"
 #include "base/global.h"
 #include "base/interfaces/iapplication.h"
+#include "base/net/downloadmanager.h"
 #include "base/net/portforwarder.h"
 #include "base/net/proxyconfigurationmanager.h"
 #include "base/path.h"
@@ -225,6 +226,8 @@ void AppController::preferencesAction()
     data[u"ip_filter_enabled"_s] = session->isIPFilteringEnabled();
     data[u"ip_filter_path"_s] = session->IPFilterFile().toString();
     data[u"ip_filter_trackers"_s] = session->isTrackerFilteringEnabled();
+    data[u"ip_filter_sources"_s] = session->IPFilterSources().join(u'\n');
+    data[u"ip_filter_refresh_interval"_s] = session->IPFilterRefreshInterval();
     data[u"banned_IPs"_s] = session->bannedIPs().join(u'\n');
 
     // Speed
@@ -333,6 +336,16 @@ void AppController::preferencesAction()
     // qBitorrent preferences
     // Resume data storage type
     data[u"resume_data_storage_type"_s] = Utils::String::fromEnum(session->resumeDataStorageType());
+    // Resume data compression
+    data[u"resume_data_compression"_s] = pref->isResumeDataCompressionEnabled();
+    // Resume data commit interval
+    data[u"resume_data_commit_interval"_s] = pref->getResumeDataCommitInterval();
+    // Resume data commit jobs limit
+    data[u"resume_data_commit_jobs_limit"_s] = pref->getResumeDataCommitJobsLimit();
+    // Resume data relaxed durability
+    data[u"resume_data_relaxed_durability"_s] = pref->isResumeDataRelaxedDurabilityEnabled();
+    // Resume data WAL auto checkpoint
+    data[u"resume_data_wal_autocheckpoint"_s] = pref->getResumeDataWALAutoCheckpoint();
     // Physical memory (RAM) usage limit
     data[u"memory_working_set_limit"_s] = app()->memoryWorkingSetLimit();
     // Current network interface
@@ -696,6 +709,10 @@ void AppController::setPreferencesAction()
         session->setIPFilterFile(Path(it.value().toString()));
     if (hasKey(u"ip_filter_trackers"_s))
         session->setTrackerFilteringEnabled(it.value().toBool());
+    if (hasKey(u"ip_filter_sources"_s))
+        session->setIPFilterSources(it.value().toString().split(u'\n', Qt::SkipEmptyParts));
+    if (hasKey(u"ip_filter_refresh_interval"_s))
+        session->setIPFilterRefreshInterval(it.value().toInt());
     if (hasKey(u"banned_IPs"_s))
         session->setBannedIPs(it.value().toString().split(u'\n', Qt::SkipEmptyParts));
     if (hasKey(u"auto_ban_unknown_peer"_s))
@@ -885,6 +902,21 @@ void AppController::setPreferencesAction()
     // Resume data storage type
     if (hasKey(u"resume_data_storage_type"_s))
         session->setResumeDataStorageType(Utils::String::toEnum(it.value().toString(), BitTorrent::ResumeDataStorageType::Legacy));
+    // Resume data compression
+    if (hasKey(u"resume_data_compression"_s))
+        pref->setResumeDataCompressionEnabled(it.value().toBool());
+    // Resume data commit interval
+    if (hasKey(u"resume_data_commit_interval"_s))
+        pref->setResumeDataCommitInterval(it.value().toInt());
+    // Resume data commit jobs limit
+    if (hasKey(u"resume_data_commit_jobs_limit"_s))
+        pref->setResumeDataCommitJobsLimit(it.value().toInt());
+    // Resume data relaxed durability
+    if (hasKey(u"resume_data_relaxed_durability"_s))
+        pref->setResumeDataRelaxedDurabilityEnabled(it.value().toBool());
+    // Resume data WAL auto checkpoint
+    if (hasKey(u"resume_data_wal_autocheckpoint"_s))
+        pref->setResumeDataWALAutoCheckpoint(it.value().toInt());
     // Physical memory (RAM) usage limit
     if (hasKey(u"memory_working_set_limit"_s))
         app()->setMemoryWorkingSetLimit(it.value().toInt());
@@ -1116,3 +1148,33 @@ void AppController::networkInterfaceAddressListAction()
 
     setResult(addressList);
 }
+
+void AppController::downloadStatisticsAction()
+{
+    const auto average = [](const qint64 total, const int count) -> qint64
+    {
+        return (count > 0) ? (total / count) : 0;
+    };
+
+    QJsonArray statisticsList;
+    const QHash<Net::ServiceID, Net::ServiceStatistics> statistics = Net::DownloadManager::instance()->statistics();
+    for (auto it = statistics.cbegin(); it != statistics.cend(); ++it)
+    {
+        const Net::ServiceStatistics &stats = it.value();
+        statisticsList.append(QJsonObject
+        {
+            {u"host"_s, it.key().hostName},
+            {u"port"_s, it.key().port},
+            {u"finished_requests"_s, stats.finishedRequests},
+            {u"failed_requests"_s, stats.failedRequests},
+            {u"reused_connections"_s, stats.reusedConnections},
+            {u"avg_waiting_time"_s, average(stats.totalWaitingTime, stats.finishedRequests)},
+            {u"max_waiting_time"_s, stats.maxWaitingTime},
+            {u"avg_response_time"_s, average(stats.totalResponseTime, stats.finishedRequests)},
+            {u"max_response_time"_s, stats.maxResponseTime},
+            {u"avg_download_time"_s, average(stats.totalDownloadTime, stats.finishedRequests)}
+        });
+    }
+
+    setResult(statisticsList);
+}
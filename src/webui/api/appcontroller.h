@@ -51,4 +51,5 @@ private slots:
 
     void networkInterfaceListAction();
     void networkInterfaceAddressListAction();
+    void downloadStatisticsAction();
 };
@@ -176,7 +176,7 @@ void SearchController::resultsAction()
         throw APIError(APIErrorType::NotFound);
 
     const std::shared_ptr<SearchHandler> &searchHandler = iter.value();
-    const QList<SearchResult> searchResults = searchHandler->results();
+    const QList<SearchResult> searchResults = searchHandler->results(); // shallow copy
     const int size = searchResults.size();
 
     if (offset > size)
@@ -187,13 +187,10 @@ void SearchController::resultsAction()
         offset = size + offset;
     if (offset < 0)  // check again
         throw APIError(APIErrorType::Conflict, tr("Offset is out of range"));
-    if (limit <= 0)
-        limit = -1;
+    if ((limit <= 0) || (limit > (size - offset)))
+        limit = size - offset;
 
-    if ((limit > 0) || (offset > 0))
-        setResult(getResults(searchResults.mid(offset, limit), searchHandler->isActive(), size));
-    else
-        setResult(getResults(searchResults, searchHandler->isActive(), size));
+    setResult(getResults(searchResults, offset, limit, searchHandler->isActive()));
 }
 
 void SearchController::deleteAction()
@@ -302,11 +299,12 @@ int SearchController::generateSearchId() const
  *   - "siteUrl"
  *   - "descrLink"
  */
-QJsonObject SearchController::getResults(const QList<SearchResult> &searchResults, const bool isSearchActive, const int totalResults) const
+QJsonObject SearchController::getResults(const QList<SearchResult> &searchResults, const int offset, const int limit, const bool isSearchActive) const
 {
     QJsonArray searchResultsArray;
-    for (const SearchResult &searchResult : searchResults)
+    for (int i = offset; i < (offset + limit); ++i)
     {
+        const SearchResult &searchResult = searchResults[i];
         searchResultsArray << QJsonObject
         {
             {u"fileName"_s, searchResult.fileName},
@@ -323,7 +321,7 @@ QJsonObject SearchController::getResults(const QList<SearchResult> &searchResult
     {
         {u"status"_s, isSearchActive ? u"Running"_s : u"Stopped"_s},
         {u"results"_s, searchResultsArray},
-        {u"total"_s, totalResults}
+        {u"total"_s, searchResults.size()}
     };
 
     return result;
@@ -68,7 +68,7 @@ private:
     void checkForUpdatesFinished(const QHash<QString, PluginVersion> &updateInfo);
     void checkForUpdatesFailed(const QString &reason);
     int generateSearchId() const;
-    QJsonObject getResults(const QList<SearchResult> &searchResults, bool isSearchActive, int totalResults) const;
+    QJsonObject getResults(const QList<SearchResult> &searchResults, int offset, int limit, bool isSearchActive) const;
     QJsonArray getPluginsInfo(const QStringList &plugins) const;
 
     QSet<int> m_activeSearches;
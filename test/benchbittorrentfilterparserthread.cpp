@@ -0,0 +1,172 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "base/bittorrent/filterparserthread.h"
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/path.h"
+#include "base/profile.h"
+
+namespace
+{
+    const int LINES_COUNT = 5'000'000;
+
+    // Each line blocks its own range of 8 addresses
+    QByteArray ipAddress(const int line, const int offset)
+    {
+        const quint32 ip = (static_cast<quint32>(line) * 16) + offset;
+        return QByteArray::number((ip >> 24) & 0xFF) + '.' + QByteArray::number((ip >> 16) & 0xFF)
+                + '.' + QByteArray::number((ip >> 8) & 0xFF) + '.' + QByteArray::number(ip & 0xFF);
+    }
+
+    template <typename Func>
+    bool generateFile(const Path &path, Func lineGenerator)
+    {
+        QFile file {path.data()};
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        QByteArray buffer;
+        buffer.reserve(1024 * 1024);
+        for (int i = 0; i < LINES_COUNT; ++i)
+        {
+            buffer += lineGenerator(i);
+            buffer += '\n';
+            if (buffer.size() >= (1024 * 1024 - 256))
+            {
+                if (file.write(buffer) != buffer.size())
+                    return false;
+                buffer.clear();
+            }
+        }
+
+        return (file.write(buffer) == buffer.size());
+    }
+}
+
+class BenchBitTorrentFilterParserThread final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(BenchBitTorrentFilterParserThread)
+
+public:
+    BenchBitTorrentFilterParserThread() = default;
+
+private slots:
+    void initTestCase() const
+    {
+        QVERIFY(m_tmpDir.isValid());
+        // parsed filter cache is stored in profile
+        Profile::initInstance((Path(m_tmpDir.path()) / Path(u"profile"_s)), {}, false);
+        Logger::initInstance();
+
+        // 001.009.096.105 - 001.009.096.112 , 000 , Some organization
+        QVERIFY(generateFile(datFilePath(), [](const int line)
+        {
+            return ipAddress(line, 0) + " - " + ipAddress(line, 7) + " , 000 , Organization " + QByteArray::number(line);
+        }));
+
+        // Some organization:1.9.96.105-1.9.96.112
+        QVERIFY(generateFile(p2pFilePath(), [](const int line)
+        {
+            return "Organization " + QByteArray::number(line) + ':' + ipAddress(line, 0) + '-' + ipAddress(line, 7);
+        }));
+    }
+
+    void cleanupTestCase() const
+    {
+        Logger::freeInstance();
+        Profile::freeInstance();
+    }
+
+    void benchmarkDAT() const
+    {
+        removeCache();
+        parse(datFilePath());
+    }
+
+    void benchmarkDATCached() const
+    {
+        parse(datFilePath());
+    }
+
+    void benchmarkP2P() const
+    {
+        removeCache();
+        parse(p2pFilePath());
+    }
+
+    void benchmarkP2PCached() const
+    {
+        parse(p2pFilePath());
+    }
+
+private:
+    Path datFilePath() const
+    {
+        return Path(m_tmpDir.path()) / Path(u"filter.dat"_s);
+    }
+
+    Path p2pFilePath() const
+    {
+        return Path(m_tmpDir.path()) / Path(u"filter.p2p"_s);
+    }
+
+    void removeCache() const
+    {
+        const Path cachePath = specialFolderLocation(SpecialFolder::Cache) / Path(u"ipfilter"_s);
+        QDir(cachePath.data()).removeRecursively();
+    }
+
+    void parse(const Path &filePath) const
+    {
+        FilterParserThread parser;
+        QSignalSpy spy {&parser, &FilterParserThread::IPFilterParsed};
+
+        QBENCHMARK_ONCE
+        {
+            parser.processFilterFile(filePath);
+            QVERIFY(parser.wait());
+        }
+
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.first().first().toInt(), LINES_COUNT);
+    }
+
+    QTemporaryDir m_tmpDir;
+};
+
+QTEST_GUILESS_MAIN(BenchBitTorrentFilterParserThread)
+#include "benchbittorrentfilterparserthread.moc"
@@ -0,0 +1,119 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <vector>
+
+#include <QTest>
+
+#include "base/global.h"
+#include "base/rss/rss_keywordmatcher.h"
+
+class TestRSSKeywordMatcher final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestRSSKeywordMatcher)
+
+public:
+    TestRSSKeywordMatcher() = default;
+
+private slots:
+    void testEmpty() const
+    {
+        RSS::KeywordMatcher matcher;
+        matcher.build();
+        QCOMPARE(matcher.keywordCount(), 0);
+        QVERIFY(matcher.findKeywords(u"anything").empty());
+    }
+
+    void testAddKeyword() const
+    {
+        RSS::KeywordMatcher matcher;
+        QCOMPARE(matcher.addKeyword(u"foo"_s), 0);
+        QCOMPARE(matcher.addKeyword(u"bar"_s), 1);
+        QCOMPARE(matcher.addKeyword(u"FOO"_s), 0);
+        QCOMPARE(matcher.keywordCount(), 2);
+
+        matcher.clear();
+        QCOMPARE(matcher.keywordCount(), 0);
+        QCOMPARE(matcher.addKeyword(u"bar"_s), 0);
+    }
+
+    void testFindKeywords() const
+    {
+        RSS::KeywordMatcher matcher;
+        const int he = matcher.addKeyword(u"he"_s);
+        const int she = matcher.addKeyword(u"she"_s);
+        const int his = matcher.addKeyword(u"his"_s);
+        const int hers = matcher.addKeyword(u"hers"_s);
+        matcher.build();
+
+        const std::vector<bool> found = matcher.findKeywords(u"ushers");
+        QVERIFY(found[he]);
+        QVERIFY(found[she]);
+        QVERIFY(!found[his]);
+        QVERIFY(found[hers]);
+
+        // Overlapping keywords are found as well
+        const std::vector<bool> found2 = matcher.findKeywords(u"this");
+        QVERIFY(!found2[he]);
+        QVERIFY(!found2[she]);
+        QVERIFY(found2[his]);
+        QVERIFY(!found2[hers]);
+    }
+
+    void testCaseInsensitive() const
+    {
+        RSS::KeywordMatcher matcher;
+        const int show = matcher.addKeyword(u"Show.Name"_s);
+        const int umlaut = matcher.addKeyword(u"ÜBER"_s);
+        matcher.build();
+
+        const std::vector<bool> found = matcher.findKeywords(u"[Group] SHOW.name S01E02 über 1080p");
+        QVERIFY(found[show]);
+        QVERIFY(found[umlaut]);
+
+        QVERIFY(!matcher.findKeywords(u"Show Name S01E02")[show]);
+    }
+
+    void testRebuild() const
+    {
+        RSS::KeywordMatcher matcher;
+        const int abc = matcher.addKeyword(u"abc"_s);
+        matcher.build();
+        QVERIFY(!matcher.findKeywords(u"xbcd")[abc]);
+
+        const int bcd = matcher.addKeyword(u"bcd"_s);
+        matcher.build();
+        const std::vector<bool> found = matcher.findKeywords(u"xabcd");
+        QVERIFY(found[abc]);
+        QVERIFY(found[bcd]);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestRSSKeywordMatcher)
+#include "testrsskeywordmatcher.moc"
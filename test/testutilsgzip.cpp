@@ -64,6 +64,18 @@ private slots:
         QVERIFY(ok);
         QCOMPARE(decompressedData, data);
     }
+
+    void testIsCompressed() const
+    {
+        const QByteArray data = QByteArrayLiteral("d4:infod6:lengthi0eee");
+        QVERIFY(!Utils::Gzip::isCompressed(data));
+        QVERIFY(!Utils::Gzip::isCompressed({}));
+
+        bool ok = false;
+        const QByteArray compressedData = Utils::Gzip::compress(data, 6, &ok);
+        QVERIFY(ok);
+        QVERIFY(Utils::Gzip::isCompressed(compressedData));
+    }
 };
 
 QTEST_APPLESS_MAIN(TestUtilsGzip)